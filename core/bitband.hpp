@@ -0,0 +1,82 @@
+#ifndef BITBAND_HPP
+#define BITBAND_HPP
+
+#include <array>
+#include <cstddef>
+
+/*!
+ * \file
+ * \brief Файл с описанием областей bit-band Cortex-M3/M4
+ *
+ * Каждому биту первого мегабайта SRAM и периферии соответствует слово
+ * в области псевдонимов: запись 0 или 1 в слово сбрасывает или устанавливает
+ * бит, чтение возвращает его значение. Изменение одного бита выполняется
+ * одной инструкцией сохранения без чтения-модификации-записи.
+ */
+
+namespace metaMCU::CortexM3 {
+
+    /// \brief Область памяти с поддержкой bit-band
+    struct Bit_band_region
+    {
+        size_t base;
+        size_t size;
+        size_t alias_base;
+    };
+
+    /// \brief Области bit-band: SRAM и периферия
+    inline constexpr std::array<Bit_band_region, 2> bit_band_regions =
+    {{
+        {0x20000000, 0x00100000, 0x22000000},
+        {0x40000000, 0x00100000, 0x42000000}
+    }};
+
+    /// \brief Истина, если байт по адресу доступен через bit-band
+    constexpr bool in_bit_band_region(size_t address)
+    {
+        for (const auto& region : bit_band_regions)
+            if (address >= region.base && address - region.base < region.size)
+                return true;
+        return false;
+    }
+
+    /// \brief Проверка, что все байты регистра по адресу доступны через bit-band
+    template<size_t Address, typename Value_t>
+    concept Bit_band_address = in_bit_band_region(Address) && in_bit_band_region(Address + sizeof(Value_t) - 1);
+
+    /*!
+     * \brief Адрес слова-псевдонима бита
+     * \param address Адрес регистра в области bit-band
+     * \param bit Номер бита от начала регистра
+     * \return Адрес псевдонима или 0, если адрес вне областей bit-band
+     */
+    constexpr size_t bit_band_alias(size_t address, size_t bit)
+    {
+        for (const auto& region : bit_band_regions)
+            if (address >= region.base && address - region.base < region.size)
+                return region.alias_base + (address - region.base) * 32 + bit * 4;
+        return 0;
+    }
+
+    /*!
+     * \brief Обратное преобразование адреса псевдонима
+     * \param alias Адрес в области псевдонимов
+     * \param[out] word Адрес выровненного слова, содержащего бит
+     * \param[out] bit Номер бита в слове
+     * \return Ложь, если адрес не является псевдонимом
+     */
+    constexpr bool bit_band_target(size_t alias, size_t& word, size_t& bit)
+    {
+        for (const auto& region : bit_band_regions)
+            if (alias >= region.alias_base && alias - region.alias_base < region.size * 32)
+            {
+                const auto byte = region.base + (alias - region.alias_base) / 32;
+                word = byte & ~size_t{3};
+                bit = (byte & 3) * 8 + ((alias - region.alias_base) / 4) % 8;
+                return true;
+            }
+        return false;
+    }
+}
+
+#endif // BITBAND_HPP
@@ -0,0 +1,184 @@
+#ifndef BOARDCONFIGURATION_HPP
+#define BOARDCONFIGURATION_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+#include "port.hpp"
+#include "configutils.hpp"
+
+/*!
+ * \file
+ * \brief Файл с начальной конфигурацией выводов всей платы
+ *
+ * Конфигурации выводов сворачиваются на этапе компиляции в итоговые значения
+ * регистров MODER, OTYPER, OSPEEDR, PUPDR, AFRL и AFRH каждого порта, при запуске
+ * каждый регистр записывается не более одного раза.
+ */
+
+/*!
+ * \brief Вывод порта с начальной конфигурацией
+ * \tparam Pin Вывод (PortPin)
+ * \tparam Configuration Конфигурация (StartupConfiguration)
+ */
+template<typename Pin, typename Configuration>
+    requires IsPortPin<Pin>
+struct PinSetup
+{
+    using PinType = Pin;
+    using ConfigurationType = Configuration;
+};
+
+/*!
+ * \brief Начальная конфигурация выводов платы
+ *
+ * Описание порта дополнительно к требованиям Port должно содержать регистры
+ * OTYPER, OSPEEDR, PUPDR, AFRL и AFRH. Регистр, все разряды которого заданы
+ * конфигурацией, записывается без чтения, частично заданный - одним
+ * чтением-модификацией-записью, не затронутый конфигурацией не изменяется.
+ * MODER записывается последним, чтобы вывод переключался в новый режим
+ * с уже заданными типом выхода, подтяжкой и альтернативной функцией.
+ * \code
+ * using Board = BoardConfiguration<
+ *     PinSetup<PortPin<GPIOA, 5>, StartupConfiguration<PUSHPULL_OUTPUT>>,
+ *     PinSetup<PortPin<GPIOA, 9>, StartupConfiguration<AUX_PUSHPULL_OUTPUT, LARGE_STR, PIN_NON_CONFIGURABLE, 7>>>;
+ * Board::Configure();
+ * \endcode
+ * \tparam Setups Конфигурации выводов (PinSetup), каждый вывод не более одного раза
+ */
+template<typename... Setups>
+class BoardConfiguration
+{
+    static_assert(NoDuplicates<typename Setups::PinType...>, "Pin is configured more than once");
+
+public:
+    /// \brief Записывает конфигурацию во все затронутые порты
+    [[gnu::always_inline]] inline static void Configure()
+    {
+        ForEachPort(Ports());
+    }
+
+private:
+    /// Разряды регистра, заданные конфигурацией, и их значения
+    struct Word
+    {
+        std::uint32_t mask = 0;
+        std::uint32_t value = 0;
+
+        constexpr void set(std::uint8_t offset, std::uint8_t size, std::uint32_t bits)
+        {
+            const std::uint32_t field = ((1U << size) - 1U) << offset;
+            mask |= field;
+            value = (value & ~field) | ((bits << offset) & field);
+        }
+    };
+
+    struct PortWords
+    {
+        Word moder;
+        Word otyper;
+        Word ospeedr;
+        Word pupdr;
+        Word afrl;
+        Word afrh;
+    };
+
+    static consteval std::uint32_t ModeBits(PinMode mode)
+    {
+        switch (mode) {
+        case ANALOG_INPUT:
+            return GPIO_ANALOG;
+        case FLOAT_INPUT:
+        case PULLUP_INPUT:
+        case PULLDOWN_INPUT:
+            return GPIO_INPUT;
+        case PUSHPULL_OUTPUT:
+        case OPENDRAIN_OUTPUT:
+            return GPIO_OUTPUT;
+        default:
+            return GPIO_ALTERNATE;
+        }
+    }
+
+    static consteval std::uint32_t PullBits(PinMode mode)
+    {
+        return mode == PULLUP_INPUT ? 0b01 : mode == PULLDOWN_INPUT ? 0b10 : 0b00;
+    }
+
+    static consteval std::uint32_t SpeedBits(PinStrenght strenght)
+    {
+        return strenght == MAX_STR ? 0b11 : strenght == LARGE_STR ? 0b01 : 0b00;
+    }
+
+    /// Добавляет конфигурацию вывода в значения регистров его порта
+    template<typename Setup>
+    static consteval void Apply(PortWords& words)
+    {
+        using Configuration = typename Setup::ConfigurationType;
+        constexpr auto number = Setup::PinType::Number;
+        constexpr auto mode = Configuration::Mode;
+
+        words.moder.set(number * 2, 2, ModeBits(mode));
+        words.pupdr.set(number * 2, 2, PullBits(mode));
+        if constexpr (ModeBits(mode) == GPIO_OUTPUT || ModeBits(mode) == GPIO_ALTERNATE)
+        {
+            words.otyper.set(number, 1, (mode == OPENDRAIN_OUTPUT || mode == AUX_OPENDRAIN_OUTPUT) ? 1 : 0);
+            words.ospeedr.set(number * 2, 2, SpeedBits(Configuration::Strenght));
+        }
+        if constexpr (ModeBits(mode) == GPIO_ALTERNATE)
+        {
+            if constexpr (number < 8)
+                words.afrl.set(number * 4, 4, Configuration::Alternate);
+            else
+                words.afrh.set((number - 8) * 4, 4, Configuration::Alternate);
+        }
+    }
+
+    template<typename P>
+    static consteval PortWords Words()
+    {
+        PortWords words;
+        ((std::is_same_v<typename Setups::PinType::PortType, P> ? Apply<Setups>(words) : void()), ...);
+        return words;
+    }
+
+    /// Записывает заданные разряды регистра: без чтения, если заданы все значимые разряды
+    template<typename Register, Word word, std::uint32_t used = 0xFFFFFFFF>
+    [[gnu::always_inline]] inline static void WriteWord()
+    {
+        using Value_t = typename Register::Value_t;
+
+        if constexpr (word.mask == 0)
+            return;
+        else if constexpr ((word.mask & used) == used)
+            Register::write(static_cast<Value_t>(word.value));
+        else
+            Register::write(static_cast<Value_t>((Register::read() & ~word.mask) | word.value));
+    }
+
+    template<typename P>
+    [[gnu::always_inline]] inline static void ConfigurePort()
+    {
+        constexpr auto words = Words<P>();
+        WriteWord<typename P::OTYPER, words.otyper, 0xFFFF>();
+        WriteWord<typename P::OSPEEDR, words.ospeedr>();
+        WriteWord<typename P::PUPDR, words.pupdr>();
+        WriteWord<typename P::AFRL, words.afrl>();
+        WriteWord<typename P::AFRH, words.afrh>();
+        WriteWord<typename P::MODER, words.moder>();
+    }
+
+    template<typename... Ps>
+    [[gnu::always_inline]] inline static void ForEachPort(meta_utils::TypeContainer<Ps...>)
+    {
+        (ConfigurePort<Ps>(), ...);
+    }
+
+    /// Порты, затронутые конфигурацией, без повторов
+    static consteval auto Ports()
+    {
+        return (meta_utils::TypeContainer<>() + ... + meta_utils::TypeContainer<typename Setups::PinType::PortType>());
+    }
+};
+
+#endif // BOARDCONFIGURATION_HPP
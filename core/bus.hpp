@@ -0,0 +1,126 @@
+#ifndef BUS_HPP
+#define BUS_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+/*!
+ * \file
+ * \brief Файл с политиками доступа к памяти
+ *
+ * Политика доступа определяет, каким образом Register выполняет
+ * чтение и запись по своему адресу. По умолчанию используется
+ * Mmio_bus - прямой volatile доступ к периферии микроконтроллера.
+ */
+
+namespace metaMCU {
+
+    /// \brief Проверка соответствия типа политике доступа к памяти
+    template<typename Bus>
+    concept Bus_policy = requires (std::uint32_t value)
+    {
+        { Bus::template read<std::uint32_t>(size_t{}) } -> std::same_as<std::uint32_t>;
+        Bus::template write<std::uint32_t>(size_t{}, value);
+    };
+
+    /// \brief Проверка поддержки политикой доступа атомарного чтения-модификации-записи
+    template<typename Bus>
+    concept Exclusive_bus = requires (size_t retries)
+    {
+        { Bus::template modify_exclusive<std::uint32_t>(size_t{}, [](std::uint32_t v) { return v; }, retries) } -> std::same_as<std::uint32_t>;
+    };
+
+    namespace core {
+
+        /*!
+         * \brief Политика прямого доступа к отображенным в память регистрам
+         *
+         * Каждое обращение компилируется в одну volatile инструкцию
+         * загрузки или сохранения, накладных расходов нет.
+         */
+        struct Mmio_bus
+        {
+            /// \brief Считывает значение по адресу
+            template<typename Value_t>
+            [[gnu::always_inline]] inline static Value_t read(size_t address)
+            {
+                return *reinterpret_cast<volatile Value_t*>(address);
+            }
+
+            /// \brief Записывает значение по адресу
+            template<typename Value_t>
+            [[gnu::always_inline]] inline static void write(size_t address, Value_t value)
+            {
+                *reinterpret_cast<volatile Value_t*>(address) = value;
+            }
+
+            /*!
+             * \brief Атомарно заменяет значение по адресу на modify(значение)
+             *
+             * На ARMv7-M компилируется в цикл LDREX/STREX, на других архитектурах
+             * используется сравнение с обменом. Функция modify должна быть короткой
+             * и не обращаться к памяти, иначе монитор эксклюзивного доступа может быть сброшен.
+             * \param retries Увеличивается на количество неудачных попыток записи
+             * \return Значение до изменения
+             */
+            template<typename Value_t, typename F>
+            [[gnu::always_inline]] inline static Value_t modify_exclusive(size_t address, F modify, size_t& retries)
+            {
+                auto ptr = reinterpret_cast<volatile Value_t*>(address);
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+                Value_t old_value;
+                while (true)
+                {
+                    old_value = LDREX(ptr);
+                    if (!STREX(static_cast<Value_t>(modify(old_value)), ptr))
+                        return old_value;
+                    ++retries;
+                }
+#else
+                Value_t old_value = __atomic_load_n(ptr, __ATOMIC_RELAXED);
+                while (!__atomic_compare_exchange_n(ptr, &old_value, static_cast<Value_t>(modify(old_value)),
+                                                    true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+                    ++retries;
+                return old_value;
+#endif
+            }
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+        private:
+            template<typename Value_t>
+            [[gnu::always_inline]] inline static Value_t LDREX(volatile Value_t *addr)
+            {
+                std::uint32_t result;
+
+                if constexpr (sizeof(Value_t) == 1)
+                    __asm volatile ("ldrexb %0, %1" : "=r" (result) : "Q" (*addr) );
+                else if constexpr (sizeof(Value_t) == 2)
+                    __asm volatile ("ldrexh %0, %1" : "=r" (result) : "Q" (*addr) );
+                else
+                    __asm volatile ("ldrex %0, %1" : "=r" (result) : "Q" (*addr) );
+                return static_cast<Value_t>(result);
+            }
+
+            /// Возвращает 0 при успешной записи
+            template<typename Value_t>
+            [[gnu::always_inline]] inline static std::uint32_t STREX(Value_t value, volatile Value_t *addr)
+            {
+                std::uint32_t result;
+
+                if constexpr (sizeof(Value_t) == 1)
+                    __asm volatile ("strexb %0, %2, %1" : "=&r" (result), "=Q" (*addr) : "r" (static_cast<std::uint32_t>(value)) );
+                else if constexpr (sizeof(Value_t) == 2)
+                    __asm volatile ("strexh %0, %2, %1" : "=&r" (result), "=Q" (*addr) : "r" (static_cast<std::uint32_t>(value)) );
+                else
+                    __asm volatile ("strex %0, %2, %1" : "=&r" (result), "=Q" (*addr) : "r" (value) );
+                return result;
+            }
+#endif
+        };
+
+        static_assert(Bus_policy<Mmio_bus> && Exclusive_bus<Mmio_bus>);
+    }
+}
+
+#endif // BUS_HPP
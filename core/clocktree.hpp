@@ -0,0 +1,225 @@
+#ifndef CLOCKTREE_HPP
+#define CLOCKTREE_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#include "field.hpp"
+#include "fields.hpp"
+
+/*!
+ * \file
+ * \brief Файл с расчетом дерева тактирования на этапе компиляции
+ *
+ * Решатель перебирает допустимые делители и множители PLL, предделители шин
+ * и задержку флеш-памяти и выбирает самую высокую частоту ядра, не превышающую
+ * заданную, при минимальном числе тактов ожидания. Результат выдается в виде
+ * набора значений полей Values, который записывается существующим механизмом
+ * с минимальным числом обращений к регистрам.
+ */
+
+namespace metaMCU::clock {
+
+    /// Частота не ограничена запросом, действует только ограничение микроконтроллера
+    inline constexpr std::uint32_t device_maximum = std::numeric_limits<std::uint32_t>::max();
+
+    /*!
+     * \brief Требуемые частоты в Гц
+     *
+     * Частоты ядра и шин являются верхними границами, по умолчанию - максимальные
+     * для микроконтроллера. Частота USB (если не 0) должна быть получена точно.
+     * Если hse равна 0, PLL тактируется от HSI.
+     */
+    struct Clock_request
+    {
+        std::uint32_t hse = 0;
+        std::uint32_t sysclk = device_maximum;
+        std::uint32_t ahb = device_maximum;
+        std::uint32_t apb1 = device_maximum;
+        std::uint32_t apb2 = device_maximum;
+        std::uint32_t usb = 0;
+    };
+
+    /// \brief Ограничения PLL, шин и флеш-памяти микроконтроллера
+    struct Clock_limits
+    {
+        std::uint32_t hsi;
+        std::uint32_t pll_input_min, pll_input_max;
+        std::uint32_t vco_min, vco_max;
+        std::uint32_t m_min, m_max;
+        std::uint32_t n_min, n_max;
+        std::uint32_t q_min, q_max;
+        std::uint32_t sysclk_max;
+        std::uint32_t apb1_max;
+        std::uint32_t apb2_max;
+        /// Максимальная частота AHB на один такт ожидания флеш-памяти
+        std::uint32_t flash_step;
+        std::uint32_t latency_max;
+    };
+
+    /// \brief Ограничения STM32F40x/41x при напряжении питания 2.7-3.6 В
+    inline constexpr Clock_limits stm32f40x_limits =
+    {
+        16'000'000,
+        1'000'000, 2'000'000,
+        100'000'000, 432'000'000,
+        2, 63,
+        50, 432,
+        2, 15,
+        168'000'000,
+        42'000'000,
+        84'000'000,
+        30'000'000,
+        7
+    };
+
+    /// \brief Результат расчета: делители, значения полей и полученные частоты
+    struct Clock_solution
+    {
+        bool valid = false;
+        std::uint32_t pllm = 0, plln = 0, pllp = 0, pllq = 0;
+        std::uint32_t hpre = 0, ppre1 = 0, ppre2 = 0;
+        std::uint32_t latency = 0;
+        std::uint32_t sysclk = 0, ahb = 0, apb1 = 0, apb2 = 0, usb = 0;
+    };
+
+    /// \brief Делитель шины и код поля предделителя
+    struct Prescaler
+    {
+        std::uint32_t divider;
+        std::uint32_t code;
+    };
+
+    inline constexpr std::array<Prescaler, 9> ahb_prescalers =
+    {{
+        {1, 0b0000}, {2, 0b1000}, {4, 0b1001}, {8, 0b1010}, {16, 0b1011},
+        {64, 0b1100}, {128, 0b1101}, {256, 0b1110}, {512, 0b1111}
+    }};
+
+    inline constexpr std::array<Prescaler, 5> apb_prescalers =
+    {{
+        {1, 0b000}, {2, 0b100}, {4, 0b101}, {8, 0b110}, {16, 0b111}
+    }};
+
+    /// \brief Наименьший делитель, при котором частота не превышает limit
+    template<size_t N>
+    constexpr const Prescaler* select_prescaler(const std::array<Prescaler, N>& prescalers, std::uint32_t clock, std::uint32_t limit)
+    {
+        for (const auto& prescaler : prescalers)
+            if (clock / prescaler.divider <= limit && clock % prescaler.divider == 0)
+                return &prescaler;
+        return nullptr;
+    }
+
+    constexpr std::uint32_t min(std::uint32_t a, std::uint32_t b)
+    {
+        return a < b ? a : b;
+    }
+
+    /*!
+     * \brief Подбирает конфигурацию тактирования
+     *
+     * Из решений с наибольшей частотой ядра выбирается решение с наибольшей
+     * частотой AHB (минимальной задержкой флеш-памяти при равной частоте),
+     * затем с наибольшей частотой входа PLL (меньший джиттер).
+     * \return Решение, valid равно false, если допустимой конфигурации нет
+     */
+    consteval Clock_solution solve(Clock_request request, Clock_limits limits = stm32f40x_limits)
+    {
+        Clock_solution best;
+        const auto source = request.hse != 0 ? request.hse : limits.hsi;
+        const auto sysclk_limit = min(request.sysclk, limits.sysclk_max);
+
+        for (auto m = limits.m_min; m <= limits.m_max; ++m)
+        {
+            if (source % m != 0)
+                continue;
+            const auto input = source / m;
+            if (input < limits.pll_input_min || input > limits.pll_input_max)
+                continue;
+
+            for (auto n = limits.n_min; n <= limits.n_max; ++n)
+            {
+                const auto vco = input * n;
+                if (vco < limits.vco_min || vco > limits.vco_max)
+                    continue;
+
+                std::uint32_t q = 0;
+                if (request.usb != 0)
+                {
+                    if (vco % request.usb != 0 || vco / request.usb < limits.q_min || vco / request.usb > limits.q_max)
+                        continue;
+                    q = vco / request.usb;
+                }
+                else
+                    q = limits.q_max;
+
+                for (std::uint32_t p = 2; p <= 8; p += 2)
+                {
+                    const auto sysclk = vco / p;
+                    if (vco % p != 0 || sysclk > sysclk_limit || sysclk < best.sysclk)
+                        continue;
+
+                    const auto hpre = select_prescaler(ahb_prescalers, sysclk, request.ahb);
+                    if (hpre == nullptr)
+                        continue;
+                    const auto ahb = sysclk / hpre->divider;
+                    const auto ppre1 = select_prescaler(apb_prescalers, ahb, min(request.apb1, limits.apb1_max));
+                    const auto ppre2 = select_prescaler(apb_prescalers, ahb, min(request.apb2, limits.apb2_max));
+                    if (ppre1 == nullptr || ppre2 == nullptr)
+                        continue;
+                    const auto latency = (ahb - 1) / limits.flash_step;
+                    if (latency > limits.latency_max)
+                        continue;
+
+                    if (best.valid && sysclk == best.sysclk && (ahb < best.ahb || (ahb == best.ahb && input <= source / best.pllm)))
+                        continue;
+
+                    best = {true, m, n, p / 2 - 1, q, hpre->code, ppre1->code, ppre2->code, latency,
+                            sysclk, ahb, ahb / ppre1->divider, ahb / ppre2->divider, vco / q};
+                }
+            }
+        }
+        return best;
+    }
+
+    /*!
+     * \brief Значения полей RCC и FLASH для запрошенных частот
+     *
+     * Описание Fields должно содержать поля PLLM, PLLN, PLLP, PLLQ, PLLSRC
+     * (RCC_PLLCFGR), HPRE, PPRE1, PPRE2 (RCC_CFGR) и LATENCY (FLASH_ACR),
+     * например псевдонимы полей из заголовков RegistersGenerator.
+     * Values не включает PLL и не переключает источник тактирования: это
+     * выполняется после записи значений, с ожиданием флагов готовности.
+     * \code
+     * using Clocks = Clock_tree<F407_clock_fields, Clock_request{8'000'000, 168'000'000, 168'000'000, 42'000'000, 84'000'000, 48'000'000}>;
+     * Clocks::Values_t::Set();
+     * \endcode
+     * \tparam Fields Описание полей
+     * \tparam request Требуемые частоты
+     * \tparam limits Ограничения микроконтроллера
+     */
+    template<typename Fields, Clock_request request, Clock_limits limits = stm32f40x_limits>
+    struct Clock_tree
+    {
+        static constexpr Clock_solution solution = solve(request, limits);
+        static_assert(solution.valid, "No legal clock configuration for the requested frequencies");
+
+        template<typename Field, std::uint32_t value>
+        using Value = core::Field_value<Field, static_cast<typename Field::Value_t>(value)>;
+
+        using Values_t = Values<
+            Value<typename Fields::PLLM, solution.pllm>,
+            Value<typename Fields::PLLN, solution.plln>,
+            Value<typename Fields::PLLP, solution.pllp>,
+            Value<typename Fields::PLLQ, solution.pllq>,
+            Value<typename Fields::PLLSRC, request.hse != 0 ? 1 : 0>,
+            Value<typename Fields::HPRE, solution.hpre>,
+            Value<typename Fields::PPRE1, solution.ppre1>,
+            Value<typename Fields::PPRE2, solution.ppre2>,
+            Value<typename Fields::LATENCY, solution.latency>>;
+    };
+}
+
+#endif // CLOCKTREE_HPP
@@ -1,6 +1,8 @@
 #ifndef CORTEXM3_HPP
 #define CORTEXM3_HPP
 
+#include "bitband.hpp"
+#include "bus.hpp"
 #include "field.hpp"
 #include "register.hpp"
 
@@ -15,141 +17,115 @@
 
 namespace metaMCU::CortexM3 {
 
-    template <size_t address, typename Value, typename Access>
-    class Register : public core::Register<address, Value, Access>
+    /*!
+     * \brief Регистр Cortex-M3 с доступом к отдельным битам через bit-band
+     * \tparam address Адрес регистра
+     * \tparam Value Тип из stdint.h соотвествествующий разряду регистра
+     * \tparam Access Тип доступа к регистру
+     * \tparam Bus Политика доступа к памяти
+     */
+    template <size_t address, typename Value, typename Access, Bus_policy Bus = core::Mmio_bus>
+    class Register : public core::Register<address, Value, Access, Bus>
     {
     public:
-        using Value_t = typename core::Register<address, Value, Access>::Value_t;
-
-        template<typename... Values>
-            requires Can_write<Access> && Can_read<Access>
-        [[gnu::always_inline]] inline static void values_set_atomic()
-        {
-            Value_t new_value;
-
-            do
-            {
-                new_value = LDREX(reinterpret_cast<volatile Value_t*>(address));
-                new_value &= ~calculateMask<Values...>();
-                new_value |= accumulateValues<Values...>();
-            }
-            while(STREX(new_value, reinterpret_cast<volatile Value_t*>(address)));
-        }
+        using Value_t = typename core::Register<address, Value, Access, Bus>::Value_t;
 
+        /// \brief Устанавливает бит одной записью в область псевдонимов
         template<typename T = void>
-            requires Can_write<Access>
+            requires Can_write<Access> && Bit_band_address<address, Value>
         [[gnu::always_inline]] inline static void bit_band_set(size_t bit_offset)
         {
-            *reinterpret_cast<volatile Value_t*>(bit_band_word_addr(offset)) = 0x01;
+            Bus::template write<std::uint32_t>(alias_base + 4 * bit_offset, 0x01);
         }
 
+        /// \brief Сбрасывает бит одной записью в область псевдонимов
         template<typename T = void>
-            requires Can_write<Access>
+            requires Can_write<Access> && Bit_band_address<address, Value>
         [[gnu::always_inline]] inline static void bit_band_clear(size_t bit_offset)
         {
-            *reinterpret_cast<volatile Value_t*>(bit_band_word_addr(offset)) = 0x00;
+            Bus::template write<std::uint32_t>(alias_base + 4 * bit_offset, 0x00);
         }
 
-    private:
-
-
-        [[gnu::always_inline]] inline static Value_t LDREX(volatile Value_t *addr)
+        /// \brief Считывает бит одним чтением из области псевдонимов
+        template<typename T = void>
+            requires Can_read<Access> && Bit_band_address<address, Value>
+        [[gnu::always_inline]] inline static bool bit_band_read(size_t bit_offset)
         {
-            Value_t result;
-
-            __asm volatile ("ldrex %0, %1" : "=r" (result) : "Q" (*addr) );
-            return(result);
+            return Bus::template read<std::uint32_t>(alias_base + 4 * bit_offset);
         }
 
-        [[gnu::always_inline]] inline static Value_t STREX(Value_t value, volatile Value_t *addr)
-        {
-            Value_t result;
-
-            __asm volatile ("strex %0, %2, %1" : "=&r" (result), "=Q" (*addr) : "r" (value) );
-            return(result);
-        }
-
-        [[gnu::always_inline]] inline static void CLREX()
-        {
-            __asm volatile ("clrex" ::: "memory");
-        }
+    private:
+        static constexpr size_t alias_base = bit_band_alias(address, 0);
     };
 
     template<typename Register, size_t Offset, size_t Size, typename Access>
     class Field : public core::Field<Register, Offset, Size, Access>
     {
-    protected:
-        /// \brief Записывает значение в битовое поле регистра c использованием LDREX, STREX
-        template<typename Value>
-            requires Can_write<Access> && Can_read<Access>
-        [[gnu::always_inline]] inline static void set_atomic()
-        {
-            Register::template values_set_atomic<Value>();
-        }
     };
 
+    /*!
+     * \brief Однобитовое поле регистра из области bit-band
+     *
+     * Установка, атомарная установка и проверка значения выполняются одним
+     * обращением к слову-псевдониму вместо чтения-модификации-записи.
+     * Для регистров с теневой копией не применяется, так как копия не была бы обновлена.
+     * Для регистров с аппаратно изменяемыми битами (Hardware_modified_bits) тоже не
+     * применяется: запись в псевдоним - это скрытое чтение-модификация-запись слова
+     * шиной, которая сбросила бы остальные флаги, сбрасываемые записью единицы.
+     */
     template<typename Register, size_t Offset, typename Access>
-        requires Can_write<Access>
+        requires Bit_band_address<Register::address(), typename Register::Value_t> && (!requires { Register::flush(); })
+                 && (Hardware_modified_bits<Register::address()>::value == 0)
     class Field<Register, Offset, 1, Access> : public core::Field<Register, Offset, 1, Access>
     {
     public:
-        using Value_t = typename Register::Value_t;
-
-    private:
-        static constexpr size_t peripheral_base_addr = 0x4;
-        static constexpr size_t bit_band_base_addr = 0x4;
-
-        static consteval auto bit_band_word_addr()
+        /// \brief Адрес слова-псевдонима бита
+        static consteval size_t bit_band_alias()
         {
-            return bit_band_base_addr + 32 * (Register::address() - peripheral_base_addr) + 4 * Offset;
+            return CortexM3::bit_band_alias(Register::address(), Offset);
         }
 
-    protected:
-        template<typename Val>
-        [[gnu::always_inline]] inline static void set()
+        /// \brief Записывает значение, известное во время выполнения, одной записью в псевдоним
+        template<typename T = void>
+            requires Can_write<Access>
+        [[gnu::always_inline]] inline static void set(typename Register::Value_t value)
         {
-            *reinterpret_cast<volatile Value_t*>(bit_band_word_addr()) = Val::value();
+            Register::Bus_t::template write<std::uint32_t>(bit_band_alias(), value & 1U);
         }
 
-        template<typename Value>
-        [[gnu::always_inline]] inline static void write()
+        /// \brief Возвращает значение бита одним чтением псевдонима
+        template<typename T = void>
+            requires Can_read<Access>
+        [[gnu::always_inline]] inline static typename Register::Value_t get()
         {
-            set();
+            return static_cast<typename Register::Value_t>(Register::Bus_t::template read<std::uint32_t>(bit_band_alias()));
         }
 
+    protected:
         template<typename Value>
-        [[gnu::always_inline]] inline static void set_atomic()
-        {
-            set();
-        }
-    };
-
-    template<typename Field, typename Field::Size_t Value>
-    class Field_value : public Field
-    {
-        /// \brief Значение битового поля без смещения
-        static consteval auto value()
-        {
-            return Value;
-        }
-
-        [[gnu::always_inline]] static void set()
+            requires Can_write<Access>
+        [[gnu::always_inline]] inline static void set()
         {
-            Field::template set<Field_value>();
+            Register::Bus_t::template write<std::uint32_t>(bit_band_alias(), Value::value());
         }
 
+        template<typename Value>
+            requires Can_write<Access>
         [[gnu::always_inline]] inline static void set_atomic()
         {
-            Field::template set_atomic<Field_value>();
+            set<Value>();
         }
 
+        template<typename Value>
+            requires Can_read<Access>
         [[gnu::always_inline]] inline static bool is_set()
         {
-            return Field::template is_set<Field_value>();
+            return Register::Bus_t::template read<std::uint32_t>(bit_band_alias()) == Value::value();
         }
     };
-}
-
 
+    template<typename Field, typename Field::Value_t Value>
+    using Field_value = core::Field_value<Field, Value>;
+}
 
 #endif // CORTEXM3_HPP
@@ -0,0 +1,208 @@
+#ifndef DEBOUNCER_HPP
+#define DEBOUNCER_HPP
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "metautils.hpp"
+#include "port.hpp"
+
+/*!
+ * \file
+ * \brief Файл с подавлением дребезга входов, параллельным по разрядам порта
+ */
+
+namespace metaMCU::core {
+
+    /*!
+     * \brief Подавление дребезга и выделение фронтов для группы входов
+     *
+     * sample читает IDR каждого порта группы один раз. Входы двух портов
+     * упаковываются в одно 32-битное слово (второй порт - в старшей половине),
+     * и все входы слова обрабатываются одновременно вертикальным счетчиком:
+     * разряд I каждой из log2(Samples) плоскостей - это разряд счетчика входа I.
+     * Состояние входа меняется после Samples подряд идущих отсчетов, отличающихся
+     * от него, стоимость отсчета зависит от числа портов, а не входов.
+     *
+     * Положение входа (слово и разряд) вычисляется на этапе компиляции по списку.
+     * \code
+     * using Keys = Debouncer<4, PortPin<GPIOA, 0>, PortPin<GPIOC, 13>, PortPin<GPIOC, 14>>;
+     * Keys keys;
+     * keys.prime();
+     * // в прерывании 1 кГц
+     * keys.sample();
+     * if (keys.rose<PortPin<GPIOC, 13>>())
+     *     start();
+     * \endcode
+     * \tparam Samples Количество одинаковых отсчетов для смены состояния (степень двойки)
+     * \tparam T Входы (PortPin)
+     */
+    template<size_t Samples, typename... T>
+        requires (sizeof...(T) != 0) && (IsPortPin<T> && ...) && (std::has_single_bit(Samples) && Samples >= 2)
+    class Debouncer : Pins<T...>
+    {
+        using Group = Pins<T...>;
+
+    public:
+        using Word = std::uint32_t;
+
+        /// \brief Количество слов состояния (по одному на два порта)
+        static constexpr size_t words = (Group::PortsCount() + 1) / 2;
+
+        /// \brief Количество плоскостей вертикального счетчика
+        static constexpr size_t counter_bits = std::countr_zero(Samples);
+
+        using Words = std::array<Word, words>;
+
+        /// \brief Положение входа в словах состояния
+        struct Location
+        {
+            size_t word;
+            Word mask;
+        };
+
+    private:
+        /// Истина, если Pin входит в группу
+        template<typename Pin>
+        static constexpr bool contains = (std::is_same_v<Pin, T> || ...);
+
+        template<typename P, typename... Ps>
+        static consteval size_t index_of(meta_utils::TypeContainer<Ps...>)
+        {
+            size_t index = 0;
+            size_t i = 0;
+            ((index = std::is_same_v<P, Ps> ? i : index, ++i), ...);
+            return index;
+        }
+
+        /// Номер порта P в группе
+        template<typename P>
+        static constexpr size_t port_index = index_of<P>(Group::Ports());
+
+        template<typename Pin>
+        static consteval Location locate()
+        {
+            constexpr auto port = port_index<typename Pin::PortType>;
+            return {port / 2, Word{1} << (Pin::Number + Port<typename Pin::PortType>::PinsCount * (port % 2))};
+        }
+
+    public:
+        /// \brief Положение входа Pin, вычисленное на этапе компиляции
+        template<typename Pin>
+            requires contains<Pin>
+        static constexpr Location location = locate<Pin>();
+
+        /// \brief Маски входов Ps в словах состояния
+        template<typename... Ps>
+            requires (contains<Ps> && ...)
+        static consteval Words mask()
+        {
+            Words result{};
+            ((result[location<Ps>.word] |= location<Ps>.mask), ...);
+            return result;
+        }
+
+        /// \brief Считывает входы группы, одно чтение IDR на порт
+        [[gnu::always_inline]] inline static Words read()
+        {
+            Words raw{};
+            Group::ForEachPort([&raw]<typename P>
+            {
+                constexpr auto port = port_index<P>;
+                const Word input = static_cast<Word>(Port<P>::GetInput()) & Group::template PortMask<P>();
+                raw[port / 2] |= input << (Port<P>::PinsCount * (port % 2));
+            });
+            return raw;
+        }
+
+        /// \brief Принимает текущие уровни входов как устойчивые и сбрасывает счетчики
+        void prime()
+        {
+            state = read();
+            counters = {};
+            rising_edges = {};
+            falling_edges = {};
+        }
+
+        /// \brief Считывает входы и обрабатывает отсчет
+        [[gnu::always_inline]] inline void sample()
+        {
+            update(read());
+        }
+
+        /*!
+         * \brief Обрабатывает отсчет raw (результат read)
+         *
+         * Счетчик входа, уровень которого совпадает с состоянием, обнуляется,
+         * иначе увеличивается. Перенос из старшей плоскости инвертирует состояние
+         * входа и отмечает фронт.
+         */
+        void update(const Words& raw)
+        {
+            for (size_t w = 0; w < words; ++w)
+            {
+                const Word delta = raw[w] ^ state[w];
+                Word carry = delta;
+                for (auto& plane : counters)
+                {
+                    const Word bit = plane[w];
+                    plane[w] = (bit ^ carry) & delta;
+                    carry &= bit;
+                }
+                state[w] ^= carry;
+                rising_edges[w] = carry & state[w];
+                falling_edges[w] = carry & ~state[w];
+            }
+        }
+
+        /// \brief Устойчивый уровень входа
+        template<typename Pin>
+        [[gnu::always_inline]] inline bool level() const
+        {
+            return state[location<Pin>.word] & location<Pin>.mask;
+        }
+
+        /// \brief Истина, если последний отсчет установил устойчивый высокий уровень входа
+        template<typename Pin>
+        [[gnu::always_inline]] inline bool rose() const
+        {
+            return rising_edges[location<Pin>.word] & location<Pin>.mask;
+        }
+
+        /// \brief Истина, если последний отсчет установил устойчивый низкий уровень входа
+        template<typename Pin>
+        [[gnu::always_inline]] inline bool fell() const
+        {
+            return falling_edges[location<Pin>.word] & location<Pin>.mask;
+        }
+
+        /// \brief Устойчивые уровни всех входов (разряды по location)
+        const Words& levels() const
+        {
+            return state;
+        }
+
+        /// \brief Фронты последнего отсчета
+        const Words& rising() const
+        {
+            return rising_edges;
+        }
+
+        /// \brief Спады последнего отсчета
+        const Words& falling() const
+        {
+            return falling_edges;
+        }
+
+    private:
+        Words state{};
+        std::array<Words, counter_bits> counters{};
+        Words rising_edges{};
+        Words falling_edges{};
+    };
+}
+
+#endif // DEBOUNCER_HPP
@@ -0,0 +1,241 @@
+#ifndef DMA_HPP
+#define DMA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "bus.hpp"
+#include "field.hpp"
+#include "metautils.hpp"
+#include "register.hpp"
+
+/*!
+ * \file
+ * \brief Файл с потоками DMA (контроллер DMA STM32F2/F4/F7)
+ *
+ * Регистры и поля потока описываются шаблонами Register и Field, конфигурация
+ * потока записывается в CR целиком без чтения. Подключение потока и канала
+ * к периферии проверяется на этапе компиляции по списку маршрутов периферии.
+ */
+
+namespace metaMCU::dma {
+
+    /// \brief Направление передачи
+    enum class Direction : std::uint32_t
+    {
+        peripheral_to_memory = 0b00,
+        memory_to_peripheral = 0b01
+    };
+
+    /*!
+     * \brief Режим передачи
+     *
+     * - normal - однократная передача, по окончании поток отключается;
+     * - circular - по окончании передача начинается с начала буфера;
+     * - double_buffer - по окончании передача продолжается во второй буфер (ping-pong).
+     */
+    enum class Mode
+    {
+        normal,
+        circular,
+        double_buffer
+    };
+
+    /*!
+     * \brief Маршрут запроса периферии: контроллер, поток и канал
+     *
+     * Описание периферии перечисляет допустимые маршруты в списках
+     * meta_utils::TypeContainer, например Tx_routes и Rx_routes.
+     */
+    template<size_t Controller, size_t Stream, size_t Channel>
+    struct Route
+    {
+        static constexpr size_t controller = Controller;
+        static constexpr size_t stream = Stream;
+        static constexpr size_t channel = Channel;
+    };
+
+    /*!
+     * \brief Контроллер DMA
+     * \tparam Number Номер контроллера (как в Route)
+     * \tparam Base Адрес регистров контроллера
+     * \tparam Bus Политика доступа к памяти
+     */
+    template<size_t Number, size_t Base, Bus_policy Bus = core::Mmio_bus>
+    struct Controller
+    {
+        static constexpr size_t number = Number;
+        static constexpr size_t base = Base;
+        using Bus_t = Bus;
+    };
+
+    /// \brief 32-битный адрес буфера для регистров адреса памяти
+    template<Bus_policy Bus>
+    inline std::uint32_t memory_address(const void* pointer)
+    {
+        if constexpr (requires { Bus::map_memory(pointer); })
+            return Bus::map_memory(pointer);
+        else
+            return static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(pointer));
+    }
+
+    /*!
+     * \brief Поток контроллера DMA
+     * \tparam Controller Контроллер (Controller)
+     * \tparam Number Номер потока
+     */
+    template<typename Controller, size_t Number>
+        requires (Number < 8)
+    class Stream
+    {
+        using Bus_t = typename Controller::Bus_t;
+
+        template<size_t Offset>
+        using Stream_register = core::Register<Controller::base + 0x10 + 0x18 * Number + Offset, std::uint32_t, Read_write_t, Bus_t>;
+
+    public:
+        static constexpr size_t controller = Controller::number;
+        static constexpr size_t number = Number;
+
+        using CR = Stream_register<0x00>;
+        using NDTR = Stream_register<0x04>;
+        using PAR = Stream_register<0x08>;
+        using M0AR = Stream_register<0x0C>;
+        using M1AR = Stream_register<0x10>;
+        /// Регистр флагов прерываний (LISR или HISR)
+        using ISR = core::Register<Controller::base + (Number < 4 ? 0x00 : 0x04), std::uint32_t, Read_only_t, Bus_t>;
+        /// Регистр сброса флагов прерываний (LIFCR или HIFCR)
+        using IFCR = core::Register<Controller::base + (Number < 4 ? 0x08 : 0x0C), std::uint32_t, Write_only_t, Bus_t>;
+
+        using EN = core::Field<CR, 0, 1, Read_write_t>;
+        using TEIE = core::Field<CR, 2, 1, Read_write_t>;
+        using HTIE = core::Field<CR, 3, 1, Read_write_t>;
+        using TCIE = core::Field<CR, 4, 1, Read_write_t>;
+        using DIR = core::Field<CR, 6, 2, Read_write_t>;
+        using CIRC = core::Field<CR, 8, 1, Read_write_t>;
+        using MINC = core::Field<CR, 10, 1, Read_write_t>;
+        using PSIZE = core::Field<CR, 11, 2, Read_write_t>;
+        using MSIZE = core::Field<CR, 13, 2, Read_write_t>;
+        using DBM = core::Field<CR, 18, 1, Read_write_t>;
+        using CT = core::Field<CR, 19, 1, Read_write_t>;
+        using CHSEL = core::Field<CR, 25, 3, Read_write_t>;
+
+        /// \brief Флаги потока в ISR и IFCR
+        static constexpr size_t flags_offset = std::array<size_t, 4>{0, 6, 16, 22}[Number % 4];
+        static constexpr std::uint32_t te_flag = 1U << (flags_offset + 3);
+        static constexpr std::uint32_t ht_flag = 1U << (flags_offset + 4);
+        static constexpr std::uint32_t tc_flag = 1U << (flags_offset + 5);
+        static constexpr std::uint32_t all_flags = 0b111101U << flags_offset;
+
+        /*!
+         * \brief Настраивает и запускает передачу
+         *
+         * Поток останавливается, флаги сбрасываются, затем конфигурация
+         * записывается в CR и поток включается второй записью.
+         * \tparam Channel Канал запроса периферии
+         * \tparam direction Направление
+         * \tparam mode Режим
+         * \param peripheral Адрес регистра данных периферии
+         * \param memory Буфер (первый буфер в режиме double_buffer)
+         * \param second Второй буфер в режиме double_buffer, того же размера
+         */
+        template<size_t Channel, Direction direction, Mode mode = Mode::normal, typename T>
+            requires (Channel < 8) && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4)
+                     && (direction == Direction::peripheral_to_memory ? !std::is_const_v<T> : true)
+        static void start(std::uint32_t peripheral, std::span<T> memory, std::span<T> second = {})
+        {
+            constexpr std::uint32_t size = sizeof(T) == 1 ? 0b00 : sizeof(T) == 2 ? 0b01 : 0b10;
+            constexpr bool circular = mode != Mode::normal;
+
+            stop();
+            IFCR::write(all_flags);
+            PAR::write(peripheral);
+            M0AR::write(memory_address<Bus_t>(memory.data()));
+            if constexpr (mode == Mode::double_buffer)
+                M1AR::write(memory_address<Bus_t>(second.data()));
+            NDTR::write(static_cast<std::uint32_t>(memory.size()));
+
+            write_configuration<
+                core::Field_value<CHSEL, Channel>,
+                core::Field_value<DIR, static_cast<std::uint32_t>(direction)>,
+                core::Field_value<CIRC, circular>,
+                core::Field_value<DBM, mode == Mode::double_buffer>,
+                core::Field_value<MINC, 1>,
+                core::Field_value<PSIZE, size>,
+                core::Field_value<MSIZE, size>,
+                core::Field_value<TEIE, 1>,
+                core::Field_value<HTIE, circular>,
+                core::Field_value<TCIE, 1>>();
+        }
+
+        /// \brief Останавливает поток и дожидается его отключения
+        static void stop()
+        {
+            core::Field_value<EN, 0>::set();
+            while (core::Field_value<EN, 1>::is_set()) {}
+        }
+
+        /// \brief Истина, если поток включен
+        static bool busy()
+        {
+            return core::Field_value<EN, 1>::is_set();
+        }
+
+        /// \brief Количество оставшихся элементов текущего буфера
+        static std::uint32_t remaining()
+        {
+            return NDTR::read();
+        }
+
+        /// \brief Номер буфера, передача которого завершена последней, в режиме double_buffer
+        static size_t completed_buffer()
+        {
+            return core::Field_value<CT, 1>::is_set() ? 0 : 1;
+        }
+
+        /*!
+         * \brief Обрабатывает прерывание потока
+         *
+         * Сбрасывает флаги одной записью в IFCR и вызывает half при передаче
+         * половины буфера и full при передаче всего буфера.
+         * \return Ложь при ошибке передачи
+         */
+        template<typename Half, typename Full>
+        static bool handle_interrupt(Half half, Full full)
+        {
+            const auto status = ISR::read() & all_flags;
+            IFCR::write(status);
+            if (status & ht_flag)
+                half();
+            if (status & tc_flag)
+                full();
+            return !(status & te_flag);
+        }
+
+    private:
+        template<typename... Vs>
+        [[gnu::always_inline]] inline static void write_configuration()
+        {
+            CR::template values_write<Vs...>();
+            CR::template values_write<Vs..., core::Field_value<EN, 1>>();
+        }
+    };
+
+    /// \brief Канал маршрута потока Stream из списка Routes или -1, если поток не подключен
+    template<typename Stream, typename... Routes>
+    consteval int channel_of(meta_utils::TypeContainer<Routes...>)
+    {
+        int channel = -1;
+        ((Routes::controller == Stream::controller && Routes::stream == Stream::number ? channel = static_cast<int>(Routes::channel) : 0), ...);
+        return channel;
+    }
+
+    /// \brief Проверка подключения потока к периферии по списку маршрутов
+    template<typename Stream, typename Routes>
+    concept Connected = channel_of<Stream>(Routes()) >= 0;
+}
+
+#endif // DMA_HPP
@@ -0,0 +1,51 @@
+#ifndef DWT_HPP
+#define DWT_HPP
+
+#include <cstdint>
+
+#include "bus.hpp"
+#include "field.hpp"
+#include "register.hpp"
+
+/*!
+ * \file
+ * \brief Файл со счетчиком тактов DWT Cortex-M3/M4
+ */
+
+namespace metaMCU::CortexM3 {
+
+    /*!
+     * \brief Счетчик тактов ядра DWT_CYCCNT
+     *
+     * Счетчик 32-битный и переполняется, разность двух отсчетов корректна
+     * при интервале меньше 2^32 тактов.
+     * \tparam Bus Политика доступа к памяти
+     */
+    template<Bus_policy Bus = core::Mmio_bus>
+    class Dwt
+    {
+    public:
+        using DEMCR = core::Register<0xE000EDFC, std::uint32_t, Read_write_t, Bus>;
+        using CTRL = core::Register<0xE0001000, std::uint32_t, Read_write_t, Bus>;
+        using CYCCNT = core::Register<0xE0001004, std::uint32_t, Read_write_t, Bus>;
+
+        using TRCENA = core::Field<DEMCR, 24, 1, Read_write_t>;
+        using CYCCNTENA = core::Field<CTRL, 0, 1, Read_write_t>;
+
+        /// \brief Включает трассировку и запускает счетчик с нуля
+        static void enable()
+        {
+            core::Field_value<TRCENA, 1>::set();
+            CYCCNT::write(0);
+            core::Field_value<CYCCNTENA, 1>::set();
+        }
+
+        /// \brief Текущее значение счетчика тактов
+        [[gnu::always_inline]] inline static std::uint32_t cycles()
+        {
+            return CYCCNT::read();
+        }
+    };
+}
+
+#endif // DWT_HPP
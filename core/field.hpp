@@ -3,6 +3,8 @@
 
 #include <concepts>
 #include <cstddef>
+#include <limits>
+#include <string_view>
 
 #include "register.hpp"
 
@@ -28,7 +30,7 @@ namespace metaMCU::core {
      * \brief Обеспечивает безопасный доступ к битовым полям регистров
      * микроконтроллера
      * \warning Данный шаблонный класс разработан для работы вместе
-     * со скриптом RegistersGenerator, подставляющим в шаблонные
+     * со скриптом RegistersGenerator (tools/registersgenerator.py), подставляющим в шаблонные
      * параметры по информацию из svd файла и автоматически
      * генерирующим соответствующие заголовочные файлы. Инстанцирование этого
      * класса "вручную" должно производится только при крайней необходимости.
@@ -42,6 +44,7 @@ namespace metaMCU::core {
     {
     public:
         using Value_t = typename Register::Value_t;
+        using Register_t = Register;
 
         /// \brief Смещение поля в бит от 0
         static consteval auto bit_offset()
@@ -58,7 +61,31 @@ namespace metaMCU::core {
         /// \brief Маска битового поля
         static consteval auto mask()
         {
-            return ((1 << size()) - 1) << bit_offset();
+            return static_cast<Value_t>(std::numeric_limits<Value_t>::max() >> (std::numeric_limits<Value_t>::digits - size()) << bit_offset());
+        }
+
+        /// \brief Записывает значение, известное во время выполнения, сохраняя другие поля регистра
+        template<typename T = void>
+            requires Can_read<Access> && Can_write<Access>
+        [[gnu::always_inline]] inline static void set(Value_t value)
+        {
+            Register::template fields_set<Field>(value);
+        }
+
+        /// \brief Записывает значение, известное во время выполнения, сбрасывая другие поля регистра
+        template<typename T = void>
+            requires Can_write<Access>
+        [[gnu::always_inline]] inline static void write(Value_t value)
+        {
+            Register::template fields_write<Field>(value);
+        }
+
+        /// \brief Возвращает значение поля без смещения
+        template<typename T = void>
+            requires Can_read<Access>
+        [[gnu::always_inline]] inline static Value_t get()
+        {
+            return static_cast<Value_t>((Register::read() & mask()) >> bit_offset());
         }
 
     protected:
@@ -70,6 +97,14 @@ namespace metaMCU::core {
             Register::template values_set<Value>();
         }
 
+        /// \brief Атомарно записывает значение в битовое поле регистра
+        template<typename Value>
+            requires Can_read<Access> && Can_write<Access> && Can_atomic_write<Register>
+        [[gnu::always_inline]] inline static void set_atomic()
+        {
+            Register::template values_set_atomic<Value>();
+        }
+
         /// \brief Записывает значение в битовое поле регистра, если регистр позволяет запись
         template<typename Value>
             requires Can_write<Access>
@@ -81,15 +116,21 @@ namespace metaMCU::core {
         /// \brief Возвращает значение битового поля регистра
         template<typename Value>
             requires Can_read<Access>
-        [[gnu::always_inline]] inline static Register::Value_t is_set()
+        [[gnu::always_inline]] inline static bool is_set()
         {
-            Register::template values_is_set<Value>();
+            return Register::template values_is_set<Value>();
         }
     };
 
-    template<typename Field, typename Field::Size_t Value>
+    /*!
+     * \brief Значение битового поля
+     * \tparam Field Битовое поле
+     * \tparam Value Значение поля без смещения
+     */
+    template<typename Field, typename Field::Value_t Value>
     class Field_value : public Field
     {
+    public:
         /// \brief Значение битового поля без смещения
         static consteval auto value()
         {
@@ -101,11 +142,45 @@ namespace metaMCU::core {
             Field::template set<Field_value>();
         }
 
+        [[gnu::always_inline]] static void write()
+        {
+            Field::template write<Field_value>();
+        }
+
+        [[gnu::always_inline]] inline static void set_atomic()
+        {
+            Field::template set_atomic<Field_value>();
+        }
+
         [[gnu::always_inline]] inline static bool is_set()
         {
             return Field::template is_set<Field_value>();
         }
     };
+
+    /// \brief Тип доступа к битовому полю в таблицах раскладки
+    enum class Field_access
+    {
+        read_only,
+        write_only,
+        read_write
+    };
+
+    /*!
+     * \brief Описание битового поля для constexpr таблиц раскладки периферии
+     *
+     * Таблицы генерируются скриптом RegistersGenerator для каждой периферии
+     * и позволяют обходить поля на этапе компиляции или выводить их при отладке.
+     */
+    struct Field_layout
+    {
+        std::string_view register_name;
+        std::string_view name;
+        size_t address;
+        size_t offset;
+        size_t size;
+        Field_access access;
+    };
 }
 
 #endif // FIELD_HPP
@@ -1,88 +1,359 @@
 #ifndef FIELDS_HPP
 #define FIELDS_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
 #include "metautils.hpp"
 
+/*!
+ * \brief Порядок записи регистра в Values::Set
+ *
+ * Регистры с меньшим значением записываются раньше, при равных значениях
+ * сохраняется порядок первого упоминания в Values. Специализируется для
+ * регистров, запись в которые должна предшествовать остальным, например
+ * для регистров включения тактирования периферии:
+ * \code
+ * template<> struct SetOrder<RCC_AHB1ENR> : std::integral_constant<int, -1> {};
+ * \endcode
+ */
+template<typename Register>
+struct SetOrder : std::integral_constant<int, 0> {};
+
 template<typename... Vs>
-    requires (sizeof...(Vs) != 0) && NoDuplicates<Vs...>
-class Values
+    requires (sizeof...(Vs) != 0)
+class Values;
+
+namespace meta_utils {
+    template<typename... Xs, typename V>
+    consteval auto operator|(TypeContainer<Xs...>, TypeContainer<V>)
+    {
+        return TypeContainer<Xs..., V>();
+    }
+
+    template<typename... Xs, typename... Vs>
+    consteval auto operator|(TypeContainer<Xs...>, TypeContainer<Values<Vs...>>)
+    {
+        return TypeContainer<Xs..., Vs...>();
+    }
+
+    /*!
+     * \brief Разворачивает вложенные Values в плоский список значений полей
+     *
+     * Набор без вложенных Values выбирается ограничением специализации, без
+     * функций: имя функции с пакетом в параметрах шаблона компилятор строит
+     * за время, квадратичное от размера пакета.
+     */
+    template<typename... Vs>
+    struct Flatten
+    {
+        using type = decltype((TypeContainer() | ... | TypeContainer<Vs>()));
+    };
+
+    template<typename... Vs>
+        requires (IsFieldValue<Vs> && ...)
+    struct Flatten<Vs...>
+    {
+        using type = TypeContainer<Vs...>;
+    };
+}
+
+/*!
+ * \brief Запись и проверка значений полей одного регистра
+ *
+ * Параметризуется итоговыми маской и значением, а не пакетом значений полей:
+ * для всех значений одного регистра план - один и тот же тип.
+ * \tparam R Регистр
+ * \tparam SetMask Разряды регистра, изменяемые Set
+ * \tparam SetBits Значения разрядов SetMask после Set
+ * \tparam Single Значение поля, если оно единственное для регистра в наборе, иначе void
+ */
+template<typename R, typename R::Value_t SetMask, typename R::Value_t SetBits, typename Single = void>
+class RegisterPlan
 {
 public:
+    using RegisterType = R;
+
+    /// Количество чтений и записей регистра при Set и IsSet
+    static consteval size_t SetReads() { return Modifies() ? R::read_accesses : 0; }
+    static consteval size_t SetWrites() { return 1; }
+    static consteval size_t IsSetReads() { return R::read_accesses; }
+
     [[gnu::always_inline]] inline static void Set()
     {
-        recursiveSet(deduplicatedRegisters, values);
+        if constexpr (bitBand())
+            Single::set();
+        else if constexpr (Modifies())
+            R::write(static_cast<typename R::Value_t>((R::read() & ~SetMask) | SetBits));
+        else
+            R::write(SetBits);
     }
 
     [[gnu::always_inline]] inline static bool IsSet()
     {
-        return recursiveIsSet(deduplicatedRegisters, values);
+        return (R::read() & SetMask) == SetBits;
     }
 
-private:
+    /// Разряды регистра, изменяемые Set
+    static consteval auto Mask()
+    {
+        return SetMask;
+    }
 
-    template<typename... Xs>
-        requires (IsFieldValue<Xs> && ...) && NoDuplicates<Xs...>
-    static consteval auto deduplicateRegisters(meta_utils::TypeContainer<Xs...>)
+    /// Значения разрядов Mask после Set
+    static consteval auto Value()
     {
-        return (... + meta_utils::TypeContainer<typename Xs::Register>());
+        return SetBits;
     }
 
-    static constexpr auto values = (meta_utils::TypeContainer() | ... | meta_utils::TypeContainer<Vs>());
-    static constexpr auto deduplicatedRegisters = deduplicateRegisters(values);
+    /*!
+     * \brief Истина, если Set выполняет чтение-модификацию-запись, иначе регистр записывается без чтения
+     *
+     * Без чтения регистр записывается, если поля покрывают весь регистр, если единственное
+     * однобитовое поле записывается через псевдоним bit-band и если регистр не поддерживает
+     * values_set (доступен только для записи).
+     */
+    static consteval bool Modifies()
+    {
+        if constexpr (SetMask == std::numeric_limits<typename R::Value_t>::max() || bitBand())
+            return false;
+        else
+            return requires { R::template values_set<>(); };
+    }
 
-    template<typename R, typename... Xs>
-    [[gnu::always_inline]] inline static void applyToRegister(meta_utils::TypeContainer<R, Xs...>)
+private:
+    static consteval bool bitBand()
     {
-        R::template SetFields<Xs...>();
+        if constexpr (std::is_void_v<Single>)
+            return false;
+        else
+            return requires { Single::bit_band_alias(); }
+                   && metaMCU::Hardware_modified_bits<R::address()>::value == 0;
     }
+};
+
+/*!
+ * \brief Планы регистров в порядке записи
+ *
+ * Функции записи и проверки параметризуются только планами регистров: имя каждой
+ * функции, вложенной в класс с полным пакетом значений полей, компилятор строит
+ * за время, квадратичное от размера пакета.
+ * \tparam Ps Планы регистров (RegisterPlan)
+ */
+template<typename... Ps>
+class RegisterPlans
+{
+public:
+    static constexpr size_t set_reads = (size_t{0} + ... + Ps::SetReads());
+    static constexpr size_t set_writes = (size_t{0} + ... + Ps::SetWrites());
+    static constexpr size_t is_set_reads = (size_t{0} + ... + Ps::IsSetReads());
 
-    template<typename R, typename... Xs>
-    [[gnu::always_inline]] inline static bool checkRegister(meta_utils::TypeContainer<R, Xs...>)
+    [[gnu::always_inline]] inline static void Set()
     {
-        return R::template IsSetFields<Xs...>();
+        (Ps::Set(), ...);
     }
 
-    template<typename R, typename... Rs, typename... Xs>
-    [[gnu::always_inline]] inline static void recursiveSet(meta_utils::TypeContainer<R, Rs...>, meta_utils::TypeContainer<Xs...> values)
+    [[gnu::always_inline]] inline static bool IsSet()
     {
-        constexpr auto matched = (meta_utils::TypeContainer<R>() & ... & meta_utils::TypeContainer<Xs>());
-        applyToRegister(matched);
+        return (Ps::IsSet() && ...);
+    }
 
-        if constexpr (sizeof ...(Rs) != 0)
-        {
-            constexpr meta_utils::TypeContainer<Rs...> registers;
-            recursiveSet(registers, values);
-        }
+    /// Вызывает visit.template operator()<RegisterPlan>() для каждого плана
+    template<typename F>
+    static constexpr void ForEach(F visit)
+    {
+        (visit.template operator()<Ps>(), ...);
     }
+};
+
+namespace meta_utils {
+    enum class FieldConflict { none, duplicate, overlap };
 
-    template<typename R, typename ... Rs, typename... Xs>
-    [[gnu::always_inline]] inline static bool recursiveIsSet(meta_utils::TypeContainer<R, Rs...>, meta_utils::TypeContainer<Xs...> values)
+    /// Группы регистров набора из N значений полей, их маски, значения и порядок записи
+    template<size_t N>
+    struct RegistersLayout
     {
-        constexpr auto matched = (meta_utils::TypeContainer<R>() & ... & meta_utils::TypeContainer<Xs>());
-        if(!checkRegister(matched))
-            return false;
-        else
+        Groups<N> groups;
+        std::array<std::uint64_t, N> mask{};
+        std::array<std::uint64_t, N> value{};
+        std::array<size_t, N> count{};
+        /// Группы в порядке записи: по приоритету, затем по первому упоминанию
+        std::array<size_t, N> order{};
+        /// Повторы и перекрытия: маски значений одной группы не должны пересекаться
+        FieldConflict conflict = FieldConflict::none;
+    };
+
+    /*!
+     * \brief Группирует значения полей по регистрам, накапливает маски и значения групп
+     * \param registers Идентификаторы типов регистров значений
+     * \param addresses Адреса регистров значений
+     * \param ids Идентификаторы типов значений
+     * \param masks Маски полей
+     * \param values Значения полей со смещением
+     * \param priorities Приоритеты записи регистров значений (SetOrder)
+     */
+    template<size_t N>
+    consteval RegistersLayout<N> layout(const std::array<const void*, N>& registers, const std::array<size_t, N>& addresses,
+                                        const std::array<const void*, N>& ids, const std::array<std::uint64_t, N>& masks,
+                                        const std::array<std::uint64_t, N>& values, const std::array<int, N>& priorities)
+    {
+        RegistersLayout<N> result;
+        const auto& groups = result.groups = group(registers, addresses);
+
+        for (size_t i = 0; i < N; ++i)
         {
-            if constexpr (sizeof ...(Rs) != 0)
+            const auto g = groups.of[i];
+            if (result.conflict != FieldConflict::duplicate && (result.mask[g] & masks[i]))
             {
-                constexpr meta_utils::TypeContainer<Rs...> registers;
-                return recursiveIsSet(registers, values);
+                result.conflict = FieldConflict::overlap;
+                for (auto m = groups.begin[g]; groups.members[m] != i; ++m)
+                    if (ids[groups.members[m]] == ids[i])
+                        result.conflict = FieldConflict::duplicate;
             }
-            return true;
+            result.mask[g] |= masks[i];
+            result.value[g] |= values[i];
+            ++result.count[g];
         }
+
+        for (size_t i = 0; i < groups.count; ++i)
+        {
+            auto j = i;
+            for (; j > 0 && priorities[groups.first[result.order[j - 1]]] > priorities[groups.first[i]]; --j)
+                result.order[j] = result.order[j - 1];
+            result.order[j] = i;
+        }
+        return result;
     }
-};
+}
 
-template<typename... Xs, typename V>
-consteval auto operator|(meta_utils::TypeContainer<Xs...> lhs, meta_utils::TypeContainer<V> rhs)
+/*!
+ * \brief Значения полей, сгруппированные по регистрам
+ *
+ * Значения группируются одним проходом с сортировкой по адресам регистров (meta_utils::group),
+ * маски и значения групп накапливаются в одной constexpr структуре. План регистра зависит только
+ * от номера группы, поэтому тип значения по индексу (Nth) выбирается один раз на регистр,
+ * а не на каждое значение: каждый такой выбор обходится компилятору в O(N).
+ *
+ * Кроме layout, функций и статических переменных в классе нет: их имена содержат весь
+ * пакет значений и строятся компилятором за время, квадратичное от размера пакета.
+ * \tparam Xs Плоский список значений полей
+ */
+template<typename... Xs>
+    requires (IsFieldValue<Xs> && ...)
+class RegistersPlan
 {
-    return meta_utils::TypeContainer<Xs..., V>();
-}
+public:
+    static constexpr auto layout = meta_utils::layout(
+        std::array<const void*, sizeof...(Xs)>{meta_utils::typeId<typename Xs::Register_t>()...},
+        std::array<size_t, sizeof...(Xs)>{Xs::Register_t::address()...},
+        std::array<const void*, sizeof...(Xs)>{meta_utils::typeId<Xs>()...},
+        std::array<std::uint64_t, sizeof...(Xs)>{std::uint64_t{Xs::mask()}...},
+        std::array<std::uint64_t, sizeof...(Xs)>{std::uint64_t{static_cast<typename Xs::Register_t::Value_t>(Xs::value() << Xs::bit_offset())}...},
+        std::array<int, sizeof...(Xs)>{SetOrder<typename Xs::Register_t>::value...});
+
+private:
+    /// Первое значение группы G
+    template<size_t G>
+    using FirstOf = meta_utils::Nth<layout.groups.first[G], Xs...>;
 
-template<typename... Xs, typename... Vs>
-consteval auto operator|(meta_utils::TypeContainer<Xs...> lhs, meta_utils::TypeContainer<Values<Vs...>> rhs)
+    /// RegisterPlan регистра группы G
+    template<size_t G, typename R = typename FirstOf<G>::Register_t>
+    using Plan = RegisterPlan<R, static_cast<typename R::Value_t>(layout.mask[G]), static_cast<typename R::Value_t>(layout.value[G]),
+                              std::conditional_t<layout.count[G] == 1, FirstOf<G>, void>>;
+
+    template<typename Is = std::make_index_sequence<layout.groups.count>>
+    struct Ordered;
+
+    template<size_t... G>
+    struct Ordered<std::index_sequence<G...>>
+    {
+        using type = RegisterPlans<Plan<layout.order[G]>...>;
+    };
+
+public:
+    /// Планы регистров в порядке записи Set
+    using Plans = typename Ordered<>::type;
+};
+
+/*!
+ * \brief Набор значений битовых полей, возможно относящихся к разным регистрам
+ *
+ * Значения группируются по регистрам на этапе компиляции, для каждого регистра
+ * выбирается минимальный способ записи:
+ * - если перечисленные поля покрывают весь регистр, выполняется запись без чтения;
+ * - единственное однобитовое поле из области bit-band записывается одной записью в псевдоним,
+ *   если в регистре нет аппаратно изменяемых бит (Hardware_modified_bits);
+ * - если регистр не поддерживает values_set (доступен только для записи),
+ *   выполняется запись без чтения;
+ * - иначе выполняется чтение-модификация-запись копии или регистра.
+ *
+ * Регистры записываются и проверяются в порядке SetOrder, затем в порядке первого упоминания.
+ * Повторы и перекрытия полей проверяются при любом использовании набора (Set, IsSet,
+ * счетчики обращений, ForEachRegister) внутри групп, поэтому время компиляции
+ * растет почти линейно с размером набора (см. tests/compiletimebench.py).
+ *
+ * Количество обращений к шине известно на этапе компиляции и может
+ * ограничиваться в коде пользователя:
+ * \code
+ * using Init = Values<GPIOA::MODER::MODER5::Output, GPIOA::OTYPER::OT5::PushPull>;
+ * static_assert(Init::SetReads() <= 2 && Init::SetWrites() == 2);
+ * \endcode
+ * \tparam Vs Значения полей или вложенные Values
+ */
+template<typename... Vs>
+    requires (sizeof...(Vs) != 0)
+class Values
 {
-    return meta_utils::TypeContainer<Xs..., Vs...>();
-}
+public:
+
+    [[gnu::always_inline]] inline static void Set()
+    {
+        Plan::Plans::Set();
+    }
+
+    [[gnu::always_inline]] inline static bool IsSet()
+    {
+        return Plan::Plans::IsSet();
+    }
+
+    /// Количество чтений регистров при Set
+    static consteval size_t SetReads()
+    {
+        return Plan::Plans::set_reads;
+    }
+
+    /// Количество записей в регистры при Set
+    static consteval size_t SetWrites()
+    {
+        return Plan::Plans::set_writes;
+    }
+
+    /// Количество чтений регистров при IsSet
+    static consteval size_t IsSetReads()
+    {
+        return Plan::Plans::is_set_reads;
+    }
+
+    /// Вызывает visit.template operator()<RegisterPlan>() для каждого регистра в порядке записи Set
+    template<typename F>
+    static constexpr void ForEachRegister(F visit)
+    {
+        Plan::Plans::ForEach(visit);
+    }
+
+private:
+    template<typename... Xs>
+    static RegistersPlan<Xs...> toPlan(meta_utils::TypeContainer<Xs...>);
+
+    using Plan = decltype(toPlan(typename meta_utils::Flatten<Vs...>::type()));
+
+    // Повторы во вложенных Values и перекрытия полей видны только после разворачивания
+    static_assert(Plan::layout.conflict != meta_utils::FieldConflict::duplicate, "Values contain duplicate field values");
+    static_assert(Plan::layout.conflict != meta_utils::FieldConflict::overlap, "Values contain overlapping fields of the same register");
+};
 
 #endif // FIELDS_HPP
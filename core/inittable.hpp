@@ -0,0 +1,190 @@
+#ifndef INITTABLE_HPP
+#define INITTABLE_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bus.hpp"
+#include "fields.hpp"
+#include "register.hpp"
+
+/*!
+ * \file
+ * \brief Файл с табличным выполнением последовательностей инициализации регистров
+ *
+ * Values::Set встраивает загрузку констант и чтение-модификацию-запись каждого
+ * регистра в место вызова. Для длинных последовательностей (загрузка, настройка
+ * периферии) Init_table сворачивает наборы Values в таблицу записей во флеш-памяти,
+ * которую выполняет один общий цикл run_init_table. Код не растет с длиной
+ * последовательности, а соседние записи одного регистра объединяются на этапе компиляции.
+ */
+
+namespace metaMCU::core {
+
+    /// \brief Операция записи таблицы инициализации
+    enum class Init_op : std::uint8_t
+    {
+        write,  ///< Запись set без чтения
+        modify  ///< Чтение, сброс разрядов clear, установка set, запись
+    };
+
+    /// \brief Запись таблицы инициализации
+    struct Init_record
+    {
+        std::uint32_t address;
+        std::uint32_t clear;
+        std::uint32_t set;
+        Init_op op;
+        std::uint8_t size;  ///< Разрядность регистра в байтах
+    };
+
+    /*!
+     * \brief Выполняет таблицу инициализации
+     *
+     * Не встраивается: один экземпляр цикла на политику доступа обслуживает все таблицы.
+     * \tparam Bus Политика доступа к памяти
+     */
+    template<Bus_policy Bus>
+    [[gnu::noinline]] void run_init_table(std::span<const Init_record> records)
+    {
+        for (const auto& r : records)
+        {
+            auto apply = [&r]<typename Value_t>()
+            {
+                auto value = static_cast<Value_t>(r.set);
+                if (r.op == Init_op::modify)
+                    value |= Bus::template read<Value_t>(r.address) & static_cast<Value_t>(~r.clear);
+                Bus::template write<Value_t>(r.address, value);
+            };
+
+            if (r.size == 4)
+                apply.template operator()<std::uint32_t>();
+            else if (r.size == 2)
+                apply.template operator()<std::uint16_t>();
+            else
+                apply.template operator()<std::uint8_t>();
+        }
+    }
+
+    /*!
+     * \brief Последовательность инициализации, выполняемая по таблице
+     *
+     * Каждый набор записывается так же, как Values::Set: регистры в порядке SetOrder,
+     * полностью заданные и доступные только для записи - без чтения, остальные -
+     * чтением-модификацией-записью. Наборы
+     * выполняются по порядку, соседние записи одного регистра объединяются
+     * в одну (запись, за которой следует изменение, остается записью).
+     * Однобитовые поля bit-band выполняются чтением-модификацией-записью слова.
+     * \code
+     * using Boot = Init_table<Values<RCC_AHB1ENR::GPIOAEN::Enable>, Values<GPIOA_MODER5::Output, ...>>;
+     * Boot::run();
+     * \endcode
+     * \tparam Vs Наборы значений (Values) или отдельные значения полей, все регистры на одной шине
+     */
+    template<typename... Vs>
+        requires (sizeof...(Vs) != 0)
+    class Init_table
+    {
+        template<typename V>
+        using Pack = std::conditional_t<IsFieldValue<V>, Values<V>, V>;
+
+        /// Регистр первого значения набора
+        template<typename V>
+        struct First_register
+        {
+            using type = typename V::Register_t;
+        };
+
+        template<typename X, typename... Xs>
+        struct First_register<Values<X, Xs...>> : First_register<X> {};
+
+        using Bus = typename First_register<std::tuple_element_t<0, std::tuple<Vs...>>>::type::Bus_t;
+
+        static consteval size_t raw_count()
+        {
+            size_t count = 0;
+            (Pack<Vs>::ForEachRegister([&count]<typename>() { ++count; }), ...);
+            return count;
+        }
+
+        /// Записи всех наборов и количество записей после объединения соседних
+        static consteval auto merge()
+        {
+            std::array<Init_record, raw_count()> result{};
+            size_t count = 0;
+            auto add = [&result, &count]<typename P>()
+            {
+                using R = typename P::RegisterType;
+                using Value_t = typename R::Value_t;
+                static_assert(std::is_same_v<typename R::Bus_t, Bus>, "Init_table registers must share one bus policy");
+                using Plain = Register<R::address(), Value_t, typename R::Access_t, Bus>;
+                static_assert(std::derived_from<R, Plain> && R::read_accesses == Plain::read_accesses,
+                              "Init_table supports only registers without a shadow copy");
+
+                // Запись через псевдоним bit-band не изменяет остальные разряды слова, поэтому
+                // без чтения записывается только полностью заданный регистр или регистр только для записи
+                constexpr bool full = P::Mask() == std::numeric_limits<Value_t>::max();
+                constexpr bool write_only = !requires { R::template values_set<>(); };
+                const Init_record record{static_cast<std::uint32_t>(R::address()), static_cast<std::uint32_t>(P::Mask()),
+                                         static_cast<std::uint32_t>(P::Value()), full || write_only ? Init_op::write : Init_op::modify,
+                                         static_cast<std::uint8_t>(sizeof(Value_t))};
+                if (count != 0 && result[count - 1].address == record.address)
+                {
+                    auto& last = result[count - 1];
+                    if (record.op == Init_op::write)
+                        last = record;
+                    else
+                    {
+                        last.set = (last.set & ~record.clear) | record.set;
+                        last.clear |= record.clear;
+                    }
+                }
+                else
+                    result[count++] = record;
+            };
+            (Pack<Vs>::ForEachRegister(add), ...);
+            return std::pair{result, count};
+        }
+
+    public:
+        /// \brief Записи таблицы, хранятся во флеш-памяти
+        static constexpr auto records = []
+        {
+            constexpr auto merged = merge();
+            std::array<Init_record, merged.second> result{};
+            for (size_t i = 0; i < result.size(); ++i)
+                result[i] = merged.first[i];
+            return result;
+        }();
+
+        /// \brief Выполняет последовательность
+        static void run()
+        {
+            run_init_table<Bus>(records);
+        }
+
+        /// \brief Количество чтений регистров при run
+        static consteval size_t reads()
+        {
+            size_t count = 0;
+            for (const auto& r : records)
+                count += r.op == Init_op::modify ? 1 : 0;
+            return count;
+        }
+
+        /// \brief Количество записей в регистры при run
+        static consteval size_t writes()
+        {
+            return records.size();
+        }
+    };
+}
+
+#endif // INITTABLE_HPP
@@ -0,0 +1,234 @@
+#ifndef INTERRUPTS_HPP
+#define INTERRUPTS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "bus.hpp"
+#include "field.hpp"
+#include "fields.hpp"
+#include "register.hpp"
+
+/*!
+ * \file
+ * \brief Файл с таблицей векторов прерываний и настройкой NVIC Cortex-M
+ *
+ * Таблица векторов строится на этапе компиляции из списка привязок
+ * обработчиков к прерываниям: каждый вектор указывает непосредственно
+ * на обработчик, без промежуточной диспетчеризации. Из того же списка
+ * выводятся значения полей NVIC, разрешающих прерывания и задающих их
+ * приоритеты.
+ */
+
+namespace metaMCU::CortexM3 {
+
+    /// \brief Обработчик прерывания
+    using Handler = void (*)();
+
+    /// \brief Номера системных исключений (как IRQn_Type в CMSIS)
+    enum Exception : int
+    {
+        NMI = -14,
+        HARD_FAULT = -13,
+        MEM_MANAGE = -12,
+        BUS_FAULT = -11,
+        USAGE_FAULT = -10,
+        SV_CALL = -5,
+        DEBUG_MONITOR = -4,
+        PEND_SV = -2,
+        SYS_TICK = -1
+    };
+
+    /// \brief Истина, если номер соответствует существующему системному исключению
+    constexpr bool is_exception(int irq)
+    {
+        return (irq >= NMI && irq <= USAGE_FAULT) || irq == SV_CALL || irq == DEBUG_MONITOR || irq == PEND_SV || irq == SYS_TICK;
+    }
+
+    /*!
+     * \brief Привязка обработчика к прерыванию
+     * \tparam irq Номер прерывания (отрицательный для системных исключений)
+     * \tparam handler Обработчик
+     * \tparam priority Приоритет, меньшее значение - более высокий приоритет
+     */
+    template<int irq, Handler handler, std::uint8_t priority = 0>
+        requires (handler != nullptr) && (irq >= 0 || is_exception(irq))
+    struct Irq_binding
+    {
+        static constexpr int Irq = irq;
+        static constexpr Handler Handler_v = handler;
+        static constexpr std::uint8_t Priority = priority;
+    };
+
+    /// \brief Обработка векторов, для которых нет привязки
+    enum class Unbound
+    {
+        /// Вектор указывает на обработчик Default
+        to_default,
+        /// Ошибка компиляции: должны быть привязаны все исключения и прерывания
+        forbidden
+    };
+
+    /// \brief Размещение таблицы векторов в памяти: начальный указатель стека и векторы
+    template<size_t Irq_count>
+    struct Vector_table_layout
+    {
+        const void* stack_top;
+        std::array<Handler, 15 + Irq_count> handlers;
+    };
+
+    /*!
+     * \brief Таблица векторов и значения NVIC
+     *
+     * Повторная привязка прерывания и номер вне таблицы приводят к ошибке
+     * компиляции. Не привязанные прерывания указывают на Default, а при
+     * table<Unbound::forbidden>() приводят к ошибке компиляции.
+     * Таблица размещается пользователем в секции, на которую указывает
+     * скрипт компоновки:
+     * \code
+     * using Vectors = Vector_table<82, 4, reset_handler, default_handler,
+     *     Irq_binding<SYS_TICK, systick_handler, 15>,
+     *     Irq_binding<USART1_IRQn, usart1_handler, 5>>;
+     * [[gnu::section(".isr_vector"), gnu::used]] constexpr auto vectors = Vectors::table(&_estack);
+     * ...
+     * Vectors::Nvic_values<>::Set();
+     * \endcode
+     * \tparam Irq_count Количество прерываний периферии
+     * \tparam Priority_bits Количество реализованных разрядов приоритета
+     * \tparam Reset Обработчик сброса
+     * \tparam Default Обработчик не привязанных прерываний
+     * \tparam Bindings Привязки обработчиков (Irq_binding)
+     */
+    template<size_t Irq_count, std::uint8_t Priority_bits, Handler Reset, Handler Default, typename... Bindings>
+        requires (Reset != nullptr) && (Default != nullptr) && (Priority_bits > 0) && (Priority_bits <= 8)
+    class Vector_table
+    {
+        static_assert(((Bindings::Irq < static_cast<int>(Irq_count)) && ...), "Interrupt number is out of the vector table");
+        static_assert(((Bindings::Priority < (1U << Priority_bits)) && ...), "Interrupt priority does not fit into implemented priority bits");
+        static_assert(((Bindings::Priority == 0 || Bindings::Irq >= MEM_MANAGE) && ...), "NMI and HardFault priorities are fixed");
+
+        template<size_t Address, typename Access, Bus_policy Bus>
+        using Nvic_register = core::Register<Address, std::uint32_t, Access, Bus>;
+
+        /// Приоритет прерывания в IPR или системного исключения в SHPR
+        template<Bus_policy Bus, typename Binding>
+        static consteval auto priority_of()
+        {
+            constexpr int irq = Binding::Irq;
+            constexpr std::uint32_t priority = static_cast<std::uint32_t>(Binding::Priority) << (8 - Priority_bits);
+
+            if constexpr (irq >= 0)
+            {
+                using Ipr = Nvic_register<0xE000E400 + 4 * (irq / 4), Read_write_t, Bus>;
+                return meta_utils::TypeContainer<core::Field_value<core::Field<Ipr, 8 * (irq % 4), 8, Read_write_t>, priority>>();
+            }
+            else if constexpr (irq >= MEM_MANAGE)
+            {
+                constexpr int exception = irq + 16;
+                using Shpr = Nvic_register<0xE000ED18 + 4 * ((exception - 4) / 4), Read_write_t, Bus>;
+                return meta_utils::TypeContainer<core::Field_value<core::Field<Shpr, 8 * (exception % 4), 8, Read_write_t>, priority>>();
+            }
+            else
+                return meta_utils::TypeContainer<>();
+        }
+
+        /// Бит разрешения прерывания периферии в ISER
+        template<Bus_policy Bus, typename Binding>
+        static consteval auto enable_of()
+        {
+            constexpr int irq = Binding::Irq;
+
+            if constexpr (irq >= 0)
+            {
+                using Iser = Nvic_register<0xE000E100 + 4 * (irq / 32), Write_only_t, Bus>;
+                return meta_utils::TypeContainer<core::Field_value<core::Field<Iser, irq % 32, 1, Write_only_t>, 1>>();
+            }
+            else
+                return meta_utils::TypeContainer<>();
+        }
+
+        /// Пустой набор значений, если не привязано ни одного настраиваемого прерывания
+        struct No_values
+        {
+            static void Set() {}
+            static bool IsSet() { return true; }
+            static consteval size_t SetReads() { return 0; }
+            static consteval size_t SetWrites() { return 0; }
+            static consteval size_t IsSetReads() { return 0; }
+            template<typename F>
+            static constexpr void ForEachRegister(F) {}
+        };
+
+        template<typename... Xs>
+        static Values<Xs...> to_values(meta_utils::TypeContainer<Xs...>);
+        static No_values to_values(meta_utils::TypeContainer<>);
+
+    public:
+        using Layout = Vector_table_layout<Irq_count>;
+
+        /*!
+         * \brief Таблица векторов с заданным начальным указателем стека
+         * \tparam unbound Обработка векторов без привязки
+         */
+        template<Unbound unbound = Unbound::to_default>
+        static consteval Layout table(const void* stack_top)
+        {
+            static_assert(unique(), "Interrupt is bound more than once");
+            static_assert(unbound != Unbound::forbidden || sizeof...(Bindings) == exception_count + Irq_count,
+                          "Not every exception and interrupt is bound");
+
+            Layout layout{stack_top, {}};
+            layout.handlers[0] = Reset;
+            for (int irq = NMI; irq < static_cast<int>(Irq_count); ++irq)
+                if (irq >= 0 || is_exception(irq))
+                    layout.handlers[index(irq)] = Default;
+            ((layout.handlers[index(Bindings::Irq)] = Bindings::Handler_v), ...);
+            return layout;
+        }
+
+        /*!
+         * \brief Значения полей NVIC и SCB для привязанных прерываний
+         *
+         * Включает бит разрешения в ISER и приоритет в IPR для каждого прерывания
+         * периферии и приоритет в SHPR для системных исключений. ISER доступен только
+         * для записи, поэтому все прерывания регистра разрешаются одной записью.
+         * Регистры записываются в порядке первого упоминания, поэтому все приоритеты
+         * записываются до первого ISER: прерывание не разрешается с приоритетом 0.
+         * Если настраивать нечего (нет привязок или только NMI и HardFault),
+         * Set ничего не делает.
+         * \tparam Bus Политика доступа к памяти
+         */
+        template<Bus_policy Bus = core::Mmio_bus>
+        using Nvic_values = decltype(to_values(((meta_utils::TypeContainer<>() & ... & priority_of<Bus, Bindings>()) & ...
+                                                 & enable_of<Bus, Bindings>())));
+
+    private:
+        /// Количество системных исключений (без сброса)
+        static constexpr size_t exception_count = []
+        {
+            size_t count = 0;
+            for (int irq = NMI; irq < 0; ++irq)
+                count += is_exception(irq);
+            return count;
+        }();
+
+        /// Индекс вектора в handlers (без начального указателя стека)
+        static constexpr size_t index(int irq)
+        {
+            return static_cast<size_t>(irq + 15);
+        }
+
+        static consteval bool unique()
+        {
+            std::array<int, sizeof...(Bindings)> irqs = {Bindings::Irq...};
+            for (size_t i = 0; i < irqs.size(); ++i)
+                for (size_t j = i + 1; j < irqs.size(); ++j)
+                    if (irqs[i] == irqs[j])
+                        return false;
+            return true;
+        }
+    };
+}
+
+#endif // INTERRUPTS_HPP
@@ -1,139 +1,480 @@
 #ifndef PORT_HPP
 #define PORT_HPP
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 #include "register.hpp"
-#include "atomic.hpp"
+#include "metautils.hpp"
+
+/// \brief Значения поля режима вывода в MODER
+enum GpioMode : std::uint32_t
+{
+    GPIO_INPUT = 0b00,
+    GPIO_OUTPUT = 0b01,
+    GPIO_ALTERNATE = 0b10,
+    GPIO_ANALOG = 0b11
+};
 
+/*!
+ * \brief Операции над портом ввода-вывода целиком
+ *
+ * Описание порта T должно содержать регистры:
+ * - SCR - регистр установки/сброса (BSRR), младшие 16 бит устанавливают выводы, старшие сбрасывают;
+ * - ODT - выходные данные (ODR);
+ * - IDT - входные данные (IDR);
+ * - MODER - режим выводов, по 2 бита на вывод.
+ *
+ * Все методы принимают маску выводов, бит N соответствует выводу N.
+ */
 template <typename T>
 class Port
 {
-    using SCRType = typename T::SCR::Type;
+public:
+    using SCRType = typename T::SCR::Value_t;
 
-    enum Configuration : uint32_t
+    static constexpr std::uint8_t PinsCount = 16U;
+
+    /// \brief Устанавливает выводы по маске одной записью в SCR
+    [[gnu::always_inline]] inline static void Set(std::uint32_t mask)
     {
-        ANALOG_INPUT = 0b00,
-        FLOATING_INPUT = 0b01,
-        PULL_INPUT = 0b10,
-        PUSHPULL_OUTPUT = 0b00,
+        T::SCR::write(static_cast<SCRType>(mask));
+    }
 
-    };
+    /// \brief Сбрасывает выводы по маске одной записью в SCR
+    [[gnu::always_inline]] inline static void Reset(std::uint32_t mask)
+    {
+        T::SCR::write(static_cast<SCRType>(mask << PinsCount));
+    }
 
-    static constexpr std::uint8_t PinsCount = 16U;
-private:
-    __forceinline static void Set(std::uint32_t value)
+    /// \brief Устанавливает и сбрасывает выводы по маскам одной записью в SCR
+    [[gnu::always_inline]] inline static void SetReset(std::uint32_t set, std::uint32_t reset)
     {
-        T::SCR::Set(static_cast<SCRType>(value));
+        T::SCR::write(static_cast<SCRType>(set | (reset << PinsCount)));
     }
 
-    __forceinline static void Reset(std::uint32_t value)
+    /// \brief Инвертирует выводы по маске: одно чтение ODT и одна запись в SCR
+    [[gnu::always_inline]] inline static void Toggle(std::uint32_t mask)
     {
-        T::SCR::Set(static_cast<SCRType>(value) << PinsCount);
+        const std::uint32_t output = T::ODT::read();
+        SetReset(~output & mask, output & mask);
     }
 
-    __forceinline static void TogglePin(std::uint32_t pinNum)
+    [[gnu::always_inline]] inline static auto GetInput()
     {
-        T::SCR::Set(T::ODT::Get() ^ (1U << pinNum));
+        return T::IDT::read();
     }
 
-    __forceinline static auto GetInput()
+    [[gnu::always_inline]] inline static auto GetOutput()
     {
-        return T::IDT::Get();
+        return T::ODT::read();
     }
 
-    template<typename... Ps>
-    __forceinline static void SetAnalog(Ps... pins)
+    /// \brief Задает режим выводов по маске одним чтением-модификацией-записью MODER
+    template<GpioMode mode, std::uint32_t mask>
+    [[gnu::always_inline]] inline static void SetMode()
     {
-        using RegType = typename T::MODER::Type;
-        AtomicUtils<RegType>::Set(
-            T::MODER::Address,
-            T::MODER::FieldValues::Analog::Mask,
-            T::MODER::FieldValues::Analog::Value,
-            static_cast<ModerType>(pinNum * uint8_t{2U})
-            );
+        constexpr auto spread = Spread(mask);
+        auto value = T::MODER::read();
+        value &= ~(spread * 0b11);
+        value |= spread * mode;
+        T::MODER::write(value);
     }
 
-    __forceinline static void SetInput(std::uint32_t pinNum)
+private:
+    /// Переносит бит N маски в бит 2N
+    static consteval std::uint32_t Spread(std::uint32_t mask)
     {
-        AtomicUtils<ModerType>::Set(
-            T::MODER::Address,
-            0b11,
-            T::MODER::FieldValues::Input::Value,
-            static_cast<ModerType>(pinNum * uint8_t{2U})
-            );
-        volatile auto value = T::MODER::Get() ;
-        value &= ~(3 << (pinNum * 2U)) ;
-        value |= 	(T::MODER::FieldValues::Input::Value << (pinNum * 2U)) ;
-        T::MODER::Write(value);
+        std::uint32_t result = 0;
+        for (std::uint8_t i = 0; i < PinsCount; ++i)
+            if (mask & (1U << i))
+                result |= 1U << (i * 2U);
+        return result;
     }
+};
+
+/*!
+ * \brief Вывод порта ввода-вывода
+ * \tparam T Описание порта (см. Port)
+ * \tparam number Номер вывода
+ */
+template<typename T, std::uint8_t number>
+    requires (number < Port<T>::PinsCount)
+struct PortPin
+{
+    using PortType = T;
+    static constexpr std::uint8_t Number = number;
+    static constexpr std::uint32_t Mask = 1U << number;
 
-    __forceinline static void SetOutput(std::uint32_t pinNum)
+    [[gnu::always_inline]] inline static void Set()
     {
-        AtomicUtils<ModerType>::Set(
-            T::MODER::Address,
-            T::MODER::FieldValues::Output::Mask,
-            T::MODER::FieldValues::Output::Value,
-            static_cast<ModerType>(pinNum * uint8_t{2U})
-            );
+        Port<T>::Set(Mask);
     }
 
-    __forceinline static void SetAlternate(std::uint32_t pinNum)
+    [[gnu::always_inline]] inline static void Reset()
     {
-        AtomicUtils<ModerType>::Set(
-            T::MODER::Address,
-            T::MODER::FieldValues::Alternate::Mask,
-            T::MODER::FieldValues::Alternate::Value,
-            static_cast<ModerType>(pinNum * uint8_t{2U})
-            );
+        Port<T>::Reset(Mask);
     }
 
-} ;
+    [[gnu::always_inline]] inline static void Toggle()
+    {
+        Port<T>::Toggle(Mask);
+    }
 
+    [[gnu::always_inline]] inline static bool GetInput()
+    {
+        return Port<T>::GetInput() & Mask;
+    }
 
+    [[gnu::always_inline]] inline static void SetOutput()
+    {
+        Port<T>::template SetMode<GPIO_OUTPUT, Mask>();
+    }
 
+    [[gnu::always_inline]] inline static void SetInput()
+    {
+        Port<T>::template SetMode<GPIO_INPUT, Mask>();
+    }
+
+    [[gnu::always_inline]] inline static void SetAnalog()
+    {
+        Port<T>::template SetMode<GPIO_ANALOG, Mask>();
+    }
+
+    [[gnu::always_inline]] inline static void SetAlternate()
+    {
+        Port<T>::template SetMode<GPIO_ALTERNATE, Mask>();
+    }
+};
+
+/// \brief Проверка того, что вывод привязан к порту и может обрабатываться пакетно
+template<typename Pin>
+concept IsPortPin = requires
+{
+    typename Pin::PortType;
+    Pin::Number;
+};
+
+/*!
+ * \brief Группа выводов
+ *
+ * Если все выводы являются PortPin, они группируются по портам на этапе компиляции
+ * и каждая операция выполняется одной записью (Toggle и режимы - одним чтением и
+ * одной записью) на каждый порт. Иначе операция применяется к каждому выводу отдельно.
+ */
 template<typename ...T>
+    requires NoDuplicates<T...>
 struct Pins{
+    static constexpr bool Batched = (IsPortPin<T> && ...);
 
-    __forceinline inline static void Toggle()
+    /*!
+     * \brief Количество портов группы
+     *
+     * Set, Reset и Write выполняют по одной записи на порт, Toggle и установка
+     * режима - по одному чтению и одной записи.
+     */
+    static consteval size_t PortsCount()
+        requires Batched
     {
-        Pass((T::Toggle(), true)...) ;
+        return Count(Ports());
     }
 
-    __forceinline inline static void Set()
+    [[gnu::always_inline]] inline static void Toggle()
     {
-        Pass((T::Set(), true)...) ;
+        if constexpr (Batched)
+            ForEachPort([]<typename P>{ Port<P>::Toggle(PortMask<P>()); });
+        else
+            (T::Toggle(), ...);
     }
 
-    __forceinline inline static void Reset()
+    [[gnu::always_inline]] inline static void Set()
     {
-        Pass((T::Reset(), true)...) ;
+        if constexpr (Batched)
+            ForEachPort([]<typename P>{ Port<P>::Set(PortMask<P>()); });
+        else
+            (T::Set(), ...);
     }
 
-    __forceinline inline static void SetOutput()
+    [[gnu::always_inline]] inline static void Reset()
     {
-        Pass((T::SetOutput(), true)...) ;
+        if constexpr (Batched)
+            ForEachPort([]<typename P>{ Port<P>::Reset(PortMask<P>()); });
+        else
+            (T::Reset(), ...);
     }
 
-    __forceinline inline static void SetInput()
+    /*!
+     * \brief Устанавливает выводы в соответствии с константой, одна запись на порт
+     * \tparam value Бит I задает состояние I-го вывода в списке
+     */
+    template<std::uint32_t value>
+        requires Batched
+    [[gnu::always_inline]] inline static void Write()
     {
-        Pass((T::SetInput(), true)...) ;
+        ForEachPort([]<typename P>
+        {
+            constexpr auto set = PortValue<P>(value);
+            Port<P>::SetReset(set, PortMask<P>() & ~set);
+        });
     }
 
-    __forceinline inline static void SetAnalog()
+    /*!
+     * \brief Устанавливает выводы в соответствии со значением, одна запись на порт
+     * \param value Бит I задает состояние I-го вывода в списке
+     */
+    template<typename U = void>
+        requires Batched
+    [[gnu::always_inline]] inline static void Write(std::uint32_t value)
     {
-        Pass((T::SetInput(), true)...) ;
+        ForEachPort([value]<typename P>
+        {
+            const auto set = PortValue<P>(value);
+            Port<P>::SetReset(set, PortMask<P>() & ~set);
+        });
     }
 
-    __forceinline inline static void SetAlternate()
+    [[gnu::always_inline]] inline static void SetOutput()
     {
-        Pass((T::SetInput(), true)...) ;
+        SetMode<GPIO_OUTPUT>();
     }
 
-private:
-    __forceinline template<typename... Args>
-    static void inline Pass(Args... ) //Вспомогательный метод для распаковки вариативного шаблона
+    [[gnu::always_inline]] inline static void SetInput()
     {
+        SetMode<GPIO_INPUT>();
     }
 
+    [[gnu::always_inline]] inline static void SetAnalog()
+    {
+        SetMode<GPIO_ANALOG>();
+    }
+
+    [[gnu::always_inline]] inline static void SetAlternate()
+    {
+        SetMode<GPIO_ALTERNATE>();
+    }
+
+protected:
+    template<GpioMode mode>
+    [[gnu::always_inline]] inline static void SetMode()
+    {
+        if constexpr (Batched)
+            ForEachPort([]<typename P>{ Port<P>::template SetMode<mode, PortMask<P>()>(); });
+        else if constexpr (mode == GPIO_OUTPUT)
+            (T::SetOutput(), ...);
+        else if constexpr (mode == GPIO_INPUT)
+            (T::SetInput(), ...);
+        else if constexpr (mode == GPIO_ANALOG)
+            (T::SetAnalog(), ...);
+        else
+            (T::SetAlternate(), ...);
+    }
+
+    /// Маска выводов группы, относящихся к порту P
+    template<typename P>
+    static consteval std::uint32_t PortMask()
+    {
+        return ((std::is_same_v<typename T::PortType, P> ? 1U << T::Number : 0U) | ...);
+    }
+
+    /// Переносит биты значения, соответствующие выводам порта P, в позиции этих выводов
+    template<typename P>
+    [[gnu::always_inline]] inline static constexpr std::uint32_t PortValue(std::uint32_t value)
+    {
+        return [value]<size_t... I>(std::index_sequence<I...>)
+        {
+            using Tuple = std::tuple<T...>;
+            return ((std::is_same_v<typename std::tuple_element_t<I, Tuple>::PortType, P>
+                     ? ((value >> I) & 1U) << std::tuple_element_t<I, Tuple>::Number
+                     : 0U) | ...);
+        }(std::index_sequence_for<T...>());
+    }
+
+    template<typename F, typename... Ps>
+    [[gnu::always_inline]] inline static void ForEachPort(F f, meta_utils::TypeContainer<Ps...>)
+    {
+        (f.template operator()<Ps>(), ...);
+    }
+
+    template<typename F>
+    [[gnu::always_inline]] inline static void ForEachPort(F f)
+    {
+        ForEachPort(f, Ports());
+    }
+
+    /// Порты группы без повторов
+    static consteval auto Ports()
+    {
+        return (meta_utils::TypeContainer<>() + ... + meta_utils::TypeContainer<typename T::PortType>());
+    }
+
+    template<typename... Ps>
+    static consteval size_t Count(meta_utils::TypeContainer<Ps...>)
+    {
+        return sizeof...(Ps);
+    }
 } ;
 
+/// \brief Способ переноса разрядов слова шины в разряды порта
+enum class PinBusMapping
+{
+    Shift,  ///< Выводы порта идут подряд в порядке разрядов: один сдвиг и маска
+    Table,  ///< Узкий диапазон разрядов: слово BSRR выбирается из таблицы во флеш-памяти
+    Masks   ///< Сдвиг и маска на каждую группу разрядов с одинаковым смещением
+};
+
+/*!
+ * \brief Параллельная шина на произвольных выводах
+ *
+ * Разряд I слова шины соответствует I-му выводу в списке, выводы могут
+ * принадлежать разным портам и идти в любом порядке. Для каждого порта на этапе
+ * компиляции выбирается способ переноса разрядов (см. PinBusMapping), Write
+ * выполняет одну запись в BSRR на порт, Read - одно чтение IDR на порт.
+ * \code
+ * using Lcd = PinBus<PortPin<GPIOD, 14>, PortPin<GPIOD, 15>, PortPin<GPIOD, 0>, PortPin<GPIOD, 1>,
+ *                    PortPin<GPIOE, 7>, PortPin<GPIOE, 8>, PortPin<GPIOE, 9>, PortPin<GPIOE, 10>>;
+ * Lcd::SetOutput();
+ * Lcd::Write(0x5A);
+ * \endcode
+ * \tparam T Выводы (PortPin), не более 32
+ */
+template<typename... T>
+    requires (sizeof...(T) <= 32) && (IsPortPin<T> && ...)
+struct PinBus : Pins<T...>
+{
+    /// Наибольшая ширина диапазона разрядов, для которой строится таблица (1 КБ на порт)
+    static constexpr std::uint8_t TableWidth = 8;
+
+    /// \brief Способ переноса разрядов для порта P
+    template<typename P>
+    static consteval PinBusMapping Mapping()
+    {
+        if (Layouts<P>.groups == 1)
+            return PinBusMapping::Shift;
+        else if (Layouts<P>.groups > 2 && Layouts<P>.width <= TableWidth)
+            return PinBusMapping::Table;
+        else
+            return PinBusMapping::Masks;
+    }
+
+    /// \brief Выводит значение на шину, одна запись в BSRR на порт
+    [[gnu::always_inline]] inline static void Write(std::uint32_t value)
+    {
+        Pins<T...>::ForEachPort([value]<typename P>
+        {
+            if constexpr (Mapping<P>() == PinBusMapping::Table)
+                P::SCR::write(static_cast<typename Port<P>::SCRType>(Table<P>[(value >> Layouts<P>.low) & (Table<P>.size() - 1)]));
+            else
+            {
+                const auto set = Scatter<P>(value);
+                Port<P>::SetReset(set, Pins<T...>::template PortMask<P>() & ~set);
+            }
+        });
+    }
+
+    /// \brief Считывает значение шины, одно чтение IDR на порт
+    [[gnu::always_inline]] inline static std::uint32_t Read()
+    {
+        std::uint32_t value = 0;
+        Pins<T...>::ForEachPort([&value]<typename P>
+        {
+            const std::uint32_t input = Port<P>::GetInput();
+            [&]<size_t... G>(std::index_sequence<G...>)
+            {
+                ((value |= GatherGroup<P, G>(input)), ...);
+            }(std::make_index_sequence<Layouts<P>.groups>());
+        });
+        return value;
+    }
+
+private:
+    /// Разряды слова шины порта, сгруппированные по смещению (номер вывода - номер разряда)
+    struct PortLayout
+    {
+        size_t groups = 0;
+        std::array<int, 16> shifts{};
+        std::array<std::uint32_t, 16> masks{};
+        std::uint8_t low = 32;
+        std::uint8_t width = 0;
+    };
+
+    template<typename P>
+    static consteval PortLayout Layout()
+    {
+        PortLayout layout;
+        constexpr std::array<bool, sizeof...(T)> onPort = {std::is_same_v<typename T::PortType, P>...};
+        constexpr std::array<int, sizeof...(T)> numbers = {T::Number...};
+        std::uint8_t high = 0;
+        for (std::uint8_t bit = 0; bit < sizeof...(T); ++bit)
+        {
+            if (!onPort[bit])
+                continue;
+            const int shift = numbers[bit] - bit;
+            size_t g = 0;
+            while (g < layout.groups && layout.shifts[g] != shift)
+                ++g;
+            if (g == layout.groups)
+                layout.shifts[layout.groups++] = shift;
+            layout.masks[g] |= 1U << bit;
+            layout.low = bit < layout.low ? bit : layout.low;
+            high = bit;
+        }
+        layout.width = static_cast<std::uint8_t>(high + 1 - layout.low);
+        return layout;
+    }
+
+    template<typename P>
+    static constexpr PortLayout Layouts = Layout<P>();
+
+    /// Разряды группы G слова шины в позициях выводов порта P
+    template<typename P, size_t G>
+    [[gnu::always_inline]] inline static constexpr std::uint32_t ScatterGroup(std::uint32_t value)
+    {
+        constexpr auto shift = Layouts<P>.shifts[G];
+        constexpr auto mask = Layouts<P>.masks[G];
+        if constexpr (shift >= 0)
+            return (value & mask) << shift;
+        else
+            return (value & mask) >> -shift;
+    }
+
+    /// Разряды группы G слова шины из значения IDR порта P
+    template<typename P, size_t G>
+    [[gnu::always_inline]] inline static constexpr std::uint32_t GatherGroup(std::uint32_t input)
+    {
+        constexpr auto shift = Layouts<P>.shifts[G];
+        constexpr auto mask = Layouts<P>.masks[G];
+        if constexpr (shift >= 0)
+            return (input & (mask << shift)) >> shift;
+        else
+            return (input & (mask >> -shift)) << -shift;
+    }
+
+    /// Маска установки выводов порта P для значения шины
+    template<typename P>
+    [[gnu::always_inline]] inline static constexpr std::uint32_t Scatter(std::uint32_t value)
+    {
+        return [value]<size_t... G>(std::index_sequence<G...>)
+        {
+            return (ScatterGroup<P, G>(value) | ...);
+        }(std::make_index_sequence<Layouts<P>.groups>());
+    }
+
+    /// Слова BSRR порта P для всех значений разрядов low ... low + width - 1
+    template<typename P>
+    static constexpr auto Table = []
+    {
+        std::array<std::uint32_t, (1U << Layouts<P>.width)> table{};
+        for (std::uint32_t i = 0; i < table.size(); ++i)
+        {
+            const auto set = Scatter<P>(i << Layouts<P>.low);
+            table[i] = set | ((Pins<T...>::template PortMask<P>() & ~set) << Port<P>::PinsCount);
+        }
+        return table;
+    }();
+};
+
 #endif // PORT_HPP
@@ -1,12 +1,15 @@
 #ifndef REGISTER_HPP
 #define REGISTER_HPP
 
+#include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <initializer_list>
 #include <limits>
 
+#include "bus.hpp"
+
 /*!
  * \file
  * \brief Файл с классами для работы с регистрами
@@ -32,7 +35,7 @@ namespace metaMCU {
     concept Can_write = std::derived_from<T, Write_only_t>;
     /// \brief Проверка значений полей на принадлежность данному регистру
     template<typename Register, typename... Values>
-    concept Register_compatible_values = (std::is_base_of<Register, Values>() && ...);
+    concept Register_compatible_values = (std::is_base_of_v<Register, Values> && ...);
     /// \brief Проверить возможность записи в данное поле регистра
     template<typename Value>
     concept Can_write_value = requires
@@ -42,6 +45,26 @@ namespace metaMCU {
     /// \brief Проверить возможность записи в данные поля регистра
     template<typename... Values>
     concept Can_write_values = (Can_write_value<Values> && ...);
+    /*!
+     * \brief Маска бит регистра по данному адресу, изменяемых аппаратно
+     * (флаги состояния, счетчики, биты сбрасываемые при чтении и т.п.)
+     *
+     * По умолчанию считается, что аппаратно изменяемых бит нет.
+     * Специализируется генератором регистров или вручную.
+     */
+    template<size_t Address>
+    struct Hardware_modified_bits : std::integral_constant<size_t, 0> {};
+
+    /*!
+     * \brief Вызов этой функции в коде означает, что константа не помещается в битовое поле
+     *
+     * Функция не определена: GCC выдает ошибку компиляции, если вызов не был удален
+     * оптимизатором (проверка выполняется только при включенной оптимизации).
+     */
+#if defined(__GNUC__) && !defined(__clang__)
+    [[gnu::error("value does not fit into the bit field")]]
+#endif
+    void field_value_out_of_range();
 
     namespace core {
 
@@ -49,19 +72,25 @@ namespace metaMCU {
          * \brief Обеспечивает безопасный доступ к регистрам
          * микроконтроллера
          * \warning Данный шаблонный класс разработан для работы вместе
-         * со скриптом RegistersGenerator, подставляющим в шаблонные
+         * со скриптом RegistersGenerator (tools/registersgenerator.py), подставляющим в шаблонные
          * параметры информацию из svd файла и автоматически
          * генерирующим соответствующие заголовочные файлы. Инстанцирование этого
          * класса "вручную" должно производится только при крайней необходимости.
          * \tparam addr Адрес регистра
          * \tparam Value Тип из stdint.h соотвествествующий разряду регистра
          * \tparam Access Тип доступа к регистру
+         * \tparam Bus Политика доступа к памяти, по умолчанию прямой доступ Mmio_bus
          */
-        template<size_t Address, typename Value, typename Access>
+        template<size_t Address, typename Value, typename Access, Bus_policy Bus = Mmio_bus>
         class Register
         {
         public:
             using Value_t = Value;
+            using Access_t = Access;
+            using Bus_t = Bus;
+
+            /// \brief Количество обращений к шине при чтении значения регистра
+            static constexpr size_t read_accesses = 1;
 
             /// \brief Адрес регистра
             static consteval auto address()
@@ -74,7 +103,7 @@ namespace metaMCU {
                 requires Can_write<Access>
             [[gnu::always_inline]] inline static void write(Value_t value)
             {
-                *reinterpret_cast<volatile Value_t*>(Address) = value;
+                Bus::template write<Value_t>(Address, value);
             }
 
             /// \brief Возвращает значение регистра, если регистр позволяет чтение
@@ -82,7 +111,7 @@ namespace metaMCU {
                 requires Can_read<Access>
             [[gnu::always_inline]] inline static Value_t read()
             {
-                return *reinterpret_cast<volatile Value_t*>(Address);
+                return Bus::template read<Value_t>(Address);
             }
 
             /// \brief Инвертирует значения бит по маске, если регистр позволяет и чтение, и запись
@@ -95,6 +124,50 @@ namespace metaMCU {
                 write(new_value);
             }
 
+            /*!
+             * \brief Атомарно заменяет значение регистра на modify(значение), если политика доступа
+             * поддерживает эксклюзивный доступ
+             * \return Значение регистра до изменения
+             */
+            template<typename F>
+                requires Can_write<Access> && Can_read<Access> && Exclusive_bus<Bus>
+            [[gnu::always_inline]] inline static Value_t modify_atomic(F modify)
+            {
+                size_t retries = 0;
+                const auto old_value = Bus::template modify_exclusive<Value_t>(Address, modify, retries);
+                if (retries)
+                    exclusive_retries.fetch_add(retries, std::memory_order_relaxed);
+                return old_value;
+            }
+
+            /// \brief Атомарно сбрасывает биты по маске clear и устанавливает биты по маске set
+            template<typename T = void>
+                requires Can_write<Access> && Can_read<Access> && Exclusive_bus<Bus>
+            [[gnu::always_inline]] inline static void bits_set_clear_atomic(Value_t clear, Value_t set)
+            {
+                modify_atomic([clear, set](Value_t value) { return static_cast<Value_t>((value & ~clear) | set); });
+            }
+
+            /// \brief Атомарно инвертирует значения бит по маске
+            template<typename T = void>
+                requires Can_write<Access> && Can_read<Access> && Exclusive_bus<Bus>
+            [[gnu::always_inline]] inline static void bits_toggle_atomic(Value_t mask = std::numeric_limits<Value_t>::max())
+            {
+                modify_atomic([mask](Value_t value) { return static_cast<Value_t>(value ^ mask); });
+            }
+
+            /// \brief Количество повторов атомарных операций над регистром из-за конкурентного доступа
+            static size_t atomic_retries()
+            {
+                return exclusive_retries.load(std::memory_order_relaxed);
+            }
+
+            /// \brief Обнуляет счетчик повторов атомарных операций
+            static void reset_atomic_retries()
+            {
+                exclusive_retries.store(0, std::memory_order_relaxed);
+            }
+
             /*!
              * \brief Записывает значения данных битовых полей в регистр сохраняя значения других полей.
              * Регистр должен быть доступен для чтения и записи
@@ -106,7 +179,7 @@ namespace metaMCU {
              * \tparam Values Значения полей для записи
              */
             template<typename... Values>
-                requires Register_compatible_values<Register<Address, Value, Access>, Values...>
+                requires Can_write<Access> && Can_read<Access> && Register_compatible_values<Register<Address, Value, Access, Bus>, Values...>
             [[gnu::always_inline]] inline static void values_set()
             {
                 auto new_value = read();
@@ -115,6 +188,20 @@ namespace metaMCU {
                 write(new_value);
             }
 
+            /*!
+             * \brief Атомарно записывает значения данных битовых полей в регистр сохраняя значения других полей
+             *
+             * В отличие от values_set не требует запрета прерываний: при изменении регистра
+             * между чтением и записью операция повторяется.
+             * \tparam Values Значения полей для записи
+             */
+            template<typename... Values>
+                requires Register_compatible_values<Register<Address, Value, Access, Bus>, Values...>
+            [[gnu::always_inline]] inline static void values_set_atomic()
+            {
+                bits_set_clear_atomic(calculateMask<Values...>(), accumulateValues<Values...>());
+            }
+
             /*!
              * \brief Устанавливает значения данных битовых полей в регистр, сбрасывает остальные биты.
              * Регистр должен быть доступен для записи
@@ -125,12 +212,56 @@ namespace metaMCU {
              * \tparam Values Значения полей для записи
              */
             template<typename... Values>
-                requires Register_compatible_values<Register<Address, Value, Access>, Values...>
+                requires Register_compatible_values<Register<Address, Value, Access, Bus>, Values...>
             [[gnu::always_inline]] inline static void values_write()
             {
                 write(accumulateValues<Values...>());
             }
 
+            /*!
+             * \brief Записывает значения битовых полей, известные во время выполнения,
+             * сохраняя значения других полей. Регистр должен быть доступен для чтения и записи
+             *
+             * Маски и сдвиги полей вычисляются на этапе компиляции, значения всех полей
+             * записываются одним чтением-модификацией-записью, а если поля покрывают
+             * весь регистр - одной записью без чтения. Лишние старшие разряды значений отбрасываются.
+             * Константы, не помещающиеся в поле, отвергаются на этапе компиляции только в GCC
+             * с оптимизацией: проверка опирается на __builtin_constant_p после встраивания.
+             * Без оптимизации (-O0) и в Clang fields_write<F>(0x1F) для 4-битного поля
+             * компилируется и молча записывает 0xF.
+             * \code
+             * TIM1_CCMR1::fields_set<TIM1_CCMR1::OC1M, TIM1_CCMR1::OC1PE>(mode, preload);
+             * \endcode
+             * \tparam Fields Поля регистра
+             * \param values Значения полей без смещения в порядке Fields
+             */
+            template<typename... Fields>
+                requires Can_write<Access> && Can_read<Access> && Register_compatible_values<Register<Address, Value, Access, Bus>, Fields...>
+            [[gnu::always_inline]] inline static void fields_set(typename Fields::Value_t... values)
+            {
+                constexpr auto fields_mask = calculateMask<Fields...>();
+                if constexpr (fields_mask == std::numeric_limits<Value_t>::max())
+                    write(packFields<Fields...>(values...));
+                else
+                    write(static_cast<Value_t>((read() & ~fields_mask) | packFields<Fields...>(values...)));
+            }
+
+            /// \brief Атомарно записывает значения битовых полей, известные во время выполнения
+            template<typename... Fields>
+                requires Register_compatible_values<Register<Address, Value, Access, Bus>, Fields...>
+            [[gnu::always_inline]] inline static void fields_set_atomic(typename Fields::Value_t... values)
+            {
+                bits_set_clear_atomic(calculateMask<Fields...>(), packFields<Fields...>(values...));
+            }
+
+            /// \brief Записывает значения битовых полей, известные во время выполнения, сбрасывает остальные биты
+            template<typename... Fields>
+                requires Can_write<Access> && Register_compatible_values<Register<Address, Value, Access, Bus>, Fields...>
+            [[gnu::always_inline]] inline static void fields_write(typename Fields::Value_t... values)
+            {
+                write(packFields<Fields...>(values...));
+            }
+
             /*!
              * \brief Проверяет заданны или нет значения перечисленных полей регистра,
              * если регистр позволяет чтение
@@ -143,7 +274,7 @@ namespace metaMCU {
              * \tparam Values Значения полей для записи
              */
             template<typename... Values>
-                requires Register_compatible_values<Register<Address, Value, Access>, Values...>
+                requires Register_compatible_values<Register<Address, Value, Access, Bus>, Values...>
             [[gnu::always_inline]] inline static bool values_is_set()
             {
                 auto register_value = read();
@@ -153,6 +284,20 @@ namespace metaMCU {
             }
 
         protected:
+            /// Маска отдельного битового поля
+            template<typename V>
+            static consteval Value_t getIndividualMask()
+            {
+                return V::mask();
+            }
+
+            /// Значение отдельного битового поля со смещением
+            template<typename V>
+            static consteval Value_t getIndividualValue()
+            {
+                return static_cast<Value_t>(V::value() << V::bit_offset());
+            }
+
             /// Расчитывает общую маску для всего набора битовых полей на этапе компиляции.
             template<typename... Values>
             static consteval auto calculateMask()
@@ -166,6 +311,24 @@ namespace metaMCU {
                 return result;
             }
 
+            /// Значение поля со смещением, известное во время выполнения, лишние разряды отбрасываются
+            /// (проверка диапазона констант только в GCC с оптимизацией, см. fields_set)
+            template<typename F>
+            [[gnu::always_inline]] inline static Value_t packField(Value_t value)
+            {
+                constexpr auto limit = static_cast<Value_t>(F::mask() >> F::bit_offset());
+                if (__builtin_constant_p(value) && value > limit)
+                    field_value_out_of_range();
+                return static_cast<Value_t>(value << F::bit_offset()) & F::mask();
+            }
+
+            /// Объединяет значения набора битовых полей, известные во время выполнения
+            template<typename... Fields>
+            [[gnu::always_inline]] inline static Value_t packFields(typename Fields::Value_t... values)
+            {
+                return static_cast<Value_t>((Value_t{} | ... | packField<Fields>(values)));
+            }
+
             /// Расчитывает значение которое нужно установить в регистре для всего набора битовых полей
             template<typename... Values>
             static consteval auto accumulateValues()
@@ -178,6 +341,9 @@ namespace metaMCU {
                 }
                 return result;
             }
+
+        private:
+            static inline std::atomic<size_t> exclusive_retries = 0;
         };
     }
 }
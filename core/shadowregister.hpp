@@ -0,0 +1,200 @@
+#ifndef SHADOWREGISTER_HPP
+#define SHADOWREGISTER_HPP
+
+#include <atomic>
+#include <limits>
+
+#include "register.hpp"
+
+/*!
+ * \file
+ * \brief Файл с регистром, кэширующим свое значение в ОЗУ
+ *
+ * Shadow_register хранит копию значения регистра в ОЗУ. Установка полей,
+ * инверсия бит и проверка значений выполняются над копией, в регистр
+ * выполняется только одна запись, без чтения по шине.
+ */
+
+namespace metaMCU {
+
+    /// \brief Проверка возможности кэширования регистра: запись разрешена и нет аппаратно изменяемых бит
+    template<size_t Address, typename Access>
+    concept Can_shadow = Can_write<Access> && (Hardware_modified_bits<Address>::value == 0);
+
+    namespace core {
+
+        /*!
+         * \brief Регистр с теневой копией значения в ОЗУ
+         *
+         * Подходит для регистров, которые изменяет только программа (например,
+         * MODER и AFR портов GPIO). Регистры с аппаратно изменяемыми битами
+         * (см. Hardware_modified_bits) отвергаются на этапе компиляции.
+         * Позволяет выполнять values_set и для регистров только для записи.
+         *
+         * Значение после сброса задается обязательно: первая установка полей
+         * изменяет копию и записывает ее в регистр целиком, поэтому неверное начальное
+         * значение затирает остальные поля (например, режим AF выводов SWD в GPIOA MODER,
+         * сбрасываемом в 0xA8000000). Если регистр мог быть изменен до первого
+         * использования (загрузчиком), копию следует загрузить вызовом sync().
+         *
+         * Атомарные операции (values_set_atomic, bits_set_clear_atomic и др.) выполняются
+         * над регистром циклом эксклюзивного доступа, после чего копия загружается
+         * из регистра. Если копию за это время обновил другой контекст, загрузка повторяется.
+         * \warning Неатомарные операции над копией не защищены от одновременного изменения из прерываний.
+         * \tparam Address Адрес регистра
+         * \tparam Value Тип из stdint.h соотвествествующий разряду регистра
+         * \tparam Access Тип доступа к регистру
+         * \tparam Reset Значение регистра после сброса, начальное значение копии
+         * \tparam Bus Политика доступа к памяти
+         */
+        template<size_t Address, typename Value, typename Access, Value Reset, Bus_policy Bus = Mmio_bus>
+            requires Can_shadow<Address, Access>
+        class Shadow_register : public Register<Address, Value, Access, Bus>
+        {
+            using Base = Register<Address, Value, Access, Bus>;
+
+        public:
+            using Value_t = Value;
+
+            /// \brief Значение читается из копии, обращений к шине нет
+            static constexpr size_t read_accesses = 0;
+
+            /// \brief Записывает значение в регистр и в копию
+            [[gnu::always_inline]] inline static void write(Value_t value)
+            {
+                shadow = value;
+                Base::write(value);
+            }
+
+            /// \brief Возвращает значение копии, обращения к шине нет
+            [[gnu::always_inline]] inline static Value_t read()
+            {
+                return shadow;
+            }
+
+            /// \brief Считывает значение регистра в копию, если регистр позволяет чтение
+            template<typename T = void>
+                requires Can_read<Access>
+            [[gnu::always_inline]] inline static void sync()
+            {
+                shadow = Base::read();
+            }
+
+            /// \brief Записывает значение копии в регистр
+            [[gnu::always_inline]] inline static void flush()
+            {
+                Base::write(shadow);
+            }
+
+            /// \brief Инвертирует значения бит по маске
+            [[gnu::always_inline]] inline static void bits_toggle(Value_t mask = std::numeric_limits<Value_t>::max())
+            {
+                write(shadow ^ mask);
+            }
+
+            /// \brief Записывает значения битовых полей, сохраняя значения других полей копии
+            template<typename... Values>
+                requires Register_compatible_values<Shadow_register, Values...>
+            [[gnu::always_inline]] inline static void values_set()
+            {
+                constexpr auto values_mask = Base::template calculateMask<Values...>();
+                constexpr auto values_sum = Base::template accumulateValues<Values...>();
+                write((shadow & ~values_mask) | values_sum);
+            }
+
+            /// \brief Устанавливает значения битовых полей, сбрасывает остальные биты
+            template<typename... Values>
+                requires Register_compatible_values<Shadow_register, Values...>
+            [[gnu::always_inline]] inline static void values_write()
+            {
+                write(Base::template accumulateValues<Values...>());
+            }
+
+            /// \brief Записывает значения битовых полей, известные во время выполнения, сохраняя другие поля копии
+            template<typename... Fields>
+                requires Register_compatible_values<Shadow_register, Fields...>
+            [[gnu::always_inline]] inline static void fields_set(typename Fields::Value_t... values)
+            {
+                constexpr auto fields_mask = Base::template calculateMask<Fields...>();
+                write(static_cast<Value_t>((shadow & ~fields_mask) | Base::template packFields<Fields...>(values...)));
+            }
+
+            /// \brief Записывает значения битовых полей, известные во время выполнения, сбрасывает остальные биты
+            template<typename... Fields>
+                requires Register_compatible_values<Shadow_register, Fields...>
+            [[gnu::always_inline]] inline static void fields_write(typename Fields::Value_t... values)
+            {
+                write(Base::template packFields<Fields...>(values...));
+            }
+
+            /*!
+             * \brief Атомарно заменяет значение регистра на modify(значение) и обновляет копию
+             * \return Значение регистра до изменения
+             */
+            template<typename F>
+                requires Can_write<Access> && Can_read<Access> && Exclusive_bus<Bus>
+            [[gnu::always_inline]] inline static Value_t modify_atomic(F modify)
+            {
+                const auto old_value = Base::modify_atomic(modify);
+                refresh();
+                return old_value;
+            }
+
+            /// \brief Атомарно сбрасывает биты по маске clear, устанавливает биты по маске set и обновляет копию
+            template<typename T = void>
+                requires Can_write<Access> && Can_read<Access> && Exclusive_bus<Bus>
+            [[gnu::always_inline]] inline static void bits_set_clear_atomic(Value_t clear, Value_t set)
+            {
+                modify_atomic([clear, set](Value_t value) { return static_cast<Value_t>((value & ~clear) | set); });
+            }
+
+            /// \brief Атомарно инвертирует значения бит по маске и обновляет копию
+            template<typename T = void>
+                requires Can_write<Access> && Can_read<Access> && Exclusive_bus<Bus>
+            [[gnu::always_inline]] inline static void bits_toggle_atomic(Value_t mask = std::numeric_limits<Value_t>::max())
+            {
+                modify_atomic([mask](Value_t value) { return static_cast<Value_t>(value ^ mask); });
+            }
+
+            /// \brief Атомарно записывает значения битовых полей и обновляет копию
+            template<typename... Values>
+                requires Register_compatible_values<Shadow_register, Values...>
+            [[gnu::always_inline]] inline static void values_set_atomic()
+            {
+                bits_set_clear_atomic(Base::template calculateMask<Values...>(), Base::template accumulateValues<Values...>());
+            }
+
+            /// \brief Атомарно записывает значения битовых полей, известные во время выполнения, и обновляет копию
+            template<typename... Fields>
+                requires Register_compatible_values<Shadow_register, Fields...>
+            [[gnu::always_inline]] inline static void fields_set_atomic(typename Fields::Value_t... values)
+            {
+                bits_set_clear_atomic(Base::template calculateMask<Fields...>(), Base::template packFields<Fields...>(values...));
+            }
+
+            /// \brief Проверяет значения битовых полей по копии
+            template<typename... Values>
+                requires Register_compatible_values<Shadow_register, Values...>
+            [[gnu::always_inline]] inline static bool values_is_set()
+            {
+                constexpr auto values_mask = Base::template calculateMask<Values...>();
+                constexpr auto values_sum = Base::template accumulateValues<Values...>();
+                return ((shadow & values_mask) == values_sum);
+            }
+
+        private:
+            /// Загружает в копию значение регистра после атомарной операции
+            static void refresh()
+            {
+                std::atomic_ref copy(shadow);
+                auto expected = copy.load(std::memory_order_relaxed);
+                while (!copy.compare_exchange_weak(expected, Base::read()))
+                    ;
+            }
+
+            alignas(std::atomic_ref<Value_t>::required_alignment) static inline Value_t shadow = Reset;
+        };
+    }
+}
+
+#endif // SHADOWREGISTER_HPP
@@ -0,0 +1,241 @@
+#ifndef SIMULATEDBUS_HPP
+#define SIMULATEDBUS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "bitband.hpp"
+#include "bus.hpp"
+
+/*!
+ * \file
+ * \brief Файл с моделью шины для сборки на хосте
+ *
+ * Simulated_bus подставляется в Register вместо Mmio_bus и хранит
+ * значения регистров в разреженном адресном пространстве в ОЗУ.
+ * Каждое чтение и запись подсчитываются, что позволяет проверять
+ * количество обращений к шине в модульных тестах на Linux.
+ * Обращения к областям псевдонимов bit-band Cortex-M3 изменяют
+ * соответствующий бит слова, как на реальном процессоре.
+ * Модели периферии подключаются через обработчики записи в ячейки.
+ */
+
+namespace metaMCU::core {
+
+    /*!
+     * \brief Политика доступа к смоделированному адресному пространству
+     *
+     * Ячейки создаются при первом обращении и инициализируются нулем.
+     * Счетчики обращений атомарны, поэтому шину можно использовать
+     * из нескольких потоков.
+     */
+    class Simulated_bus
+    {
+    public:
+        /// \brief Считывает значение по адресу и увеличивает счетчик чтений
+        template<typename Value_t>
+        static Value_t read(size_t address)
+        {
+            auto& c = cell(address);
+            c.reads.fetch_add(1, std::memory_order_relaxed);
+            total_reads.fetch_add(1, std::memory_order_relaxed);
+
+            size_t word, bit;
+            if (CortexM3::bit_band_target(address, word, bit))
+                return static_cast<Value_t>((std::atomic_ref(cell(word).value).load() >> bit) & 1U);
+            return static_cast<Value_t>(std::atomic_ref(c.value).load());
+        }
+
+        /// \brief Записывает значение по адресу и увеличивает счетчик записей
+        template<typename Value_t>
+        static void write(size_t address, Value_t value)
+        {
+            auto& c = cell(address);
+            c.writes.fetch_add(1, std::memory_order_relaxed);
+            total_writes.fetch_add(1, std::memory_order_relaxed);
+
+            size_t word, bit;
+            if (CortexM3::bit_band_target(address, word, bit))
+            {
+                auto& target = cell(word);
+                std::atomic_ref target_value(target.value);
+                const auto new_value = value & 1U ? target_value.fetch_or(1U << bit) | (1U << bit)
+                                                  : target_value.fetch_and(~(1U << bit)) & ~(1U << bit);
+                if (target.on_write)
+                    target.on_write(new_value);
+                return;
+            }
+            std::atomic_ref(c.value).store(static_cast<std::uint32_t>(value));
+            if (c.on_write)
+                c.on_write(static_cast<std::uint32_t>(value));
+        }
+
+        /*!
+         * \brief Атомарно заменяет значение по адресу на modify(значение)
+         *
+         * Модель цикла LDREX/STREX на std::atomic_ref: каждая попытка учитывается
+         * как чтение, успешная - как запись. Ложные неудачи сравнения с обменом
+         * считаются повторами, как и сброс монитора на реальном процессоре.
+         * \param retries Увеличивается на количество неудачных попыток записи
+         * \return Значение до изменения
+         */
+        template<typename Value_t, typename F>
+        static Value_t modify_exclusive(size_t address, F modify, size_t& retries)
+        {
+            auto& c = cell(address);
+            std::atomic_ref value(c.value);
+            auto expected = value.load();
+            while (true)
+            {
+                c.reads.fetch_add(1, std::memory_order_relaxed);
+                total_reads.fetch_add(1, std::memory_order_relaxed);
+                const auto old_value = static_cast<Value_t>(expected);
+                const auto new_value = static_cast<std::uint32_t>(static_cast<Value_t>(modify(old_value)));
+                if (value.compare_exchange_weak(expected, new_value))
+                {
+                    c.writes.fetch_add(1, std::memory_order_relaxed);
+                    total_writes.fetch_add(1, std::memory_order_relaxed);
+                    if (c.on_write)
+                        c.on_write(new_value);
+                    return old_value;
+                }
+                ++retries;
+            }
+        }
+
+        /// \brief Возвращает значение по адресу без учета в счетчиках
+        static std::uint32_t peek(size_t address)
+        {
+            return std::atomic_ref(cell(address).value).load();
+        }
+
+        /// \brief Записывает значение по адресу без учета в счетчиках (изменение со стороны "аппаратуры")
+        static void poke(size_t address, std::uint32_t value)
+        {
+            std::atomic_ref(cell(address).value).store(value);
+        }
+
+        /*!
+         * \brief Задает обработчик записи по адресу
+         *
+         * Обработчик вызывается после сохранения значения при каждой записи через
+         * write и modify_exclusive (но не poke) и моделирует реакцию периферии,
+         * например сброс флагов записью в регистр очистки. Запись в псевдоним
+         * bit-band вызывает обработчик слова с новым значением слова.
+         * Пустой обработчик удаляет ранее заданный.
+         */
+        static void on_write(size_t address, std::function<void(std::uint32_t)> hook)
+        {
+            cell(address).on_write = std::move(hook);
+        }
+
+        /*!
+         * \brief 32-битный адрес буфера хоста для регистров адреса памяти (например, DMA)
+         *
+         * Указатели хоста не помещаются в 32-битные регистры, поэтому каждому буферу
+         * выделяется окно 16 МБ в верхней половине адресного пространства.
+         * Смещения внутри окна соответствуют смещениям от начала буфера.
+         */
+        static std::uint32_t map_memory(const void* pointer)
+        {
+            std::lock_guard lock(mutex);
+            const auto base = static_cast<const std::byte*>(pointer);
+            size_t window = 0;
+            while (window < windows.size() && windows[window] != base)
+                ++window;
+            if (window == windows.size())
+                windows.push_back(base);
+            return static_cast<std::uint32_t>(memory_window_base + (window << memory_window_bits));
+        }
+
+        /// \brief Указатель хоста по адресу, полученному от map_memory
+        static std::byte* memory_pointer(std::uint32_t address)
+        {
+            std::lock_guard lock(mutex);
+            const auto window = (address - memory_window_base) >> memory_window_bits;
+            return const_cast<std::byte*>(windows.at(window)) + (address & ((1U << memory_window_bits) - 1));
+        }
+
+        /// \brief Общее количество чтений
+        static size_t reads()
+        {
+            return total_reads.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Общее количество записей
+        static size_t writes()
+        {
+            return total_writes.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Количество чтений по данному адресу
+        static size_t reads(size_t address)
+        {
+            return cell(address).reads.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Количество записей по данному адресу
+        static size_t writes(size_t address)
+        {
+            return cell(address).writes.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Обнуляет счетчики, сохраняя значения ячеек
+        static void reset_counters()
+        {
+            std::lock_guard lock(mutex);
+            for (auto& [address, c] : memory)
+            {
+                c.reads.store(0, std::memory_order_relaxed);
+                c.writes.store(0, std::memory_order_relaxed);
+            }
+            total_reads.store(0, std::memory_order_relaxed);
+            total_writes.store(0, std::memory_order_relaxed);
+        }
+
+        /// \brief Удаляет все ячейки, обработчики записи и окна памяти, обнуляет счетчики
+        static void clear()
+        {
+            std::lock_guard lock(mutex);
+            memory.clear();
+            windows.clear();
+            total_reads.store(0, std::memory_order_relaxed);
+            total_writes.store(0, std::memory_order_relaxed);
+        }
+
+    protected:
+        struct Cell
+        {
+            alignas(std::atomic_ref<std::uint32_t>::required_alignment) std::uint32_t value = 0;
+            std::atomic<size_t> reads = 0;
+            std::atomic<size_t> writes = 0;
+            std::function<void(std::uint32_t)> on_write;
+        };
+
+        /// Находит ячейку по адресу, создавая её при необходимости. Адрес ячейки стабилен.
+        static Cell& cell(size_t address)
+        {
+            std::lock_guard lock(mutex);
+            return memory[address];
+        }
+
+    private:
+        static constexpr std::uint32_t memory_window_base = 0x80000000;
+        static constexpr unsigned memory_window_bits = 24;
+
+        static inline std::map<size_t, Cell> memory;
+        static inline std::vector<const std::byte*> windows;
+        static inline std::mutex mutex;
+        static inline std::atomic<size_t> total_reads = 0;
+        static inline std::atomic<size_t> total_writes = 0;
+    };
+
+    static_assert(Bus_policy<Simulated_bus> && Exclusive_bus<Simulated_bus>);
+}
+
+#endif // SIMULATEDBUS_HPP
@@ -0,0 +1,138 @@
+#ifndef SIMULATEDDMA_HPP
+#define SIMULATEDDMA_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "dma.hpp"
+#include "simulatedbus.hpp"
+
+/*!
+ * \file
+ * \brief Файл с моделью контроллера DMA для сборки на хосте
+ *
+ * Модель работает поверх Simulated_bus: читает конфигурацию потоков из ячеек
+ * регистров, передает данные между буферами хоста (см. Simulated_bus::map_memory)
+ * и моделью периферии, выставляет флаги половины и окончания передачи,
+ * перезапускает передачу в режимах circular и double_buffer.
+ */
+
+namespace metaMCU::dma {
+
+    /*!
+     * \brief Модель контроллера DMA
+     * \tparam Controller Контроллер (Controller с политикой Simulated_bus)
+     */
+    template<typename Controller>
+    class Simulated_dma
+    {
+    public:
+        /*!
+         * \brief Подключает модель к шине
+         *
+         * Задает обработчики записи в IFCR (сброс флагов в ISR) и в NDTR
+         * (запоминание длины передачи для перезапуска). Вызывается заново
+         * после Simulated_bus::clear.
+         */
+        static void attach()
+        {
+            for (const size_t bank : {0, 1})
+            {
+                const auto isr = Controller::base + 0x04 * bank;
+                core::Simulated_bus::on_write(Controller::base + 0x08 + 0x04 * bank, [isr](std::uint32_t value)
+                {
+                    core::Simulated_bus::poke(isr, core::Simulated_bus::peek(isr) & ~value);
+                });
+            }
+            for (size_t stream = 0; stream < 8; ++stream)
+                core::Simulated_bus::on_write(Controller::base + 0x14 + 0x18 * stream, [stream](std::uint32_t value)
+                {
+                    lengths[stream] = value;
+                });
+        }
+
+        /*!
+         * \brief Выполняет до items передач потока Stream
+         *
+         * Модель периферии exchange вызывается для каждого элемента: при передаче
+         * в периферию получает переданный элемент, при приеме возвращает принятый.
+         * \param exchange Функция std::uint32_t(std::uint32_t)
+         * \return Количество выполненных передач (меньше items, если поток отключился)
+         */
+        template<typename Stream, typename F>
+        static size_t run(size_t items, F exchange)
+        {
+            using Bus = core::Simulated_bus;
+            const auto total = lengths[Stream::number];
+            size_t done = 0;
+
+            for (; done < items; ++done)
+            {
+                const auto cr = Bus::peek(Stream::CR::address());
+                if (!(cr & enable_bit) || total == 0)
+                    break;
+
+                const auto left = Bus::peek(Stream::NDTR::address());
+                const size_t size = size_t{1} << ((cr >> 13) & 0b11);
+                const bool second = (cr & double_buffer_bit) && (cr & target_bit);
+                const auto address = Bus::peek(second ? Stream::M1AR::address() : Stream::M0AR::address())
+                                     + static_cast<std::uint32_t>((total - left) * size);
+                auto memory = Bus::memory_pointer(address);
+
+                std::uint32_t value = 0;
+                if (((cr >> 6) & 0b11) == static_cast<std::uint32_t>(Direction::peripheral_to_memory))
+                {
+                    value = exchange(std::uint32_t{0});
+                    std::memcpy(memory, &value, size);
+                }
+                else
+                {
+                    std::memcpy(&value, memory, size);
+                    exchange(value);
+                }
+
+                if (total - (left - 1) == total / 2)
+                    set_flags<Stream>(Stream::ht_flag);
+                if (left - 1 != 0)
+                {
+                    Bus::poke(Stream::NDTR::address(), left - 1);
+                    continue;
+                }
+
+                set_flags<Stream>(Stream::tc_flag);
+                if (cr & double_buffer_bit)
+                {
+                    Bus::poke(Stream::CR::address(), cr ^ target_bit);
+                    Bus::poke(Stream::NDTR::address(), total);
+                }
+                else if (cr & circular_bit)
+                    Bus::poke(Stream::NDTR::address(), total);
+                else
+                {
+                    Bus::poke(Stream::CR::address(), cr & ~enable_bit);
+                    Bus::poke(Stream::NDTR::address(), 0);
+                }
+            }
+            return done;
+        }
+
+    private:
+        static constexpr std::uint32_t enable_bit = 1U << 0;
+        static constexpr std::uint32_t circular_bit = 1U << 8;
+        static constexpr std::uint32_t double_buffer_bit = 1U << 18;
+        static constexpr std::uint32_t target_bit = 1U << 19;
+
+        template<typename Stream>
+        static void set_flags(std::uint32_t flags)
+        {
+            core::Simulated_bus::poke(Stream::ISR::address(), core::Simulated_bus::peek(Stream::ISR::address()) | flags);
+        }
+
+        /// Длина передачи каждого потока, записанная в NDTR при настройке
+        static inline std::array<std::uint32_t, 8> lengths{};
+    };
+}
+
+#endif // SIMULATEDDMA_HPP
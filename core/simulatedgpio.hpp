@@ -0,0 +1,249 @@
+#ifndef SIMULATEDGPIO_HPP
+#define SIMULATEDGPIO_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "register.hpp"
+#include "simulatedbus.hpp"
+
+/*!
+ * \file
+ * \brief Файл с моделью портов ввода-вывода для сборки на хосте
+ *
+ * Модель работает поверх Simulated_bus: обработчики записи в MODER, OTYPER,
+ * PUPDR, ODR и BSRR вычисляют уровни выводов и обновляют IDR, как это делает
+ * порт STM32F2/F4. Внешние сигналы задаются через drive, изменения уровней
+ * записываются с отметками времени модели и выводятся в формате VCD.
+ */
+
+namespace metaMCU::core {
+
+    /*!
+     * \brief Описание порта STM32F2/F4 на Simulated_bus
+     *
+     * Удовлетворяет требованиям Port и BoardConfiguration.
+     * \tparam Base Базовый адрес порта
+     */
+    template<size_t Base>
+    struct Simulated_port
+    {
+        static constexpr size_t base = Base;
+
+        using MODER = Register<Base + 0x00, std::uint32_t, Read_write_t, Simulated_bus>;
+        using OTYPER = Register<Base + 0x04, std::uint32_t, Read_write_t, Simulated_bus>;
+        using OSPEEDR = Register<Base + 0x08, std::uint32_t, Read_write_t, Simulated_bus>;
+        using PUPDR = Register<Base + 0x0C, std::uint32_t, Read_write_t, Simulated_bus>;
+        using IDT = Register<Base + 0x10, std::uint32_t, Read_only_t, Simulated_bus>;
+        using ODT = Register<Base + 0x14, std::uint32_t, Read_write_t, Simulated_bus>;
+        using SCR = Register<Base + 0x18, std::uint32_t, Write_only_t, Simulated_bus>;
+        using AFRL = Register<Base + 0x20, std::uint32_t, Read_write_t, Simulated_bus>;
+        using AFRH = Register<Base + 0x24, std::uint32_t, Read_write_t, Simulated_bus>;
+    };
+
+    /// \brief Время модели, общее для всех портов, в единицах шкалы VCD
+    class Simulated_clock
+    {
+    public:
+        static std::uint64_t now()
+        {
+            return time;
+        }
+
+        static void advance(std::uint64_t duration)
+        {
+            time += duration;
+        }
+
+        static void reset()
+        {
+            time = 0;
+        }
+
+    private:
+        static inline std::uint64_t time = 0;
+    };
+
+    /// \brief Изменение уровней выводов порта
+    struct Level_change
+    {
+        std::uint64_t time;
+        std::uint16_t levels;
+    };
+
+    /*!
+     * \brief Модель порта ввода-вывода
+     *
+     * Уровень вывода в режиме выхода равен биту ODR (в режиме открытого стока
+     * единица отпускает линию), в остальных режимах - внешнему сигналу, а если
+     * он не задан, - подтяжке PUPDR. IDR отражает уровни выводов, кроме
+     * аналоговых, которые читаются нулем. BSRR читается нулем, при одновременной
+     * установке и сбросе вывода приоритет у установки.
+     * \tparam Port Описание порта (например, Simulated_port)
+     */
+    template<typename Port>
+    class Simulated_gpio
+    {
+    public:
+        static constexpr std::uint8_t pins_count = 16;
+
+        /*!
+         * \brief Подключает модель к шине и начинает запись уровней
+         *
+         * Вызывается заново после Simulated_bus::clear.
+         */
+        static void attach()
+        {
+            driven = 0;
+            external = 0;
+            waveform.clear();
+            for (const auto address : {Port::MODER::address(), Port::OTYPER::address(), Port::PUPDR::address(), Port::ODT::address()})
+                Simulated_bus::on_write(address, [](std::uint32_t) { update(); });
+            Simulated_bus::on_write(Port::SCR::address(), [](std::uint32_t value)
+            {
+                const auto output = Simulated_bus::peek(Port::ODT::address());
+                Simulated_bus::poke(Port::ODT::address(), ((output & ~(value >> pins_count)) | value) & 0xFFFF);
+                Simulated_bus::poke(Port::SCR::address(), 0);
+                update();
+            });
+            waveform.push_back({Simulated_clock::now(), levels()});
+            update();
+        }
+
+        /// \brief Задает внешние уровни выводов mask
+        static void drive(std::uint16_t mask, std::uint16_t values)
+        {
+            driven |= mask;
+            external = (external & ~mask) | (values & mask);
+            update();
+        }
+
+        /// \brief Отключает внешние сигналы от выводов mask
+        static void release(std::uint16_t mask)
+        {
+            driven &= ~mask;
+            update();
+        }
+
+        /// \brief Текущие уровни выводов
+        static std::uint16_t levels()
+        {
+            const auto moder = Simulated_bus::peek(Port::MODER::address());
+            const auto open_drain = Simulated_bus::peek(Port::OTYPER::address());
+            const auto pupdr = Simulated_bus::peek(Port::PUPDR::address());
+            const auto output = Simulated_bus::peek(Port::ODT::address());
+
+            std::uint16_t result = 0;
+            for (std::uint8_t pin = 0; pin < pins_count; ++pin)
+            {
+                const std::uint16_t bit = 1U << pin;
+                const bool pulled_up = ((pupdr >> (2 * pin)) & 0b11) == 0b01;
+                const bool input = (driven & bit) ? (external & bit) : pulled_up;
+                bool level = input;
+                if (((moder >> (2 * pin)) & 0b11) == 0b01)
+                    level = !(output & bit) ? false : (open_drain & bit) ? input : true;
+                result |= level ? bit : 0;
+            }
+            return result;
+        }
+
+        /// \brief Записанные изменения уровней, первое - состояние при attach
+        static const std::vector<Level_change>& changes()
+        {
+            return waveform;
+        }
+
+    private:
+        /// Обновляет IDR и записывает изменение уровней
+        static void update()
+        {
+            const auto moder = Simulated_bus::peek(Port::MODER::address());
+            const auto current = levels();
+            std::uint32_t analog = 0;
+            for (std::uint8_t pin = 0; pin < pins_count; ++pin)
+                if (((moder >> (2 * pin)) & 0b11) == 0b11)
+                    analog |= 1U << pin;
+            Simulated_bus::poke(Port::IDT::address(), current & ~analog);
+
+            if (waveform.empty() || waveform.back().levels != current)
+                waveform.push_back({Simulated_clock::now(), current});
+        }
+
+        static inline std::uint16_t driven = 0;
+        static inline std::uint16_t external = 0;
+        static inline std::vector<Level_change> waveform;
+    };
+
+    /*!
+     * \brief Выводит записанные уровни выводов портов в формате VCD
+     * \code
+     * write_vcd<Simulated_gpio<GPIOA>, Simulated_gpio<GPIOB>>(file, {"GPIOA", "GPIOB"});
+     * \endcode
+     * \tparam Gpios Модели портов (Simulated_gpio)
+     * \param names Имена портов, выводы называются имя_номер
+     * \param timescale Единица времени Simulated_clock
+     */
+    template<typename... Gpios>
+    void write_vcd(std::ostream& out, const std::array<std::string_view, sizeof...(Gpios)>& names, std::string_view timescale = "1 ns")
+    {
+        constexpr size_t ports = sizeof...(Gpios);
+        constexpr size_t pins = 16;
+
+        auto identifier = [](size_t index)
+        {
+            std::string id;
+            do
+            {
+                id += static_cast<char>('!' + index % 94);
+                index /= 94;
+            }
+            while (index != 0);
+            return id;
+        };
+
+        out << "$timescale " << timescale << " $end\n$scope module gpio $end\n";
+        for (size_t port = 0; port < ports; ++port)
+        {
+            out << "$scope module " << names[port] << " $end\n";
+            for (size_t pin = 0; pin < pins; ++pin)
+                out << "$var wire 1 " << identifier(port * pins + pin) << ' ' << names[port] << '_' << pin << " $end\n";
+            out << "$upscope $end\n";
+        }
+        out << "$upscope $end\n$enddefinitions $end\n";
+
+        const std::array<const std::vector<Level_change>*, ports> waveforms = {&Gpios::changes()...};
+        std::array<size_t, ports> positions{};
+        std::array<std::uint32_t, ports> previous{};
+        previous.fill(~0U);
+
+        while (true)
+        {
+            std::uint64_t time = ~std::uint64_t{0};
+            for (size_t port = 0; port < ports; ++port)
+                if (positions[port] < waveforms[port]->size())
+                    time = std::min(time, (*waveforms[port])[positions[port]].time);
+            if (time == ~std::uint64_t{0})
+                break;
+
+            out << '#' << time << '\n';
+            for (size_t port = 0; port < ports; ++port)
+            {
+                std::uint32_t levels = previous[port];
+                for (auto& p = positions[port]; p < waveforms[port]->size() && (*waveforms[port])[p].time == time; ++p)
+                    levels = (*waveforms[port])[p].levels;
+                for (size_t pin = 0; pin < pins; ++pin)
+                    if (((levels ^ previous[port]) >> pin) & 1U)
+                        out << ((levels >> pin) & 1U) << identifier(port * pins + pin) << '\n';
+                previous[port] = levels;
+            }
+        }
+    }
+}
+
+#endif // SIMULATEDGPIO_HPP
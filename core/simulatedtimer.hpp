@@ -0,0 +1,164 @@
+#ifndef SIMULATEDTIMER_HPP
+#define SIMULATEDTIMER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "simulatedbus.hpp"
+#include "timer.hpp"
+
+/*!
+ * \file
+ * \brief Файл с моделью таймера для сборки на хосте
+ *
+ * Модель работает поверх Simulated_bus и разделяет буферные (preload) и рабочие
+ * (теневые) значения PSC, ARR и CCR, как таймер STM32: записи в регистры
+ * попадают в буфер, а в рабочие регистры переносятся по событию обновления
+ * (переполнение или UG), если буферизация включена (ARPE, OCxPE; PSC
+ * буферизован всегда).
+ */
+
+namespace metaMCU::timer {
+
+    /*!
+     * \brief Модель счетчика вверх с событиями обновления и выходами ШИМ
+     * \tparam Timer Таймер (Timer с политикой Simulated_bus)
+     */
+    template<typename Timer>
+    class Simulated_timer
+    {
+        using Bus = core::Simulated_bus;
+
+    public:
+        /*!
+         * \brief Подключает модель к шине и сбрасывает рабочие регистры
+         *
+         * Вызывается заново после Simulated_bus::clear.
+         */
+        static void attach()
+        {
+            active = {};
+            prescaler_count = 0;
+            update_events = 0;
+            status = 0;
+            Bus::on_write(Timer::SR::address(), [](std::uint32_t value)
+            {
+                status &= value;
+                Bus::poke(Timer::SR::address(), status);
+            });
+            Bus::on_write(Timer::EGR::address(), [](std::uint32_t value)
+            {
+                if (value & 1U)
+                    update();
+                Bus::poke(Timer::EGR::address(), 0);
+            });
+            Bus::on_write(Timer::ARR::address(), [](std::uint32_t value)
+            {
+                if (!(Bus::peek(Timer::CR1::address()) & arpe_bit))
+                    active.arr = value;
+            });
+            for (size_t channel = 0; channel < 4; ++channel)
+                Bus::on_write(Timer::template CCR<1>::address() + 4 * channel, [channel](std::uint32_t value)
+                {
+                    if (!(Bus::peek(ccmr_address(channel)) & ocpe_bit(channel)))
+                        active.ccr[channel] = value;
+                });
+        }
+
+        /// \brief Продвигает модель на clocks тактов входа таймера
+        static void advance(std::uint64_t clocks)
+        {
+            if (!(Bus::peek(Timer::CR1::address()) & cen_bit))
+                return;
+            for (; clocks != 0; --clocks)
+            {
+                if (prescaler_count++ < active.psc)
+                    continue;
+                prescaler_count = 0;
+                const auto count = Bus::peek(Timer::CNT::address());
+                if (count >= active.arr)
+                    update();
+                else
+                    Bus::poke(Timer::CNT::address(), count + 1);
+            }
+        }
+
+        /// \brief Рабочее значение ARR
+        static std::uint32_t active_arr()
+        {
+            return active.arr;
+        }
+
+        /// \brief Рабочее значение PSC
+        static std::uint32_t active_psc()
+        {
+            return active.psc;
+        }
+
+        /// \brief Рабочее значение CCR канала
+        template<size_t channel>
+        static std::uint32_t active_compare()
+        {
+            return active.ccr[channel - 1];
+        }
+
+        /// \brief Активный уровень выхода канала в режимах pwm1 и pwm2 (без учета полярности)
+        template<size_t channel>
+        static bool output()
+        {
+            const auto mode = (Bus::peek(ccmr_address(channel - 1)) >> (8 * ((channel - 1) % 2) + 4)) & 0b111;
+            const bool below = Bus::peek(Timer::CNT::address()) < active.ccr[channel - 1];
+            return mode == static_cast<std::uint32_t>(Output_mode::pwm1) ? below : !below;
+        }
+
+        /// \brief Количество событий обновления (переполнений и UG)
+        static size_t updates()
+        {
+            return update_events;
+        }
+
+    private:
+        static constexpr std::uint32_t cen_bit = 1U << 0;
+        static constexpr std::uint32_t arpe_bit = 1U << 7;
+
+        struct Active
+        {
+            std::uint32_t psc = 0;
+            std::uint32_t arr = 0;
+            std::array<std::uint32_t, 4> ccr{};
+        };
+
+        static constexpr size_t ccmr_address(size_t channel)
+        {
+            return channel < 2 ? Timer::CCMR1::address() : Timer::CCMR2::address();
+        }
+
+        static constexpr std::uint32_t ocpe_bit(size_t channel)
+        {
+            return 1U << (8 * (channel % 2) + 3);
+        }
+
+        /// Событие обновления: перенос буферов в рабочие регистры, обнуление счетчиков
+        static void update()
+        {
+            active.psc = Bus::peek(Timer::PSC::address());
+            active.arr = Bus::peek(Timer::ARR::address());
+            for (size_t channel = 0; channel < 4; ++channel)
+                active.ccr[channel] = Bus::peek(Timer::template CCR<1>::address() + 4 * channel);
+            prescaler_count = 0;
+            Bus::poke(Timer::CNT::address(), 0);
+            status |= 1U;
+            Bus::poke(Timer::SR::address(), status);
+            ++update_events;
+        }
+
+        static inline Active active;
+        static inline std::uint32_t prescaler_count = 0;
+        static inline size_t update_events = 0;
+        /// Флаги SR: устанавливаются моделью, сбрасываются записью 0
+        static inline std::uint32_t status = 0;
+    };
+}
+
+#endif // SIMULATEDTIMER_HPP
@@ -0,0 +1,125 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <array>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "metautils.hpp"
+#include "register.hpp"
+
+/*!
+ * \file
+ * \brief Файл с одновременным чтением нескольких битовых полей
+ */
+
+namespace metaMCU::core {
+
+    /// \brief Проверка того, что тип описывает битовое поле регистра (Field или Field_value)
+    template<typename F>
+    concept Field_like = requires
+    {
+        typename F::Register_t;
+        F::mask();
+        F::bit_offset();
+    };
+
+    /*!
+     * \brief Значения регистров, считанные одним чтением каждого регистра
+     *
+     * Поля группируются по регистрам на этапе компиляции, read читает каждый
+     * регистр один раз в порядке первого упоминания его полей. Значения полей
+     * извлекаются из сохраненных слов сдвигом и маской, вычисленными на этапе компиляции,
+     * без повторных обращений к шине.
+     * \code
+     * using Status = Snapshot<USART1_SR::RXNE, USART1_SR::ORE, DMA2_LISR::TCIF2, DMA2_S2NDTR::NDT>;
+     * const auto status = Status::read(); // три чтения
+     * if (status.is_set<USART1_SR::ORE::Overrun>())
+     *     lost += status.get<DMA2_S2NDTR::NDT>();
+     * \endcode
+     * \tparam Fields Поля или значения полей, регистры которых считываются
+     */
+    template<typename... Fields>
+        requires (sizeof...(Fields) != 0) && (Field_like<Fields> && ...)
+    class Snapshot
+    {
+        static constexpr auto groups = meta_utils::group(std::array<const void*, sizeof...(Fields)>{meta_utils::typeId<typename Fields::Register_t>()...},
+                                                         std::array<size_t, sizeof...(Fields)>{Fields::Register_t::address()...});
+
+        template<size_t G>
+        using Register_of = typename meta_utils::Nth<groups.first[G], Fields...>::Register_t;
+
+        static consteval auto words_type()
+        {
+            return []<size_t... G>(std::index_sequence<G...>)
+            {
+                return std::type_identity<std::tuple<typename Register_of<G>::Value_t...>>();
+            }(std::make_index_sequence<groups.count>());
+        }
+
+        /// Номер регистра R в снимке, groups.count, если регистр не считывается
+        template<typename R>
+        static consteval size_t index_of()
+        {
+            return []<size_t... G>(std::index_sequence<G...>)
+            {
+                size_t index = groups.count;
+                ((index = index == groups.count && std::is_same_v<Register_of<G>, R> ? G : index), ...);
+                return index;
+            }(std::make_index_sequence<groups.count>());
+        }
+
+    public:
+        /// \brief Считывает каждый регистр один раз
+        [[gnu::always_inline]] inline static Snapshot read()
+        {
+            Snapshot snapshot;
+            [&snapshot]<size_t... G>(std::index_sequence<G...>)
+            {
+                ((std::get<G>(snapshot.words) = Register_of<G>::read()), ...);
+            }(std::make_index_sequence<groups.count>());
+            return snapshot;
+        }
+
+        /// \brief Количество обращений к шине при read
+        static consteval size_t reads()
+        {
+            return []<size_t... G>(std::index_sequence<G...>)
+            {
+                return (size_t{0} + ... + Register_of<G>::read_accesses);
+            }(std::make_index_sequence<groups.count>());
+        }
+
+        /// \brief Значение поля F без смещения, регистр поля должен входить в снимок
+        template<Field_like F>
+        [[gnu::always_inline]] inline auto get() const
+        {
+            return static_cast<typename F::Value_t>((word<typename F::Register_t>() & F::mask()) >> F::bit_offset());
+        }
+
+        /// \brief Истина, если поле имеет значение V (Field_value)
+        template<typename V>
+            requires IsFieldValue<V>
+        [[gnu::always_inline]] inline bool is_set() const
+        {
+            constexpr auto expected = static_cast<typename V::Value_t>(V::value() << V::bit_offset());
+            return (word<typename V::Register_t>() & V::mask()) == expected;
+        }
+
+        /// \brief Считанное значение регистра R
+        template<typename R>
+        [[gnu::always_inline]] inline auto word() const
+        {
+            constexpr auto index = index_of<R>();
+            static_assert(index < groups.count, "Register is not captured by this snapshot");
+            return std::get<index>(words);
+        }
+
+    private:
+        typename decltype(words_type())::type words{};
+    };
+}
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,74 @@
+#ifndef SPI_HPP
+#define SPI_HPP
+
+#include <cstdint>
+#include <span>
+
+#include "dma.hpp"
+
+/*!
+ * \file
+ * \brief Файл с драйвером SPI на DMA без копирования данных
+ */
+
+namespace metaMCU {
+
+    /*!
+     * \brief Ведущий SPI с полнодуплексным обменом через DMA
+     *
+     * Описание Spi_port должно содержать регистр данных DR, однобитовые поля
+     * TXDMAEN и RXDMAEN (CR2) и списки маршрутов DMA Tx_routes и Rx_routes.
+     * \tparam Spi_port Описание периферии
+     * \tparam Tx_stream Поток DMA передачи
+     * \tparam Rx_stream Поток DMA приема
+     */
+    template<typename Spi_port, typename Tx_stream, typename Rx_stream>
+        requires dma::Connected<Tx_stream, typename Spi_port::Tx_routes> && dma::Connected<Rx_stream, typename Spi_port::Rx_routes>
+    class Spi
+    {
+    public:
+        /*!
+         * \brief Начинает обмен: передает tx и принимает столько же байт в rx
+         *
+         * Поток приема запускается раньше потока передачи, чтобы не потерять
+         * первый принятый байт. Буферы должны оставаться доступными до окончания
+         * обмена (busy).
+         * \return Ложь, если предыдущий обмен не завершен или размеры буферов различны
+         */
+        static bool transfer(std::span<const std::uint8_t> tx, std::span<std::uint8_t> rx)
+        {
+            if (busy() || tx.size() != rx.size())
+                return false;
+            Rx_stream::template start<rx_channel, dma::Direction::peripheral_to_memory>(Spi_port::DR::address(), rx);
+            Tx_stream::template start<tx_channel, dma::Direction::memory_to_peripheral>(Spi_port::DR::address(), tx);
+            core::Field_value<typename Spi_port::RXDMAEN, 1>::set();
+            core::Field_value<typename Spi_port::TXDMAEN, 1>::set();
+            return true;
+        }
+
+        /// \brief Истина, пока выполняется обмен (прием завершается последним)
+        static bool busy()
+        {
+            return Rx_stream::busy() || Tx_stream::busy();
+        }
+
+        /// \brief Обработчик прерывания потока приема, вызывает done по окончании обмена
+        template<typename Done>
+        static bool handle_rx_interrupt(Done done)
+        {
+            return Rx_stream::handle_interrupt([]{}, done);
+        }
+
+        /// \brief Обработчик прерывания потока передачи
+        static bool handle_tx_interrupt()
+        {
+            return Tx_stream::handle_interrupt([]{}, []{});
+        }
+
+    private:
+        static constexpr size_t tx_channel = dma::channel_of<Tx_stream>(typename Spi_port::Tx_routes());
+        static constexpr size_t rx_channel = dma::channel_of<Rx_stream>(typename Spi_port::Rx_routes());
+    };
+}
+
+#endif // SPI_HPP
@@ -0,0 +1,259 @@
+#ifndef TIMER_HPP
+#define TIMER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "bus.hpp"
+#include "field.hpp"
+#include "fields.hpp"
+#include "register.hpp"
+
+/*!
+ * \file
+ * \brief Файл с таймерами общего назначения и ШИМ (таймеры STM32F2/F4)
+ *
+ * Предделитель PSC и период ARR подбираются на этапе компиляции по частоте
+ * входа таймера и требуемой частоте переполнения. Недостижимая частота
+ * отвергается static_assert. Обновление скважности - одна запись в CCR.
+ *
+ * PSC, ARR и CCR таймера буферизованы: записанное значение (preload) переносится
+ * в рабочий (теневой) регистр по событию обновления. configure генерирует
+ * событие обновления программно, поэтому новые PSC и ARR действуют сразу,
+ * а изменения CCR в режиме ШИМ вступают в силу с начала следующего периода.
+ */
+
+namespace metaMCU::timer {
+
+    /// \brief Результат подбора предделителя и периода
+    struct Timer_solution
+    {
+        bool valid = false;
+        std::uint32_t psc = 0;
+        std::uint32_t arr = 0;
+        /// Относительная ошибка частоты в миллионных долях
+        std::uint32_t error_ppm = 0;
+    };
+
+    /*!
+     * \brief Подбирает PSC и ARR для частоты переполнения frequency
+     *
+     * Варианты перебираются от наименьшего предделителя (наибольшее разрешение
+     * ARR + 1) к наибольшему. Выбирается первый вариант с ошибкой не более
+     * tolerance_ppm, а если такого нет - вариант с наименьшей ошибкой, при равной
+     * ошибке - с большим разрешением. Период содержит не менее двух отсчетов.
+     * \param clock Частота входа таймера в Гц
+     * \param frequency Требуемая частота переполнения в Гц
+     * \param tolerance_ppm Допустимая ошибка, в пределах которой предпочитается разрешение
+     * \param max_arr Наибольшее значение ARR (0xFFFF для 16-битных таймеров)
+     * \return Решение, valid равно false, если частота недостижима
+     */
+    consteval Timer_solution solve(std::uint32_t clock, std::uint32_t frequency, std::uint32_t tolerance_ppm = 0,
+                                   std::uint32_t max_arr = 0xFFFF, std::uint32_t max_psc = 0xFFFF)
+    {
+        Timer_solution best;
+        if (frequency == 0 || frequency > clock / 2)
+            return best;
+
+        std::uint64_t best_error = std::numeric_limits<std::uint64_t>::max();
+        for (std::uint64_t psc = 0; psc <= max_psc; ++psc)
+        {
+            const std::uint64_t divider = (psc + 1) * frequency;
+            const std::uint64_t counts = (clock + divider / 2) / divider;
+            if (counts > std::uint64_t{max_arr} + 1)
+                continue;
+            if (counts < 2)
+                break;
+
+            const std::uint64_t actual = counts * divider;
+            const std::uint64_t difference = actual > clock ? actual - clock : clock - actual;
+            const std::uint64_t error = difference * 1'000'000 / clock;
+            if (error < best_error)
+            {
+                best_error = error;
+                best = {true, static_cast<std::uint32_t>(psc), static_cast<std::uint32_t>(counts - 1), static_cast<std::uint32_t>(error)};
+            }
+            if (error <= tolerance_ppm)
+                break;
+        }
+        return best;
+    }
+
+    /*!
+     * \brief Частота переполнения таймера, проверенная на этапе компиляции
+     * \tparam clock Частота входа таймера в Гц
+     * \tparam frequency Требуемая частота переполнения в Гц
+     * \tparam tolerance_ppm Допустимая ошибка, в пределах которой предпочитается разрешение
+     * \tparam max_arr Наибольшее значение ARR таймера
+     */
+    template<std::uint32_t clock, std::uint32_t frequency, std::uint32_t tolerance_ppm = 0, std::uint32_t max_arr = 0xFFFF>
+    struct Time_base
+    {
+        static constexpr Timer_solution solution = solve(clock, frequency, tolerance_ppm, max_arr);
+        static_assert(solution.valid, "Timer frequency is unreachable from this input clock");
+
+        static constexpr std::uint32_t psc = solution.psc;
+        static constexpr std::uint32_t arr = solution.arr;
+        static constexpr std::uint32_t error_ppm = solution.error_ppm;
+        static constexpr std::uint32_t max_arr_value = max_arr;
+
+        /// \brief Количество отсчетов в периоде (разрешение ШИМ)
+        static constexpr std::uint32_t period = arr + 1;
+
+        /// \brief Значение CCR для скважности numerator / denominator
+        static consteval std::uint32_t compare(std::uint32_t numerator, std::uint32_t denominator)
+        {
+            return static_cast<std::uint32_t>((std::uint64_t{period} * numerator + denominator / 2) / denominator);
+        }
+    };
+
+    /// \brief Режим выходного сравнения канала (поле OCxM)
+    enum class Output_mode : std::uint32_t
+    {
+        frozen = 0b000,
+        active_on_match = 0b001,
+        inactive_on_match = 0b010,
+        toggle = 0b011,
+        force_inactive = 0b100,
+        force_active = 0b101,
+        pwm1 = 0b110,  ///< Активный уровень, пока CNT < CCR
+        pwm2 = 0b111   ///< Неактивный уровень, пока CNT < CCR
+    };
+
+    /*!
+     * \brief Таймер общего назначения или расширенный таймер
+     * \tparam Base Адрес регистров таймера
+     * \tparam Counter_bits Разрядность счетчика (16 или 32 для TIM2 и TIM5)
+     * \tparam Advanced Расширенный таймер (TIM1, TIM8): выходы включаются битом MOE
+     * \tparam Bus Политика доступа к памяти
+     */
+    template<size_t Base, size_t Counter_bits = 16, bool Advanced = false, Bus_policy Bus = core::Mmio_bus>
+        requires (Counter_bits == 16 || Counter_bits == 32)
+    class Timer
+    {
+        template<size_t Offset, typename Access = Read_write_t>
+        using Timer_register = core::Register<Base + Offset, std::uint32_t, Access, Bus>;
+
+    public:
+        static constexpr size_t base = Base;
+        static constexpr std::uint32_t max_arr = Counter_bits == 32 ? 0xFFFFFFFF : 0xFFFF;
+
+        using CR1 = Timer_register<0x00>;
+        using DIER = Timer_register<0x0C>;
+        using SR = Timer_register<0x10>;
+        using EGR = Timer_register<0x14, Write_only_t>;
+        using CCMR1 = Timer_register<0x18>;
+        using CCMR2 = Timer_register<0x1C>;
+        using CCER = Timer_register<0x20>;
+        using CNT = Timer_register<0x24>;
+        using PSC = Timer_register<0x28>;
+        using ARR = Timer_register<0x2C>;
+        using BDTR = Timer_register<0x44>;
+
+        /// \brief Регистр сравнения канала 1 ... 4
+        template<size_t channel>
+            requires (channel >= 1 && channel <= 4)
+        using CCR = Timer_register<0x34 + 4 * (channel - 1)>;
+
+        using CEN = core::Field<CR1, 0, 1, Read_write_t>;
+        using ARPE = core::Field<CR1, 7, 1, Read_write_t>;
+        using UIE = core::Field<DIER, 0, 1, Read_write_t>;
+        using UIF = core::Field<SR, 0, 1, Read_write_t>;
+        using UG = core::Field<EGR, 0, 1, Write_only_t>;
+        using MOE = core::Field<BDTR, 15, 1, Read_write_t>;
+
+        template<size_t channel>
+        using CCMR = std::conditional_t<(channel <= 2), CCMR1, CCMR2>;
+        /// Режим выходного сравнения канала
+        template<size_t channel>
+        using OCM = core::Field<CCMR<channel>, 8 * ((channel - 1) % 2) + 4, 3, Read_write_t>;
+        /// Буферизация CCR канала
+        template<size_t channel>
+        using OCPE = core::Field<CCMR<channel>, 8 * ((channel - 1) % 2) + 3, 1, Read_write_t>;
+        /// Включение выхода канала
+        template<size_t channel>
+        using CCE = core::Field<CCER, 4 * (channel - 1), 1, Read_write_t>;
+        /// Полярность выхода канала
+        template<size_t channel>
+        using CCP = core::Field<CCER, 4 * (channel - 1) + 1, 1, Read_write_t>;
+
+        /*!
+         * \brief Задает частоту переполнения и загружает PSC и ARR в рабочие регистры
+         *
+         * Включает буферизацию ARR и генерирует событие обновления, флаг UIF,
+         * установленный этим событием, сбрасывается (флаги SR сбрасываются записью 0).
+         * Счетчик не запускается.
+         * \tparam Base_t Частота (Time_base), рассчитанная для разрядности этого таймера
+         */
+        template<typename Base_t>
+        static void configure()
+        {
+            static_assert(Base_t::max_arr_value <= max_arr, "Time base is computed for a wider counter");
+            PSC::write(Base_t::psc);
+            ARR::write(Base_t::arr);
+            Values<core::Field_value<ARPE, 1>>::Set();
+            core::Field_value<UG, 1>::write();
+            SR::write(static_cast<std::uint32_t>(~UIF::mask()));
+        }
+
+        /*!
+         * \brief Настраивает канал для ШИМ с буферизацией CCR и включает его выход
+         *
+         * CCMR и CCER изменяются одним чтением-модификацией-записью каждый.
+         * \tparam channel Канал 1 ... 4
+         * \tparam mode Режим выхода
+         * \tparam inverted Активный уровень - низкий
+         */
+        template<size_t channel, Output_mode mode = Output_mode::pwm1, bool inverted = false>
+            requires (channel >= 1 && channel <= 4)
+        static void enable_output(std::uint32_t compare = 0)
+        {
+            CCR<channel>::write(compare);
+            Values<core::Field_value<OCM<channel>, static_cast<std::uint32_t>(mode)>,
+                   core::Field_value<OCPE<channel>, 1>,
+                   core::Field_value<CCP<channel>, inverted>,
+                   core::Field_value<CCE<channel>, 1>>::Set();
+            if constexpr (Advanced)
+                core::Field_value<MOE, 1>::set();
+        }
+
+        /// \brief Отключает выход канала
+        template<size_t channel>
+            requires (channel >= 1 && channel <= 4)
+        static void disable_output()
+        {
+            core::Field_value<CCE<channel>, 0>::set();
+        }
+
+        /*!
+         * \brief Задает значение сравнения канала одной записью в CCR
+         *
+         * При включенной буферизации значение действует с начала следующего периода.
+         */
+        template<size_t channel>
+            requires (channel >= 1 && channel <= 4)
+        [[gnu::always_inline]] inline static void set_compare(std::uint32_t compare)
+        {
+            CCR<channel>::write(compare);
+        }
+
+        static void start()
+        {
+            core::Field_value<CEN, 1>::set();
+        }
+
+        static void stop()
+        {
+            core::Field_value<CEN, 0>::set();
+        }
+
+        /// \brief Текущее значение счетчика
+        static std::uint32_t counter()
+        {
+            return CNT::read();
+        }
+    };
+}
+
+#endif // TIMER_HPP
@@ -0,0 +1,119 @@
+#ifndef UART_HPP
+#define UART_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "dma.hpp"
+
+/*!
+ * \file
+ * \brief Файл с драйвером UART на DMA без копирования данных
+ */
+
+namespace metaMCU {
+
+    /*!
+     * \brief UART с передачей и приемом через DMA
+     *
+     * Передача выполняется непосредственно из буфера пользователя, прием -
+     * в кольцевой буфер пользователя в режиме circular. Принятые данные
+     * выдаются непрерывными участками этого буфера.
+     *
+     * Описание Usart должно содержать регистр данных DR, однобитовые поля
+     * DMAT и DMAR (CR3) и списки маршрутов DMA Tx_routes и Rx_routes.
+     * \warning Если данные не извлекаются вовремя, DMA перезаписывает
+     * непрочитанную часть кольцевого буфера.
+     * \tparam Usart Описание периферии
+     * \tparam Tx_stream Поток DMA передачи
+     * \tparam Rx_stream Поток DMA приема
+     */
+    template<typename Usart, typename Tx_stream, typename Rx_stream>
+        requires dma::Connected<Tx_stream, typename Usart::Tx_routes> && dma::Connected<Rx_stream, typename Usart::Rx_routes>
+    class Uart
+    {
+    public:
+        /*!
+         * \brief Начинает передачу буфера
+         *
+         * Буфер должен оставаться неизменным до окончания передачи (transmitting).
+         * \return Ложь, если предыдущая передача не завершена
+         */
+        static bool transmit(std::span<const std::uint8_t> data)
+        {
+            if (transmitting())
+                return false;
+            Tx_stream::template start<tx_channel, dma::Direction::memory_to_peripheral>(Usart::DR::address(), data);
+            core::Field_value<typename Usart::DMAT, 1>::set();
+            return true;
+        }
+
+        /// \brief Истина, пока выполняется передача
+        static bool transmitting()
+        {
+            return Tx_stream::busy();
+        }
+
+        /// \brief Начинает непрерывный прием в кольцевой буфер
+        static void start_receive(std::span<std::uint8_t> buffer)
+        {
+            ring = buffer;
+            read_position = 0;
+            Rx_stream::template start<rx_channel, dma::Direction::peripheral_to_memory, dma::Mode::circular>(Usart::DR::address(), buffer);
+            core::Field_value<typename Usart::DMAR, 1>::set();
+        }
+
+        static void stop_receive()
+        {
+            core::Field_value<typename Usart::DMAR, 0>::set();
+            Rx_stream::stop();
+        }
+
+        /*!
+         * \brief Непрерывный участок принятых и не извлеченных данных
+         *
+         * Если данные переходят через конец буфера, возвращается участок до конца,
+         * остаток - при следующем вызове после consume. До start_receive
+         * возвращается пустой участок.
+         */
+        static std::span<const std::uint8_t> received()
+        {
+            if (ring.empty())
+                return {};
+            const size_t write_position = (ring.size() - Rx_stream::remaining()) % ring.size();
+            const size_t end = write_position >= read_position ? write_position : ring.size();
+            return ring.subspan(read_position, end - read_position);
+        }
+
+        /// \brief Освобождает count байт, полученных из received
+        static void consume(size_t count)
+        {
+            if (ring.empty())
+                return;
+            read_position = (read_position + count) % ring.size();
+        }
+
+        /// \brief Обработчик прерывания потока передачи
+        static bool handle_tx_interrupt()
+        {
+            return Tx_stream::handle_interrupt([]{}, []{});
+        }
+
+        /// \brief Обработчик прерывания потока приема, вызывает half и full по заполнению половин буфера
+        template<typename Half, typename Full>
+        static bool handle_rx_interrupt(Half half, Full full)
+        {
+            return Rx_stream::handle_interrupt(half, full);
+        }
+
+    private:
+        static constexpr size_t tx_channel = dma::channel_of<Tx_stream>(typename Usart::Tx_routes());
+        static constexpr size_t rx_channel = dma::channel_of<Rx_stream>(typename Usart::Rx_routes());
+
+        static inline std::span<std::uint8_t> ring;
+        static inline size_t read_position = 0;
+    };
+}
+
+#endif // UART_HPP
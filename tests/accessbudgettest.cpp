@@ -0,0 +1,127 @@
+#include <cstdint>
+
+#include "budgets.hpp"
+#include "check.hpp"
+#include "cortexM3.hpp"
+#include "fields.hpp"
+#include "port.hpp"
+#include "shadowregister.hpp"
+#include "simulatedbus.hpp"
+#include "simulatedgpio.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+namespace budget = metaMCU::test::budget;
+
+namespace {
+    using CR = CortexM3::Register<0x40010000, std::uint32_t, Read_write_t, Simulated_bus>;
+    using DR = core::Register<0x40010004, std::uint32_t, Write_only_t, Simulated_bus>;
+    using MR = core::Shadow_register<0x40010008, std::uint32_t, Read_write_t, 0, Simulated_bus>;
+
+    using EN = CortexM3::Field<CR, 0, 1, Read_write_t>;
+    using MODE = core::Field<CR, 4, 3, Read_write_t>;
+    using HIGH = core::Field<CR, 8, 24, Read_write_t>;
+    using LOW = core::Field<CR, 0, 8, Read_write_t>;
+    using DATA = core::Field<DR, 0, 16, Write_only_t>;
+    using SPEED = core::Field<MR, 2, 2, Read_write_t>;
+
+    using Enable = core::Field_value<EN, 1>;
+    using Mode5 = core::Field_value<MODE, 5>;
+    using High = core::Field_value<HIGH, 0xABCDEF>;
+    using Low = core::Field_value<LOW, 0x12>;
+    using Data = core::Field_value<DATA, 0x1234>;
+    using Speed = core::Field_value<SPEED, 2>;
+
+    using GPIOA = core::Simulated_port<0x40020000>;
+    using GPIOB = core::Simulated_port<0x40020400>;
+    using Leds = Pins<PortPin<GPIOA, 1>, PortPin<GPIOA, 5>, PortPin<GPIOB, 3>>;
+
+    static_assert(CR::read_accesses == 1 && MR::read_accesses == 0);
+
+    /// Оценка на этапе компиляции не превышает бюджет
+    template<typename V>
+    consteval bool within(budget::Accesses set)
+    {
+        return V::SetReads() <= set.reads && V::SetWrites() <= set.writes;
+    }
+
+    static_assert(within<Values<Enable, Mode5>>(budget::values_set_modify));
+    static_assert(within<Values<High, Low>>(budget::values_set_full));
+    static_assert(within<Values<Data>>(budget::values_set_write_only));
+    static_assert(within<Values<Speed>>(budget::values_set_shadow));
+    static_assert(within<Values<Enable>>(budget::values_set_bit_band));
+    static_assert(within<Values<Mode5, Data, Speed>>(budget::values_set_mixed));
+    static_assert(Values<Enable, Mode5>::IsSetReads() <= budget::values_is_set.reads);
+    static_assert(Leds::PortsCount() <= budget::pins_set.writes);
+
+    /// Выполняет операцию и сравнивает счетчики Simulated_bus с бюджетом
+    template<typename F>
+    void measure(F operation, budget::Accesses expected, const char* name)
+    {
+        Simulated_bus::reset_counters();
+        operation();
+        const auto reads = Simulated_bus::reads();
+        const auto writes = Simulated_bus::writes();
+        if (reads > expected.reads || writes > expected.writes)
+        {
+            std::fprintf(stderr, "%s: %zu reads, %zu writes, budget %zu reads, %zu writes\n",
+                         name, reads, writes, expected.reads, expected.writes);
+            ++test::failures;
+        }
+    }
+
+    /// Фактические обращения совпадают с оценкой Values на этапе компиляции
+    template<typename V>
+    void matches_estimate()
+    {
+        Simulated_bus::reset_counters();
+        V::Set();
+        CHECK_EQUAL(Simulated_bus::reads(), V::SetReads());
+        CHECK_EQUAL(Simulated_bus::writes(), V::SetWrites());
+        Simulated_bus::reset_counters();
+        (void)V::IsSet();
+        CHECK_EQUAL(Simulated_bus::reads(), V::IsSetReads());
+    }
+
+    void values()
+    {
+        Simulated_bus::clear();
+        measure([] { Values<Enable, Mode5>::Set(); }, budget::values_set_modify, "values_set_modify");
+        measure([] { Values<High, Low>::Set(); }, budget::values_set_full, "values_set_full");
+        measure([] { Values<Data>::Set(); }, budget::values_set_write_only, "values_set_write_only");
+        measure([] { Values<Speed>::Set(); }, budget::values_set_shadow, "values_set_shadow");
+        measure([] { Values<Enable>::Set(); }, budget::values_set_bit_band, "values_set_bit_band");
+        measure([] { Values<Mode5, Data, Speed>::Set(); }, budget::values_set_mixed, "values_set_mixed");
+        measure([] { (void)Values<Enable, Mode5>::IsSet(); }, budget::values_is_set, "values_is_set");
+
+        matches_estimate<Values<Enable, Mode5>>();
+        matches_estimate<Values<High, Low>>();
+        matches_estimate<Values<Speed>>();
+        matches_estimate<Values<Enable>>();
+    }
+
+    void pins()
+    {
+        Simulated_bus::clear();
+        core::Simulated_gpio<GPIOA>::attach();
+        core::Simulated_gpio<GPIOB>::attach();
+
+        measure([] { Leds::Set(); }, budget::pins_set, "pins_set");
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::ODT::address()), 0x22);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOB::ODT::address()), 0x08);
+        measure([] { Leds::Reset(); }, budget::pins_set, "pins_reset");
+        measure([] { Leds::Toggle(); }, budget::pins_toggle, "pins_toggle");
+        measure([] { Leds::Write<0b101>(); }, budget::pins_write, "pins_write");
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::ODT::address()), 0x02);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOB::ODT::address()), 0x08);
+        measure([] { Leds::SetOutput(); }, budget::pins_set_output, "pins_set_output");
+        measure([] { PortPin<GPIOA, 7>::Set(); }, budget::port_pin_set, "port_pin_set");
+    }
+}
+
+int main()
+{
+    values();
+    pins();
+    return test::result();
+}
@@ -0,0 +1,127 @@
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "allocator.hpp"
+#include "bench.hpp"
+#include "check.hpp"
+
+using namespace metaMCU;
+
+namespace {
+    constexpr size_t operations = 2'000'000;
+    constexpr size_t block = 64;
+    constexpr size_t batch = 32;
+
+    memory::Block_pool<block, batch> pool;
+    memory::Arena<block * batch> arena;
+
+    /// Выделение и немедленное освобождение одного блока
+    void single()
+    {
+        test::benchmark("pool allocate+deallocate", operations, []
+        {
+            for (size_t i = 0; i < operations; ++i)
+            {
+                auto p = pool.allocate();
+                test::keep(p);
+                pool.deallocate(p);
+            }
+        });
+        test::benchmark("malloc+free", operations, []
+        {
+            for (size_t i = 0; i < operations; ++i)
+            {
+                auto p = std::malloc(block);
+                test::keep(p);
+                std::free(p);
+            }
+        });
+        CHECK_EQUAL(pool.in_use(), 0);
+        CHECK_EQUAL(pool.high_water(), 1);
+    }
+
+    /// Выделение пакета блоков и освобождение в обратном порядке, стоимость на блок
+    void batches()
+    {
+        std::array<void*, batch> blocks{};
+        test::benchmark("pool batch of 32, per block", operations, [&blocks]
+        {
+            for (size_t i = 0; i < operations; i += batch)
+            {
+                for (auto& p : blocks)
+                    p = pool.allocate();
+                test::keep(blocks);
+                for (size_t j = batch; j-- > 0;)
+                    pool.deallocate(blocks[j]);
+            }
+        });
+        test::benchmark("malloc batch of 32, per block", operations, [&blocks]
+        {
+            for (size_t i = 0; i < operations; i += batch)
+            {
+                for (auto& p : blocks)
+                    p = std::malloc(block);
+                test::keep(blocks);
+                for (size_t j = batch; j-- > 0;)
+                    std::free(blocks[j]);
+            }
+        });
+        test::benchmark("arena batch of 32 + reset, per block", operations, [&blocks]
+        {
+            for (size_t i = 0; i < operations; i += batch)
+            {
+                for (auto& p : blocks)
+                    p = arena.allocate(block);
+                test::keep(blocks);
+                arena.reset();
+            }
+        });
+        CHECK_EQUAL(pool.in_use(), 0);
+        CHECK_EQUAL(pool.high_water(), batch);
+        CHECK_EQUAL(pool.failures(), 0);
+        CHECK_EQUAL(arena.failures(), 0);
+        CHECK_EQUAL(arena.high_water(), block * batch);
+    }
+
+    /// Два потока выделяют и освобождают блоки одного пула
+    void contention()
+    {
+        const auto work = [](auto allocate, auto deallocate)
+        {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < 2; ++t)
+                threads.emplace_back([&]
+                {
+                    for (size_t i = 0; i < operations / 2; ++i)
+                    {
+                        auto p = allocate();
+                        test::keep(p);
+                        deallocate(p);
+                    }
+                });
+            for (auto& thread : threads)
+                thread.join();
+        };
+        test::benchmark("pool 2 threads", operations, [&]
+        {
+            work([] { return pool.allocate(); }, [](void* p) { pool.deallocate(p); });
+        });
+        test::benchmark("malloc 2 threads", operations, [&]
+        {
+            work([] { return std::malloc(block); }, [](void* p) { std::free(p); });
+        });
+        CHECK_EQUAL(pool.in_use(), 0);
+        CHECK_EQUAL(pool.failures(), 0);
+    }
+}
+
+int main()
+{
+    single();
+    batches();
+    contention();
+    return test::result();
+}
@@ -0,0 +1,196 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "async.hpp"
+#include "check.hpp"
+#include "field.hpp"
+#include "register.hpp"
+#include "simulatedbus.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    using Pool = async::Frame_pool<512, 4>;
+    using Task = async::Task<Pool>;
+    using async::Executor;
+
+    using SR = core::Register<0x40011000, std::uint32_t, Read_only_t, Simulated_bus>;
+    using Ready = core::Field_value<core::Field<SR, 5, 1, Read_only_t>, 1>;
+
+    std::vector<int> trace;
+
+    Task wait_event(async::Event& event, int id, int times)
+    {
+        for (int i = 0; i < times; ++i)
+        {
+            co_await event;
+            trace.push_back(id);
+        }
+    }
+
+    Task wait_ready(int id)
+    {
+        co_await async::until<Ready>();
+        trace.push_back(id);
+    }
+
+    bool flag = false;
+
+    Task wait_flag(int id)
+    {
+        co_await async::until(+[] { return flag; });
+        trace.push_back(id);
+    }
+
+    Task sleeper(std::uint32_t ticks, int id)
+    {
+        co_await async::sleep_for(ticks);
+        trace.push_back(id);
+    }
+
+    void run_all()
+    {
+        while (Executor::run_once()) {}
+    }
+
+    /// Сигнал до co_await не теряется, повторные сигналы объединяются
+    void event_before_await()
+    {
+        trace.clear();
+        async::Event event;
+        event.signal();
+        event.signal();
+        CHECK(Executor::spawn(wait_event(event, 1, 2)));
+        run_all();
+        CHECK(trace == (std::vector<int>{1}));
+
+        event.signal();
+        run_all();
+        CHECK(trace == (std::vector<int>{1, 1}));
+        CHECK_EQUAL(Pool::in_use(), 0);
+    }
+
+    /// Сигнал после приостановки возобновляет сопрограмму в run_once, а не в signal
+    void event_after_await()
+    {
+        trace.clear();
+        async::Event event;
+        CHECK(Executor::spawn(wait_event(event, 2, 1)));
+        run_all();
+        CHECK(trace.empty());
+        event.signal();
+        CHECK(trace.empty());
+        CHECK(Executor::run_once());
+        CHECK(trace == (std::vector<int>{2}));
+        CHECK(Executor::idle());
+    }
+
+    std::atomic<int> acknowledged = 0;
+
+    Task acknowledge(async::Event& event, int times)
+    {
+        for (int i = 1; i <= times; ++i)
+        {
+            co_await event;
+            acknowledged.store(i, std::memory_order_release);
+        }
+    }
+
+    /// Сигнал из другого потока ("прерывания") во время приостановки не теряется
+    void event_from_thread()
+    {
+        constexpr int rounds = 20000;
+        async::Event request;
+        acknowledged = 0;
+        CHECK(Executor::spawn(acknowledge(request, rounds)));
+        std::thread isr([&request]
+        {
+            for (int i = 1; i <= rounds; ++i)
+            {
+                request.signal();
+                while (acknowledged.load(std::memory_order_acquire) < i)
+                    std::this_thread::yield();
+            }
+        });
+        while (acknowledged.load(std::memory_order_acquire) < rounds)
+            if (!Executor::run_once())
+                std::this_thread::yield();
+        isr.join();
+        CHECK_EQUAL(acknowledged.load(), rounds);
+        CHECK_EQUAL(Pool::in_use(), 0);
+        CHECK(Executor::idle());
+    }
+
+    /// resume_if возобновляет только сопрограммы с выполненным условием, остальные ждут
+    void conditions()
+    {
+        trace.clear();
+        Simulated_bus::clear();
+        flag = false;
+        CHECK(Executor::spawn(wait_ready(4)));
+        CHECK(Executor::spawn(wait_flag(5)));
+        CHECK(Executor::spawn(wait_ready(6)));
+        run_all();
+        CHECK(trace.empty());
+        CHECK(!Executor::idle());
+
+        Simulated_bus::poke(SR::address(), 1U << 5);
+        CHECK(Executor::run_once());
+        CHECK_EQUAL(trace.size(), 2);
+        CHECK(!Executor::idle());
+
+        flag = true;
+        CHECK(Executor::run_once());
+        CHECK_EQUAL(trace.size(), 3);
+        CHECK_EQUAL(trace.back(), 5);
+        CHECK(Executor::idle());
+        CHECK(!Executor::run_once());
+    }
+
+    void timers()
+    {
+        trace.clear();
+        CHECK(Executor::spawn(sleeper(3, 7)));
+        CHECK(Executor::spawn(sleeper(1, 8)));
+        CHECK(Executor::spawn(sleeper(0, 9)));
+        run_all();
+        CHECK(trace == (std::vector<int>{9}));
+        Executor::tick();
+        run_all();
+        CHECK(trace == (std::vector<int>{9, 8}));
+        Executor::tick();
+        run_all();
+        CHECK_EQUAL(trace.size(), 2);
+        Executor::tick();
+        run_all();
+        CHECK(trace == (std::vector<int>{9, 8, 7}));
+        CHECK(Executor::idle());
+    }
+
+    /// При исчерпании пула сопрограмма не создается, кадры возвращаются по завершении
+    void pool_exhaustion()
+    {
+        flag = false;
+        for (int i = 0; i < 4; ++i)
+            CHECK(Executor::spawn(wait_flag(10)));
+        CHECK(!Executor::spawn(wait_flag(11)));
+        CHECK_EQUAL(Pool::in_use(), 4);
+        flag = true;
+        run_all();
+        CHECK_EQUAL(Pool::in_use(), 0);
+    }
+}
+
+int main()
+{
+    event_before_await();
+    event_after_await();
+    event_from_thread();
+    conditions();
+    timers();
+    pool_exhaustion();
+    return test::result();
+}
@@ -0,0 +1,102 @@
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "atomic.hpp"
+#include "check.hpp"
+#include "field.hpp"
+#include "shadowregister.hpp"
+#include "simulatedbus.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    using CR = core::Register<0x40010000, std::uint32_t, Read_write_t, Simulated_bus>;
+    using MODER = core::Shadow_register<0x40010004, std::uint32_t, Read_write_t, 0xA0, Simulated_bus>;
+
+    template<typename R, size_t N>
+    using Bit = core::Field<R, N, 1, Read_write_t>;
+    using COUNT = core::Field<CR, 16, 8, Read_write_t>;
+    using MODE0 = core::Field<MODER, 0, 2, Read_write_t>;
+    using MODE1 = core::Field<MODER, 2, 2, Read_write_t>;
+
+    void field_operations()
+    {
+        Simulated_bus::clear();
+        atomic::set<core::Field_value<Bit<CR, 3>, 1>, core::Field_value<COUNT, 0x42>>();
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0x00420008);
+        atomic::toggle<Bit<CR, 0>, Bit<CR, 3>>();
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0x00420001);
+        atomic::clear<COUNT>();
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0x00000001);
+        CHECK_EQUAL(atomic::fetch_modify<COUNT>([](std::uint32_t v) { return v + 0x1FF; }), 0);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0x00FF0001);
+    }
+
+    /// Потоки увеличивают одно поле: без атомарности часть увеличений теряется
+    void contention()
+    {
+        Simulated_bus::clear();
+        CR::reset_atomic_retries();
+        constexpr int threads = 8;
+        constexpr int increments = 20000;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([t]
+            {
+                for (int i = 0; i < increments; ++i)
+                    CR::modify_atomic([t](std::uint32_t v) { return ((v + 1) & 0xFFFFFF) | (std::uint32_t(t) << 24); });
+            });
+        for (auto& w : workers)
+            w.join();
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()) & 0xFFFFFF, threads * increments);
+        CHECK_EQUAL(Simulated_bus::writes(CR::address()), threads * increments);
+        CHECK_EQUAL(Simulated_bus::reads(CR::address()), threads * increments + atomic::retries<CR>());
+    }
+
+    /// Атомарная операция над Shadow_register обновляет копию
+    void shadow_copy()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(MODER::address(), 0xA0);
+        atomic::set<core::Field_value<MODE0, 0b10>>();
+        CHECK_EQUAL(Simulated_bus::peek(MODER::address()), 0xA2);
+        CHECK(MODER::values_is_set<core::Field_value<MODE0, 0b10>>());
+        MODER::values_set<core::Field_value<MODE1, 0b01>>();
+        CHECK_EQUAL(Simulated_bus::peek(MODER::address()), 0xA6);
+
+        atomic::toggle<MODE1>();
+        atomic::clear<MODE0>();
+        CHECK_EQUAL(atomic::fetch_modify<MODE0>([](std::uint32_t) { return 0b11; }), 0);
+        CHECK_EQUAL(MODER::read(), Simulated_bus::peek(MODER::address()));
+        CHECK_EQUAL(MODER::read(), 0xAB);
+    }
+
+    /// Копия совпадает с регистром после одновременных атомарных операций
+    void shadow_contention()
+    {
+        Simulated_bus::clear();
+        MODER::write(0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < 8; ++t)
+            workers.emplace_back([t]
+            {
+                for (int i = 0; i < 5000; ++i)
+                    MODER::bits_toggle_atomic(1U << (t * 2 + (i & 1)));
+            });
+        for (auto& w : workers)
+            w.join();
+        CHECK_EQUAL(Simulated_bus::peek(MODER::address()), 0);
+        CHECK_EQUAL(MODER::read(), 0);
+    }
+}
+
+int main()
+{
+    field_operations();
+    contention();
+    shadow_copy();
+    shadow_contention();
+    return test::result();
+}
@@ -0,0 +1,56 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+/*!
+ * \file
+ * \brief Минимальные измерения времени для бенчмарков на хосте
+ *
+ * Бенчмарк - отдельная программа, регистрируется в CTest как тест и печатает
+ * время на операцию. Результат зависит от машины, поэтому бенчмарк проверяет
+ * только корректность измеряемой работы, а не время.
+ */
+
+namespace metaMCU::test {
+
+    /// \brief Не дает компилятору удалить вычисление value
+    template<typename T>
+    inline void keep(const T& value)
+    {
+        asm volatile("" : : "g"(&value) : "memory");
+    }
+
+    /*!
+     * \brief Время выполнения body в наносекундах на операцию
+     * \param operations Количество операций, выполняемых body
+     * \param body Измеряемая работа, вызывается один раз
+     */
+    template<typename F>
+    double ns_per_operation(size_t operations, F body)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(operations);
+    }
+
+    /// \brief Печатает строку результата: время на операцию и операций в секунду
+    inline void report(const char* name, double ns)
+    {
+        std::printf("%-40s %10.2f ns/op %10.2f Mop/s\n", name, ns, 1e3 / ns);
+    }
+
+    /// \brief Измеряет body и печатает результат
+    template<typename F>
+    double benchmark(const char* name, size_t operations, F body)
+    {
+        const auto ns = ns_per_operation(operations, body);
+        report(name, ns);
+        return ns;
+    }
+}
+
+#endif // BENCH_HPP
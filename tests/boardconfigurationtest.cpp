@@ -0,0 +1,160 @@
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "boardconfiguration.hpp"
+#include "check.hpp"
+#include "port.hpp"
+#include "simulatedbus.hpp"
+#include "simulatedgpio.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+using core::Simulated_clock;
+
+namespace {
+    using GPIOA = core::Simulated_port<0x40020000>;
+    using GPIOB = core::Simulated_port<0x40020400>;
+    using Gpio_a = core::Simulated_gpio<GPIOA>;
+    using Gpio_b = core::Simulated_gpio<GPIOB>;
+
+    /// Часть выводов GPIOA: каждый регистр задан частично
+    using Partial = BoardConfiguration<
+        PinSetup<PortPin<GPIOA, 5>, StartupConfiguration<PUSHPULL_OUTPUT, LARGE_STR>>,
+        PinSetup<PortPin<GPIOA, 9>, StartupConfiguration<AUX_PUSHPULL_OUTPUT, MAX_STR, PIN_NON_CONFIGURABLE, 7>>,
+        PinSetup<PortPin<GPIOA, 10>, StartupConfiguration<AUX_OPENDRAIN_OUTPUT, NORMAL_STR, PIN_NON_CONFIGURABLE, 4>>,
+        PinSetup<PortPin<GPIOA, 2>, StartupConfiguration<PULLUP_INPUT>>>;
+
+    /// Все выводы GPIOB - выходы: MODER, OTYPER, OSPEEDR и PUPDR заданы полностью
+    template<size_t... N>
+    auto all_outputs(std::index_sequence<N...>) -> BoardConfiguration<PinSetup<PortPin<GPIOB, N>, StartupConfiguration<PUSHPULL_OUTPUT>>...>;
+    using Full = decltype(all_outputs(std::make_index_sequence<16>()));
+
+    /// Оба порта в одной конфигурации: порты записываются в порядке первого упоминания
+    using Board = BoardConfiguration<
+        PinSetup<PortPin<GPIOB, 0>, StartupConfiguration<PUSHPULL_OUTPUT>>,
+        PinSetup<PortPin<GPIOA, 9>, StartupConfiguration<AUX_PUSHPULL_OUTPUT, MAX_STR, PIN_NON_CONFIGURABLE, 7>>,
+        PinSetup<PortPin<GPIOB, 12>, StartupConfiguration<PULLDOWN_INPUT>>>;
+
+    // Повторная конфигурация вывода отвергается (static_assert в BoardConfiguration)
+    static_assert(!NoDuplicates<PortPin<GPIOA, 5>, PortPin<GPIOB, 5>, PortPin<GPIOA, 5>>);
+    static_assert(NoDuplicates<PortPin<GPIOA, 5>, PortPin<GPIOB, 5>>);
+
+#ifdef BOARD_DUPLICATE_PIN
+    using Duplicate = BoardConfiguration<
+        PinSetup<PortPin<GPIOA, 5>, StartupConfiguration<PUSHPULL_OUTPUT>>,
+        PinSetup<PortPin<GPIOA, 5>, StartupConfiguration<FLOAT_INPUT>>>;
+    [[maybe_unused]] auto configure = &Duplicate::Configure;
+#endif
+
+    template<typename P>
+    constexpr std::array<size_t, 6> registers = {P::MODER::address(), P::OTYPER::address(), P::OSPEEDR::address(),
+                                                 P::PUPDR::address(), P::AFRL::address(), P::AFRH::address()};
+
+    /// Записи регистров портов в порядке записи
+    std::vector<size_t> order;
+
+    template<typename... Ps>
+    void trace_writes()
+    {
+        order.clear();
+        for (const auto& addresses : {registers<Ps>...})
+            for (const size_t address : addresses)
+                Simulated_bus::on_write(address, [address](std::uint32_t) { order.push_back(address); });
+    }
+
+    void reset_values()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(GPIOA::MODER::address(), 0xA8000000);
+        Simulated_bus::poke(GPIOA::OTYPER::address(), 1U << 5);
+        Simulated_bus::poke(GPIOA::OSPEEDR::address(), 0x0C000000);
+        Simulated_bus::poke(GPIOA::PUPDR::address(), 0x64000000 | 0b10U << 18);
+        Simulated_bus::poke(GPIOA::AFRL::address(), 0x12345678);
+        Simulated_bus::poke(GPIOA::AFRH::address(), 0x0000FFFF);
+        Simulated_bus::poke(GPIOB::MODER::address(), 0x00000280);
+        Simulated_bus::poke(GPIOB::OSPEEDR::address(), 0x000000C0);
+        Simulated_bus::poke(GPIOB::PUPDR::address(), 0x00000100);
+    }
+
+    /// Частично заданные регистры: одно чтение-модификация-запись, незатронутые разряды сохраняются
+    void partial()
+    {
+        reset_values();
+        trace_writes<GPIOA>();
+        Partial::Configure();
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::MODER::address()), 0xA8000000 | 0b01U << 10 | 0b10U << 18 | 0b10U << 20);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::OTYPER::address()), 1U << 10);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::OSPEEDR::address()), 0x0C000000 | 0b01U << 10 | 0b11U << 18);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::PUPDR::address()), 0x64000000 | 0b01U << 4);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::AFRL::address()), 0x12345678);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::AFRH::address()), 0x0000F00F | 7U << 4 | 4U << 8);
+
+        // Не более одной записи в регистр, AFRL не затронут, MODER последний
+        CHECK(order == (std::vector<size_t>{GPIOA::OTYPER::address(), GPIOA::OSPEEDR::address(), GPIOA::PUPDR::address(),
+                                            GPIOA::AFRH::address(), GPIOA::MODER::address()}));
+        CHECK_EQUAL(Simulated_bus::reads(), 5);
+        CHECK_EQUAL(Simulated_bus::writes(), 5);
+        for (const size_t address : registers<GPIOA>)
+            CHECK(Simulated_bus::reads(address) == Simulated_bus::writes(address));
+    }
+
+    /// Полностью заданные регистры записываются без чтения
+    void full()
+    {
+        reset_values();
+        trace_writes<GPIOB>();
+        Full::Configure();
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(), 4);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOB::MODER::address()), 0x55555555);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOB::OTYPER::address()), 0);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOB::OSPEEDR::address()), 0);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOB::PUPDR::address()), 0);
+        CHECK_EQUAL(Simulated_bus::writes(GPIOB::AFRL::address()), 0);
+        CHECK_EQUAL(Simulated_bus::writes(GPIOB::AFRH::address()), 0);
+        CHECK(order == (std::vector<size_t>{GPIOB::OTYPER::address(), GPIOB::OSPEEDR::address(), GPIOB::PUPDR::address(),
+                                            GPIOB::MODER::address()}));
+    }
+
+    /// Каждый порт записывается целиком, MODER последним в своем порту
+    void ports()
+    {
+        reset_values();
+        trace_writes<GPIOA, GPIOB>();
+        Board::Configure();
+        CHECK(order == (std::vector<size_t>{GPIOB::OTYPER::address(), GPIOB::OSPEEDR::address(), GPIOB::PUPDR::address(),
+                                            GPIOB::MODER::address(),
+                                            GPIOA::OTYPER::address(), GPIOA::OSPEEDR::address(), GPIOA::PUPDR::address(),
+                                            GPIOA::AFRH::address(), GPIOA::MODER::address()}));
+        CHECK_EQUAL(Simulated_bus::peek(GPIOB::MODER::address()), 0x00000281);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOB::PUPDR::address()), 0x00000100 | 0b10U << 24);
+    }
+
+    /// Уровни выводов в модели порта после конфигурации
+    void levels()
+    {
+        Simulated_bus::clear();
+        Simulated_clock::reset();
+        Gpio_a::attach();
+        Gpio_b::attach();
+        Simulated_bus::poke(GPIOA::ODT::address(), 1U << 5);
+        Partial::Configure();
+        Full::Configure();
+        CHECK_EQUAL(Gpio_a::levels(), 1U << 2 | 1U << 5);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::IDT::address()), 1U << 2 | 1U << 5);
+        CHECK_EQUAL(Gpio_b::levels(), 0);
+        Port<GPIOB>::SetReset(0xFFFF, 0);
+        CHECK_EQUAL(Gpio_b::levels(), 0xFFFF);
+    }
+}
+
+int main()
+{
+    partial();
+    full();
+    ports();
+    levels();
+    return test::result();
+}
@@ -0,0 +1,50 @@
+#ifndef BUDGETS_HPP
+#define BUDGETS_HPP
+
+#include <cstddef>
+
+/*!
+ * \file
+ * \brief Бюджеты обращений к шине для accessbudgettest
+ *
+ * Верхние границы количества чтений и записей регистров для типовых операций.
+ * Превышение бюджета означает, что обертки перестали сворачиваться в минимальные
+ * обращения. При намеренном изменении стратегии записи бюджет меняется здесь же.
+ */
+
+namespace metaMCU::test::budget {
+
+    struct Accesses
+    {
+        size_t reads;
+        size_t writes;
+    };
+
+    /// Values::Set двух полей одного регистра: чтение-модификация-запись
+    inline constexpr Accesses values_set_modify{1, 1};
+    /// Values::Set полей, покрывающих весь регистр
+    inline constexpr Accesses values_set_full{0, 1};
+    /// Values::Set регистра только для записи
+    inline constexpr Accesses values_set_write_only{0, 1};
+    /// Values::Set регистра с теневой копией
+    inline constexpr Accesses values_set_shadow{0, 1};
+    /// Values::Set единственного однобитового поля bit-band
+    inline constexpr Accesses values_set_bit_band{0, 1};
+    /// Values::Set трех регистров: изменяемого, только для записи и с теневой копией
+    inline constexpr Accesses values_set_mixed{1, 3};
+    /// Values::IsSet двух полей одного регистра
+    inline constexpr Accesses values_is_set{1, 0};
+
+    /// Pins::Set и Pins::Reset трех выводов двух портов: одна запись BSRR на порт
+    inline constexpr Accesses pins_set{0, 2};
+    /// Pins::Toggle: чтение ODR и запись BSRR на порт
+    inline constexpr Accesses pins_toggle{2, 2};
+    /// Pins::Write: одна запись BSRR на порт
+    inline constexpr Accesses pins_write{0, 2};
+    /// Pins::SetOutput: чтение-модификация-запись MODER на порт
+    inline constexpr Accesses pins_set_output{2, 2};
+    /// PortPin::Set: одна запись BSRR
+    inline constexpr Accesses port_pin_set{0, 1};
+}
+
+#endif // BUDGETS_HPP
@@ -0,0 +1,50 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+/*!
+ * \file
+ * \brief Минимальные проверки для тестов на хосте
+ *
+ * Каждый тест - отдельная программа, main возвращает test::result().
+ * Проваленная проверка печатает выражение и место, тест продолжается.
+ */
+
+namespace metaMCU::test {
+
+    inline int failures = 0;
+
+    inline void check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (condition)
+            return;
+        ++failures;
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    }
+
+    template<typename A, typename B>
+    void check_equal(const A& actual, const B& expected, const char* expression, const char* file, int line)
+    {
+        if (std::cmp_equal(actual, expected))
+            return;
+        ++failures;
+        std::fprintf(stderr, "%s:%d: check failed: %s (actual %llu, expected %llu)\n", file, line, expression,
+                     static_cast<unsigned long long>(actual), static_cast<unsigned long long>(expected));
+    }
+
+    /// \brief Код возврата теста
+    inline int result()
+    {
+        if (failures)
+            std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+}
+
+#define CHECK(...) metaMCU::test::check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected) metaMCU::test::check_equal((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+#endif // CHECK_HPP
@@ -0,0 +1,72 @@
+#include <cstdint>
+
+#include "check.hpp"
+#include "clocktree.hpp"
+#include "field.hpp"
+#include "register.hpp"
+#include "simulatedbus.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    using PLLCFGR = core::Register<0x40023804, std::uint32_t, Read_write_t, Simulated_bus>;
+    using CFGR = core::Register<0x40023808, std::uint32_t, Read_write_t, Simulated_bus>;
+    using ACR = core::Register<0x40023C00, std::uint32_t, Read_write_t, Simulated_bus>;
+
+    /// Поля RCC и FLASH STM32F407
+    struct F407_clock_fields
+    {
+        using PLLM = core::Field<PLLCFGR, 0, 6, Read_write_t>;
+        using PLLN = core::Field<PLLCFGR, 6, 9, Read_write_t>;
+        using PLLP = core::Field<PLLCFGR, 16, 2, Read_write_t>;
+        using PLLSRC = core::Field<PLLCFGR, 22, 1, Read_write_t>;
+        using PLLQ = core::Field<PLLCFGR, 24, 4, Read_write_t>;
+        using HPRE = core::Field<CFGR, 4, 4, Read_write_t>;
+        using PPRE1 = core::Field<CFGR, 10, 3, Read_write_t>;
+        using PPRE2 = core::Field<CFGR, 13, 3, Read_write_t>;
+        using LATENCY = core::Field<ACR, 0, 3, Read_write_t>;
+    };
+
+    /// 168 МГц от кварца 8 МГц: вход PLL 2 МГц, VCO 336 МГц, USB 48 МГц
+    constexpr auto f407 = clock::solve({8'000'000, 168'000'000, 168'000'000, 42'000'000, 84'000'000, 48'000'000});
+    static_assert(f407.valid);
+    static_assert(f407.pllm == 4 && f407.plln == 168 && f407.pllp == 0 && f407.pllq == 7);
+    static_assert(f407.sysclk == 168'000'000 && f407.ahb == 168'000'000 && f407.usb == 48'000'000);
+    static_assert(f407.latency == 5);
+    static_assert(f407.hpre == 0b0000);
+    static_assert(f407.ppre1 == 0b101 && f407.apb1 == 42'000'000);
+    static_assert(f407.ppre2 == 0b100 && f407.apb2 == 84'000'000);
+
+    /// Частоты, не заданные в запросе, ограничены только микроконтроллером
+    constexpr auto defaults = clock::solve({.hse = 8'000'000, .usb = 48'000'000});
+    static_assert(defaults.valid);
+    static_assert(defaults.sysclk == f407.sysclk && defaults.ahb == f407.ahb);
+    static_assert(defaults.ppre1 == f407.ppre1 && defaults.ppre2 == f407.ppre2 && defaults.latency == f407.latency);
+
+    /// От HSI без USB, шины ниже максимальных
+    constexpr auto hsi = clock::solve({.sysclk = 100'000'000, .apb1 = 25'000'000, .apb2 = 50'000'000});
+    static_assert(hsi.valid && hsi.sysclk == 100'000'000 && hsi.latency == 3);
+    static_assert(hsi.apb1 == 25'000'000 && hsi.apb2 == 50'000'000);
+
+    /// Частота ядра ниже минимальной на выходе PLL (VCO 100 МГц / 8)
+    static_assert(!clock::solve({.hse = 8'000'000, .sysclk = 12'000'000}).valid);
+
+    void values_are_written()
+    {
+        using Clocks = clock::Clock_tree<F407_clock_fields, clock::Clock_request{8'000'000, 168'000'000, 168'000'000,
+                                                                                  42'000'000, 84'000'000, 48'000'000}>;
+        Simulated_bus::clear();
+        Clocks::Values_t::Set();
+        CHECK_EQUAL(Simulated_bus::peek(PLLCFGR::address()), 0x07402A04);
+        CHECK_EQUAL(Simulated_bus::peek(CFGR::address()), 0x9400);
+        CHECK_EQUAL(Simulated_bus::peek(ACR::address()), 5);
+        CHECK(Clocks::Values_t::IsSet());
+    }
+}
+
+int main()
+{
+    values_are_written();
+    return test::result();
+}
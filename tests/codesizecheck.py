@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Проверка кода, сгенерированного для типовых операций, по бюджетам.
+
+Собирает tests/codesnippets.cpp компилятором arm-none-eabi-g++ для Cortex-M3
+с каждым уровнем оптимизации из бюджетов, дизассемблирует объектный файл
+и для каждой функции считает загрузки (ldr, ldm, pop), сохранения (str, stm, push),
+переходы (b, bl, bx, cbz, ...) и размер в байтах, включая литералы.
+Завершается с ошибкой, если хотя бы одно значение превышает бюджет
+из tests/data/codebudgets.json. Метрики из списка "provisional" еще не измерялись
+на целевом компиляторе: их превышение выводится как WARN и не считается ошибкой,
+--update записывает измеренные значения и снимает пометку.
+
+Использование:
+    codesizecheck.py --compiler arm-none-eabi-g++ --objdump arm-none-eabi-objdump -I core -I utils
+    codesizecheck.py ... --update    # записать измеренные значения как новые бюджеты
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SOURCE = os.path.join(HERE, "codesnippets.cpp")
+BUDGETS = os.path.join(HERE, "data", "codebudgets.json")
+
+FLAGS = ["-std=c++23", "-mcpu=cortex-m3", "-mthumb", "-ffunction-sections", "-fno-exceptions", "-fno-rtti"]
+METRICS = ("loads", "stores", "branches", "bytes")
+
+FUNCTION = re.compile(r"^[0-9a-f]+ <([A-Za-z_][A-Za-z0-9_]*)>:$")
+# Строка objdump -d --no-show-raw-insn: "адрес:<TAB>мнемоника<TAB>операнды"
+INSTRUCTION = re.compile(r"^\s*([0-9a-f]+):\t([^\t\s]+)(?:\t(.*))?$")
+CONDITIONS = "eq|ne|cs|hs|cc|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le|al"
+BRANCH = re.compile(r"^(b|bl|blx|bx|cbz|cbnz|tbb|tbh)(%s)?(\.[nw])?$" % CONDITIONS)
+
+
+def classify(mnemonic, operands):
+    """Возвращает метрику инструкции или None."""
+    if mnemonic.startswith(".") or mnemonic.startswith("udf"):
+        return None
+    base = mnemonic.split(".")[0]
+    if BRANCH.match(mnemonic) or (base == "pop" and "pc" in operands):
+        return "branches"
+    if base.startswith("ldr") or base.startswith("ldm") or base == "pop":
+        return "loads"
+    if base.startswith("str") or base.startswith("stm") or base == "push":
+        return "stores"
+    return None
+
+
+def parse(disassembly):
+    """Разбирает вывод objdump -d, возвращает {функция: {метрика: значение}}."""
+    result = {}
+    current = None
+    for line in disassembly.splitlines():
+        match = FUNCTION.match(line.strip())
+        if match:
+            current = result.setdefault(match.group(1), dict.fromkeys(METRICS, 0))
+            continue
+        match = INSTRUCTION.match(line)
+        if current is None or not match:
+            continue
+        metric = classify(match.group(2), match.group(3) or "")
+        if metric:
+            current[metric] += 1
+    return result
+
+
+def function_sizes(objdump, path):
+    """Размеры функций по таблице символов."""
+    output = subprocess.run([objdump, "-t", path], check=True, capture_output=True, text=True).stdout
+    sizes = {}
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) >= 6 and "F" in fields[1:3]:
+            sizes[fields[-1]] = int(fields[-2], 16)
+    return sizes
+
+
+def measure(compiler, objdump, includes, level):
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, "codesnippets.o")
+        command = [compiler, level, "-c", SOURCE, "-o", path] + FLAGS + ["-I" + i for i in includes]
+        subprocess.run(command, check=True)
+        disassembly = subprocess.run([objdump, "-d", "--no-show-raw-insn", path], check=True, capture_output=True, text=True).stdout
+        result = parse(disassembly)
+        # Размер берется из таблицы символов: в него входят литералы (.word)
+        for name, size in function_sizes(objdump, path).items():
+            if name in result:
+                result[name]["bytes"] = size
+        return result
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--compiler", default="arm-none-eabi-g++")
+    parser.add_argument("--objdump", default="arm-none-eabi-objdump")
+    parser.add_argument("-I", dest="includes", action="append", default=[])
+    parser.add_argument("--budgets", default=BUDGETS)
+    parser.add_argument("--update", action="store_true", help="write measured values as budgets")
+    args = parser.parse_args(argv)
+
+    with open(args.budgets, encoding="utf-8") as file:
+        budgets = json.load(file)
+
+    provisional = set(budgets.pop("provisional", []))
+    failed = False
+    measured_all = {}
+    for level, functions in budgets.items():
+        measured = measure(args.compiler, args.objdump, args.includes, level)
+        measured_all[level] = {}
+        for name, budget in functions.items():
+            if name not in measured:
+                print("FAIL %s %s: function not found" % (level, name))
+                failed = True
+                continue
+            actual = measured[name]
+            measured_all[level][name] = actual
+            over = [m for m in METRICS if actual[m] > budget[m] and m not in provisional]
+            warn = [m for m in METRICS if actual[m] > budget[m] and m in provisional]
+            print("%-4s %-24s %s" % (level, name, "  ".join("%s %d/%d" % (m, actual[m], budget[m]) for m in METRICS))
+                  + ("  FAIL" if over else "") + ("  WARN %s (provisional)" % ", ".join(warn) if warn else ""))
+            failed = failed or bool(over)
+
+    if args.update:
+        with open(args.budgets, "w", encoding="utf-8") as file:
+            json.dump(measured_all, file, indent=4)
+            file.write("\n")
+        return 0
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
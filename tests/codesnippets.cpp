@@ -0,0 +1,94 @@
+#include <cstdint>
+
+#include "cortexM3.hpp"
+#include "fields.hpp"
+#include "port.hpp"
+
+/*!
+ * \file
+ * \brief Типовые операции для проверки сгенерированного кода (codesizecheck.py)
+ *
+ * Собирается arm-none-eabi-g++ для Cortex-M3, каждая операция - отдельная
+ * функция с C-связыванием, чтобы ее можно было найти в дизассемблере.
+ */
+
+using namespace metaMCU;
+
+namespace {
+    using CR = CortexM3::Register<0x40010000, std::uint32_t, Read_write_t>;
+    using DR = core::Register<0x40010004, std::uint32_t, Write_only_t>;
+
+    using EN = CortexM3::Field<CR, 0, 1, Read_write_t>;
+    using MODE = core::Field<CR, 4, 3, Read_write_t>;
+    using HIGH = core::Field<CR, 8, 24, Read_write_t>;
+    using LOW = core::Field<CR, 0, 8, Read_write_t>;
+    using DATA = core::Field<DR, 0, 16, Write_only_t>;
+
+    template<size_t Base>
+    struct Gpio
+    {
+        using MODER = core::Register<Base + 0x00, std::uint32_t, Read_write_t>;
+        using IDT = core::Register<Base + 0x10, std::uint32_t, Read_only_t>;
+        using ODT = core::Register<Base + 0x14, std::uint32_t, Read_write_t>;
+        using SCR = core::Register<Base + 0x18, std::uint32_t, Write_only_t>;
+    };
+
+    using GPIOA = Gpio<0x40020000>;
+    using GPIOB = Gpio<0x40020400>;
+    using Leds = Pins<PortPin<GPIOA, 1>, PortPin<GPIOA, 5>, PortPin<GPIOB, 3>>;
+}
+
+extern "C" {
+    void values_set_modify()
+    {
+        Values<core::Field_value<EN, 1>, core::Field_value<MODE, 5>>::Set();
+    }
+
+    void values_set_full()
+    {
+        Values<core::Field_value<HIGH, 0xABCDEF>, core::Field_value<LOW, 0x12>>::Set();
+    }
+
+    void values_set_write_only()
+    {
+        Values<core::Field_value<DATA, 0x1234>>::Set();
+    }
+
+    void values_set_bit_band()
+    {
+        Values<core::Field_value<EN, 1>>::Set();
+    }
+
+    bool values_is_set()
+    {
+        return Values<core::Field_value<EN, 1>, core::Field_value<MODE, 5>>::IsSet();
+    }
+
+    void pins_set()
+    {
+        Leds::Set();
+    }
+
+    /// Те же выводы, что и pins_set, по одному: для сравнения с группой
+    void pins_set_per_pin()
+    {
+        PortPin<GPIOA, 1>::Set();
+        PortPin<GPIOA, 5>::Set();
+        PortPin<GPIOB, 3>::Set();
+    }
+
+    void pins_toggle()
+    {
+        Leds::Toggle();
+    }
+
+    void pins_set_output()
+    {
+        Leds::SetOutput();
+    }
+
+    void port_pin_set()
+    {
+        PortPin<GPIOA, 7>::Set();
+    }
+}
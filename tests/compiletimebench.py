@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Бенчмарк времени компиляции Values на синтетических наборах значений полей.
+
+Для каждого размера генерируется файл с Values<...>::Set() над N однобитовыми
+полями (по 32 поля на регистр, то есть N/32 регистров) и компилируется с -O2.
+Печатаются время и пиковая память компилятора. Бенчмарк завершается с ошибкой,
+если время для наибольшего набора превышает --max-seconds или если при удвоении
+размера набора время растет больше чем в --max-ratio раз (рост должен быть
+близким к линейному).
+
+Использование:
+    compiletimebench.py --compiler g++ -I core -I utils [--sizes 10 100 500 1000 2000]
+
+Регистрируется в CTest как compiletimebench.
+"""
+
+import argparse
+import math
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+FIELDS_PER_REGISTER = 32
+
+
+def source(size):
+    registers = (size + FIELDS_PER_REGISTER - 1) // FIELDS_PER_REGISTER
+    out = ['#include <cstdint>\n#include "field.hpp"\n#include "fields.hpp"\n\nusing namespace metaMCU;\n\n']
+    for r in range(registers):
+        out.append("using R%d = core::Register<0x%08X, std::uint32_t, Read_write_t>;\n" % (r, 0x40000000 + 4 * r))
+    for i in range(size):
+        out.append("using V%d = core::Field_value<core::Field<R%d, %d, 1, Read_write_t>, 1>;\n"
+                   % (i, i // FIELDS_PER_REGISTER, i % FIELDS_PER_REGISTER))
+    values = ", ".join("V%d" % i for i in range(size))
+    out.append("\nvoid init()\n{\n    Values<%s>::Set();\n}\n" % values)
+    return "".join(out)
+
+
+def compile_once(compiler, includes, path):
+    """Компилирует файл, возвращает (секунды, пиковая память в МБ)."""
+    command = [compiler, "-std=c++23", "-O2", "-c", path, "-o", os.devnull] + ["-I" + i for i in includes]
+    # Вывод компилятора пишется в файл: ошибки для больших пакетов переполняют канал до завершения wait4
+    with tempfile.TemporaryFile() as errors:
+        start = time.perf_counter()
+        process = subprocess.Popen(command, stderr=errors)
+        _, status, usage = os.wait4(process.pid, 0)
+        elapsed = time.perf_counter() - start
+        process.returncode = os.waitstatus_to_exitcode(status)
+        if process.returncode != 0:
+            errors.seek(0)
+            raise RuntimeError("compilation failed:\n" + errors.read(4000).decode(errors="replace"))
+    return elapsed, usage.ru_maxrss / 1024
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "g++"))
+    parser.add_argument("-I", dest="includes", action="append", default=[])
+    parser.add_argument("--sizes", nargs="+", type=int, default=[10, 100, 500, 1000, 2000])
+    parser.add_argument("--max-seconds", type=float, default=20.0, help="budget for the largest set")
+    parser.add_argument("--max-ratio", type=float, default=2.8, help="allowed time growth when the set size doubles")
+    args = parser.parse_args(argv)
+
+    results = []
+    with tempfile.TemporaryDirectory() as directory:
+        for size in sorted(args.sizes):
+            path = os.path.join(directory, "values%d.cpp" % size)
+            with open(path, "w", encoding="utf-8") as file:
+                file.write(source(size))
+            seconds, memory = compile_once(args.compiler, args.includes, path)
+            results.append((size, seconds, memory))
+            print("%5d values: %7.2f s %8.1f MB" % (size, seconds, memory), flush=True)
+
+    failed = False
+    size, seconds, _ = results[-1]
+    if seconds > args.max_seconds:
+        print("FAIL: %d values took %.2f s, budget %.2f s" % (size, seconds, args.max_seconds))
+        failed = True
+
+    # Рост времени, приведенный к удвоению размера, между соседними размерами от 500 значений
+    # (на малых наборах время определяется разбором заголовков)
+    large = [r for r in results if r[0] >= 500]
+    for (n0, t0, _), (n1, t1, _) in zip(large, large[1:]):
+        ratio = (t1 / t0) ** (1 / math.log2(n1 / n0))
+        if ratio > args.max_ratio:
+            print("FAIL: %d -> %d values: time grows %.2fx per doubling, limit %.2fx" % (n0, n1, ratio, args.max_ratio))
+            failed = True
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
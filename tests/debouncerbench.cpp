@@ -0,0 +1,129 @@
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "bench.hpp"
+#include "check.hpp"
+#include "debouncer.hpp"
+#include "port.hpp"
+#include "simulatedbus.hpp"
+#include "simulatedgpio.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    constexpr size_t samples = 1'000'000;
+    constexpr size_t Samples = 4;
+
+    /// Входы 0 ... N - 1: по 16 на порт, порты подряд начиная с GPIOA
+    template<size_t... I>
+    auto make_debouncer(std::index_sequence<I...>)
+        -> core::Debouncer<Samples, PortPin<core::Simulated_port<0x40020000 + 0x400 * (I / 16)>, I % 16>...>;
+
+    template<size_t Inputs>
+    using Debouncer = decltype(make_debouncer(std::make_index_sequence<Inputs>()));
+
+    /// Последовательность отсчетов: входы переключаются с дребезгом разной длины
+    template<typename D, size_t Inputs>
+    std::vector<typename D::Words> make_trace(size_t length)
+    {
+        constexpr std::uint32_t used = Inputs >= 32 ? 0xFFFFFFFF : (1U << Inputs) - 1;
+        std::vector<typename D::Words> trace(length);
+        std::uint32_t random = 12345;
+        typename D::Words stable{};
+        for (size_t i = 0; i < length; ++i)
+        {
+            for (size_t w = 0; w < D::words; ++w)
+            {
+                random = random * 1664525U + 1013904223U;
+                if (i % 64 == 0)
+                    stable[w] ^= random;
+                random = random * 1664525U + 1013904223U;
+                // Дребезг в первой четверти каждого отрезка
+                trace[i][w] = (i % 64 < 16 ? stable[w] ^ (random & (random >> 7)) : stable[w]) & used;
+            }
+        }
+        return trace;
+    }
+
+    /// Счетчик на каждый вход: то, что заменяет вертикальный счетчик
+    template<size_t Inputs>
+    struct Per_pin
+    {
+        std::array<std::uint8_t, Inputs> counters{};
+        std::array<bool, Inputs> state{};
+
+        template<typename Words>
+        void update(const Words& raw)
+        {
+            for (size_t i = 0; i < Inputs; ++i)
+            {
+                const bool level = raw[i / 32] >> (i % 32) & 1U;
+                if (level == state[i])
+                    counters[i] = 0;
+                else if (++counters[i] == Samples)
+                {
+                    state[i] = level;
+                    counters[i] = 0;
+                }
+            }
+        }
+    };
+
+    /// Время одного отсчета: только обработка и с чтением IDR через Simulated_bus
+    template<size_t Inputs>
+    void cost_per_sample()
+    {
+        using D = Debouncer<Inputs>;
+        static_assert(D::words == (Inputs + 31) / 32);
+        const auto trace = make_trace<D, Inputs>(1024);
+
+        D debouncer;
+        debouncer.prime();
+        std::uint32_t edges = 0;
+        char name[64];
+        std::snprintf(name, sizeof(name), "%zu inputs, vertical counter", Inputs);
+        test::benchmark(name, samples, [&]
+        {
+            for (size_t i = 0; i < samples; ++i)
+            {
+                debouncer.update(trace[i % trace.size()]);
+                edges += debouncer.rising()[0];
+            }
+        });
+        test::keep(edges);
+
+        Per_pin<Inputs> reference;
+        std::snprintf(name, sizeof(name), "%zu inputs, per-pin counters", Inputs);
+        test::benchmark(name, samples, [&]
+        {
+            for (size_t i = 0; i < samples; ++i)
+                reference.update(trace[i % trace.size()]);
+        });
+        // Обе реализации приходят к одним уровням
+        for (size_t i = 0; i < Inputs; ++i)
+            CHECK((debouncer.levels()[i / 32] >> (i % 32) & 1U) == reference.state[i]);
+
+        Simulated_bus::clear();
+        std::snprintf(name, sizeof(name), "%zu inputs, sample() on Simulated_bus", Inputs);
+        Simulated_bus::reset_counters();
+        test::benchmark(name, samples / 10, [&]
+        {
+            for (size_t i = 0; i < samples / 10; ++i)
+                debouncer.sample();
+        });
+        CHECK_EQUAL(Simulated_bus::reads(), samples / 10 * ((Inputs + 15) / 16));
+    }
+}
+
+int main()
+{
+    std::printf("ns/op is per sample of all inputs\n");
+    cost_per_sample<16>();
+    cost_per_sample<64>();
+    cost_per_sample<256>();
+    return test::result();
+}
@@ -0,0 +1,140 @@
+#include <cstdint>
+
+#include "check.hpp"
+#include "debouncer.hpp"
+#include "port.hpp"
+#include "simulatedbus.hpp"
+#include "simulatedgpio.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    using GPIOA = core::Simulated_port<0x40020000>;
+    using GPIOB = core::Simulated_port<0x40020400>;
+    using GPIOC = core::Simulated_port<0x40020800>;
+
+    using Key = PortPin<GPIOA, 0>;
+    using Door = PortPin<GPIOB, 7>;
+    using Limit = PortPin<GPIOC, 13>;
+
+    template<size_t Samples>
+    using Inputs = core::Debouncer<Samples, Key, Door, Limit>;
+
+    // Третий порт - во втором слове, второй - в старшей половине первого
+    static_assert(Inputs<4>::words == 2 && Inputs<4>::counter_bits == 2);
+    static_assert(Inputs<4>::location<Key>.word == 0 && Inputs<4>::location<Key>.mask == 1U << 0);
+    static_assert(Inputs<4>::location<Door>.word == 0 && Inputs<4>::location<Door>.mask == 1U << 23);
+    static_assert(Inputs<4>::location<Limit>.word == 1 && Inputs<4>::location<Limit>.mask == 1U << 13);
+    static_assert(Inputs<4>::mask<Key, Door>()[0] == (1U << 0 | 1U << 23));
+
+    void drive(bool key, bool door, bool limit)
+    {
+        Simulated_bus::poke(GPIOA::IDT::address(), key ? 1U << 0 : 0);
+        Simulated_bus::poke(GPIOB::IDT::address(), door ? 1U << 7 : 0);
+        Simulated_bus::poke(GPIOC::IDT::address(), limit ? 1U << 13 : 0);
+    }
+
+    /// Состояние меняется ровно на Samples-м подряд отличающемся отсчете, фронт - на одном отсчете
+    template<size_t Samples>
+    void edge_after_samples()
+    {
+        Simulated_bus::clear();
+        Inputs<Samples> inputs;
+        drive(false, true, false);
+        inputs.prime();
+        CHECK(!inputs.template level<Key>());
+        CHECK(inputs.template level<Door>());
+
+        drive(true, false, true);
+        for (size_t i = 1; i < Samples; ++i)
+        {
+            inputs.sample();
+            CHECK(!inputs.template level<Key>());
+            CHECK(!inputs.template rose<Key>());
+            CHECK(inputs.template level<Door>());
+        }
+        inputs.sample();
+        CHECK(inputs.template level<Key>() && inputs.template rose<Key>() && !inputs.template fell<Key>());
+        CHECK(inputs.template level<Limit>() && inputs.template rose<Limit>());
+        CHECK(!inputs.template level<Door>() && inputs.template fell<Door>() && !inputs.template rose<Door>());
+
+        // Фронт отмечается только одним отсчетом
+        inputs.sample();
+        CHECK(inputs.template level<Key>() && !inputs.template rose<Key>());
+        CHECK(!inputs.template fell<Door>());
+        CHECK_EQUAL(inputs.rising()[0], 0);
+        CHECK_EQUAL(inputs.falling()[0], 0);
+    }
+
+    /// Дребезг короче Samples отсчетов не меняет состояние, совпадающий отсчет сбрасывает счет
+    template<size_t Samples>
+    void glitches()
+    {
+        Simulated_bus::clear();
+        Inputs<Samples> inputs;
+        drive(false, false, false);
+        inputs.prime();
+        for (int burst = 0; burst < 3; ++burst)
+        {
+            drive(true, true, true);
+            for (size_t i = 1; i < Samples; ++i)
+                inputs.sample();
+            drive(false, false, false);
+            inputs.sample();
+            CHECK_EQUAL(inputs.levels()[0], 0);
+            CHECK_EQUAL(inputs.levels()[1], 0);
+            CHECK_EQUAL(inputs.rising()[0] | inputs.rising()[1], 0);
+        }
+
+        // После сброса счет начинается заново
+        drive(true, false, false);
+        for (size_t i = 1; i < Samples; ++i)
+            inputs.sample();
+        CHECK(!inputs.template level<Key>());
+        inputs.sample();
+        CHECK(inputs.template rose<Key>());
+    }
+
+    /// Неустойчивый вход не влияет на соседние разряды того же слова
+    void independent_inputs()
+    {
+        Simulated_bus::clear();
+        Inputs<2> inputs;
+        drive(false, false, false);
+        inputs.prime();
+        for (int i = 0; i < 8; ++i)
+        {
+            drive(i % 2 == 0, true, false);
+            inputs.sample();
+            CHECK(!inputs.level<Key>());
+            CHECK((inputs.fell<Door>() || inputs.rose<Door>()) == (i == 1));
+        }
+        CHECK(inputs.level<Door>());
+    }
+
+    /// Один отсчет - одно чтение IDR на порт
+    void reads_per_sample()
+    {
+        Simulated_bus::clear();
+        Inputs<4> inputs;
+        Simulated_bus::reset_counters();
+        inputs.sample();
+        CHECK_EQUAL(Simulated_bus::reads(), 3);
+        CHECK_EQUAL(Simulated_bus::writes(), 0);
+    }
+}
+
+int main()
+{
+    edge_after_samples<2>();
+    edge_after_samples<4>();
+    edge_after_samples<8>();
+    edge_after_samples<16>();
+    glitches<2>();
+    glitches<4>();
+    glitches<16>();
+    independent_inputs();
+    reads_per_sample();
+    return test::result();
+}
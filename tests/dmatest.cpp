@@ -0,0 +1,165 @@
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "check.hpp"
+#include "dma.hpp"
+#include "field.hpp"
+#include "register.hpp"
+#include "simulatedbus.hpp"
+#include "simulateddma.hpp"
+#include "spi.hpp"
+#include "uart.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    using DMA2 = dma::Controller<2, 0x40026400, Simulated_bus>;
+    using Dma_model = dma::Simulated_dma<DMA2>;
+
+    struct Usart1
+    {
+        using DR = core::Register<0x40011004, std::uint32_t, Read_write_t, Simulated_bus>;
+        using CR3 = core::Register<0x40011014, std::uint32_t, Read_write_t, Simulated_bus>;
+        using DMAR = core::Field<CR3, 6, 1, Read_write_t>;
+        using DMAT = core::Field<CR3, 7, 1, Read_write_t>;
+        using Tx_routes = meta_utils::TypeContainer<dma::Route<2, 7, 4>>;
+        using Rx_routes = meta_utils::TypeContainer<dma::Route<2, 2, 4>, dma::Route<2, 5, 4>>;
+    };
+
+    struct Spi1
+    {
+        using DR = core::Register<0x4001300C, std::uint32_t, Read_write_t, Simulated_bus>;
+        using CR2 = core::Register<0x40013004, std::uint32_t, Read_write_t, Simulated_bus>;
+        using RXDMAEN = core::Field<CR2, 0, 1, Read_write_t>;
+        using TXDMAEN = core::Field<CR2, 1, 1, Read_write_t>;
+        using Tx_routes = meta_utils::TypeContainer<dma::Route<2, 3, 3>, dma::Route<2, 5, 3>>;
+        using Rx_routes = meta_utils::TypeContainer<dma::Route<2, 0, 3>, dma::Route<2, 2, 3>>;
+    };
+
+    using Uart_tx = dma::Stream<DMA2, 7>;
+    using Uart_rx = dma::Stream<DMA2, 5>;
+    using Spi_tx = dma::Stream<DMA2, 3>;
+    using Spi_rx = dma::Stream<DMA2, 0>;
+
+    using Uart1 = Uart<Usart1, Uart_tx, Uart_rx>;
+    using Spi_1 = Spi<Spi1, Spi_tx, Spi_rx>;
+
+    static_assert(!dma::Connected<Uart_tx, Usart1::Rx_routes>);
+
+    std::string_view text(std::span<const std::uint8_t> span)
+    {
+        return {reinterpret_cast<const char*>(span.data()), span.size()};
+    }
+
+    void uart_transmit()
+    {
+        Simulated_bus::clear();
+        Dma_model::attach();
+
+        static constexpr std::array<std::uint8_t, 5> hello = {'h', 'e', 'l', 'l', 'o'};
+        CHECK(Uart1::transmit(hello));
+        CHECK(Uart1::transmitting());
+        CHECK(!Uart1::transmit(hello));
+        CHECK(core::Field_value<Usart1::DMAT, 1>::is_set());
+        CHECK_EQUAL(Simulated_bus::peek(Uart_tx::PAR::address()), Usart1::DR::address());
+
+        std::vector<std::uint8_t> line;
+        CHECK_EQUAL(Dma_model::run<Uart_tx>(10, [&line](std::uint32_t value) { line.push_back(static_cast<std::uint8_t>(value)); return 0U; }), 5);
+        CHECK(text(line) == "hello");
+        CHECK(!Uart1::transmitting());
+        CHECK(Simulated_bus::peek(Uart_tx::ISR::address()) & Uart_tx::tc_flag);
+        CHECK(Uart1::handle_tx_interrupt());
+        CHECK_EQUAL(Simulated_bus::peek(Uart_tx::ISR::address()) & Uart_tx::all_flags, 0);
+    }
+
+    void uart_receive()
+    {
+        Simulated_bus::clear();
+        Dma_model::attach();
+
+        // До start_receive кольцевого буфера нет
+        CHECK(Uart1::received().empty());
+        Uart1::consume(1);
+
+        static std::array<std::uint8_t, 8> ring{};
+        Uart1::start_receive(ring);
+        CHECK(Uart1::received().empty());
+
+        char next = 'a';
+        const auto line = [&next](std::uint32_t) { return static_cast<std::uint32_t>(next++); };
+        size_t halves = 0, fulls = 0;
+        const auto interrupt = [&] { Uart1::handle_rx_interrupt([&halves] { ++halves; }, [&fulls] { ++fulls; }); };
+
+        Dma_model::run<Uart_rx>(5, line);
+        CHECK(text(Uart1::received()) == "abcde");
+        interrupt();
+        CHECK_EQUAL(halves, 1);
+        Uart1::consume(5);
+
+        // Данные переходят через конец буфера: сначала участок до конца, затем начало
+        Dma_model::run<Uart_rx>(5, line);
+        interrupt();
+        CHECK_EQUAL(fulls, 1);
+        CHECK(text(Uart1::received()) == "fgh");
+        Uart1::consume(3);
+        CHECK(text(Uart1::received()) == "ij");
+        Uart1::consume(2);
+        CHECK(Uart1::received().empty());
+        CHECK(Uart_rx::busy());
+
+        Uart1::stop_receive();
+        CHECK(!Uart_rx::busy());
+        CHECK(!core::Field_value<Usart1::DMAR, 1>::is_set());
+    }
+
+    /// Прием включается раньше передачи, обмен завершается по окончании приема
+    void spi_transfer()
+    {
+        Simulated_bus::clear();
+        Dma_model::attach();
+
+        std::vector<size_t> enabled;
+        for (const auto stream : {Spi_tx::number, Spi_rx::number})
+            Simulated_bus::on_write(DMA2::base + 0x10 + 0x18 * stream, [stream, &enabled](std::uint32_t cr)
+            {
+                if (cr & 1U)
+                    enabled.push_back(stream);
+            });
+
+        static constexpr std::array<std::uint8_t, 4> tx = {0x01, 0x02, 0x03, 0x04};
+        static std::array<std::uint8_t, 4> rx{};
+        static std::array<std::uint8_t, 3> short_rx{};
+        CHECK(!Spi_1::transfer(tx, short_rx));
+        CHECK(Spi_1::transfer(tx, rx));
+        CHECK(!Spi_1::transfer(tx, rx));
+        CHECK(enabled == (std::vector<size_t>{Spi_rx::number, Spi_tx::number}));
+        CHECK(core::Field_value<Spi1::RXDMAEN, 1>::is_set() && core::Field_value<Spi1::TXDMAEN, 1>::is_set());
+
+        // Модель ведомого: отвечает инверсией принятого байта
+        std::uint32_t shift = 0;
+        for (size_t i = 0; i < tx.size(); ++i)
+        {
+            Dma_model::run<Spi_tx>(1, [&shift](std::uint32_t value) { shift = value; return 0U; });
+            CHECK(Spi_1::busy());
+            Dma_model::run<Spi_rx>(1, [&shift](std::uint32_t) { return ~shift & 0xFF; });
+        }
+        CHECK(!Spi_1::busy());
+        CHECK(rx == (std::array<std::uint8_t, 4>{0xFE, 0xFD, 0xFC, 0xFB}));
+
+        bool done = false;
+        CHECK(Spi_1::handle_rx_interrupt([&done] { done = true; }));
+        CHECK(done);
+        CHECK(Spi_1::handle_tx_interrupt());
+    }
+}
+
+int main()
+{
+    uart_transmit();
+    uart_receive();
+    spi_transfer();
+    return test::result();
+}
@@ -0,0 +1,52 @@
+#include <cstdint>
+
+#include "check.hpp"
+#include "fields.hpp"
+#include "sample.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+namespace GPIOA = metaMCU::SAMPLE::GPIOA;
+namespace TIM2 = metaMCU::SAMPLE::TIM2;
+
+namespace {
+    static_assert(GPIOA::MODER::Register::address() == 0x40020000);
+    static_assert(GPIOA::MODER::reset_value == 0xA8000000);
+    static_assert(SAMPLE::GPIOB::MODER::Register::address() == 0x40020400);
+    static_assert(TIM2::CH1_CCR::Register::address() == 0x40000038);
+    static_assert(std::is_same_v<TIM2::CR1::Register::Value_t, std::uint16_t>);
+    static_assert(GPIOA::MODER::MODER15::bit_offset() == 30 && GPIOA::MODER::MODER15::size() == 2);
+    static_assert(Hardware_modified_bits<TIM2::SR::Register::address()>::value == 0x1);
+    static_assert(!Can_shadow<TIM2::SR::Register::address(), Read_write_t>);
+    static_assert(GPIOA::MODER::Register::read_accesses == 0, "GPIOA.MODER is generated with --shadow");
+
+    static_assert(GPIOA::fields.size() == 34);
+    static_assert(GPIOA::fields[33].name == "BR0" && GPIOA::fields[33].offset == 16);
+    static_assert(GPIOA::fields[16].access == core::Field_access::read_only);
+
+    /// Теневая копия MODER начинается со значения сброса из SVD
+    void shadow_reset_value()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(GPIOA::MODER::Register::address(), GPIOA::MODER::reset_value);
+        Values<GPIOA::MODER::MODER5::Output>::Set();
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::MODER::Register::address()), 0xA8000400);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+    }
+
+    void generated_fields()
+    {
+        Simulated_bus::clear();
+        Values<core::Field_value<TIM2::CR1::CEN, 1>, core::Field_value<GPIOA::BSRR::BS0, 1>>::Set();
+        CHECK_EQUAL(Simulated_bus::peek(TIM2::CR1::Register::address()), 1);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::BSRR::Register::address()), 1);
+        CHECK_EQUAL(Simulated_bus::reads(GPIOA::BSRR::Register::address()), 0);
+    }
+}
+
+int main()
+{
+    shadow_reset_value();
+    generated_fields();
+    return test::result();
+}
@@ -0,0 +1,144 @@
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "check.hpp"
+#include "port.hpp"
+#include "simulatedbus.hpp"
+#include "simulatedgpio.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+using core::Simulated_clock;
+
+namespace {
+    using GPIOA = core::Simulated_port<0x40020000>;
+    using GPIOB = core::Simulated_port<0x40020400>;
+    using Gpio_a = core::Simulated_gpio<GPIOA>;
+    using Gpio_b = core::Simulated_gpio<GPIOB>;
+
+    void attach()
+    {
+        Simulated_bus::clear();
+        Simulated_clock::reset();
+        Gpio_a::attach();
+        Gpio_b::attach();
+    }
+
+    void output_modes()
+    {
+        attach();
+        using Led = PortPin<GPIOA, 5>;
+        Led::SetOutput();
+        Led::Set();
+        CHECK_EQUAL(Gpio_a::levels(), 1U << 5);
+        CHECK(Led::GetInput());
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::SCR::address()), 0);
+
+        // Одновременная установка и сброс: приоритет у установки
+        Port<GPIOA>::SetReset(1U << 6, 1U << 6);
+        CHECK_EQUAL(Simulated_bus::peek(GPIOA::ODT::address()), 1U << 5 | 1U << 6);
+
+        // Открытый сток: единица отпускает линию, уровень задает внешняя схема
+        GPIOA::OTYPER::write(1U << 5);
+        CHECK_EQUAL(Gpio_a::levels() & (1U << 5), 0);
+        Gpio_a::drive(1U << 5, 1U << 5);
+        CHECK_EQUAL(Gpio_a::levels() & (1U << 5), 1U << 5);
+        Led::Reset();
+        CHECK_EQUAL(Gpio_a::levels() & (1U << 5), 0);
+    }
+
+    void input_modes()
+    {
+        attach();
+        using Button = PortPin<GPIOB, 3>;
+        using Sensor = PortPin<GPIOB, 4>;
+        Button::SetInput();
+        CHECK(!Button::GetInput());
+        GPIOB::PUPDR::write(0b01U << 6);
+        CHECK(Button::GetInput());
+        Gpio_b::drive(1U << 3, 0);
+        CHECK(!Button::GetInput());
+        Gpio_b::release(1U << 3);
+        CHECK(Button::GetInput());
+
+        // Аналоговый вход читается нулем при любом внешнем уровне
+        Sensor::SetAnalog();
+        Gpio_b::drive(1U << 4, 1U << 4);
+        CHECK_EQUAL(Gpio_b::levels() & (1U << 4), 1U << 4);
+        CHECK(!Sensor::GetInput());
+    }
+
+    template<typename... Ps>
+    void per_pin_set()
+    {
+        (Ps::Set(), ...);
+    }
+
+    /// Группа выводов: одна запись на порт и одно изменение уровней без промежуточных состояний
+    void batched_vs_per_pin()
+    {
+        using A1 = PortPin<GPIOA, 1>;
+        using A2 = PortPin<GPIOA, 2>;
+        using A7 = PortPin<GPIOA, 7>;
+        using A9 = PortPin<GPIOA, 9>;
+        using B0 = PortPin<GPIOB, 0>;
+        using B8 = PortPin<GPIOB, 8>;
+        using Group = Pins<A1, A2, A7, A9, B0, B8>;
+        constexpr std::uint16_t a = 1U << 1 | 1U << 2 | 1U << 7 | 1U << 9;
+        constexpr std::uint16_t b = 1U << 0 | 1U << 8;
+
+        attach();
+        Group::SetOutput();
+        Simulated_bus::reset_counters();
+        const auto a_changes = Gpio_a::changes().size();
+        Simulated_clock::advance(10);
+        Group::Set();
+        CHECK_EQUAL(Simulated_bus::writes(), Group::PortsCount());
+        CHECK_EQUAL(Gpio_a::changes().size() - a_changes, 1);
+        CHECK_EQUAL(Gpio_a::levels(), a);
+        CHECK_EQUAL(Gpio_b::levels(), b);
+
+        attach();
+        Group::SetOutput();
+        Simulated_bus::reset_counters();
+        Simulated_clock::advance(10);
+        per_pin_set<A1, A2, A7, A9, B0, B8>();
+        CHECK_EQUAL(Simulated_bus::writes(), 6);
+        // Каждая запись дает отдельное промежуточное состояние порта
+        CHECK_EQUAL(Gpio_a::changes().size() - a_changes, 4);
+        CHECK_EQUAL(Gpio_a::levels(), a);
+        CHECK_EQUAL(Gpio_b::levels(), b);
+    }
+
+    void vcd()
+    {
+        attach();
+        using Clock = PortPin<GPIOA, 0>;
+        using Data = PortPin<GPIOB, 1>;
+        Pins<Clock, Data>::SetOutput();
+        Simulated_clock::advance(5);
+        Clock::Set();
+        Simulated_clock::advance(5);
+        Data::Set();
+        Clock::Reset();
+
+        std::ostringstream out;
+        core::write_vcd<Gpio_a, Gpio_b>(out, {"GPIOA", "GPIOB"});
+        const auto text = out.str();
+        CHECK(text.starts_with("$timescale 1 ns $end\n"));
+        CHECK(text.find("$var wire 1 ! GPIOA_0 $end") != std::string::npos);
+        CHECK(text.find("$var wire 1 2 GPIOB_1 $end") != std::string::npos);
+        CHECK(text.find("#5\n1!\n") != std::string::npos);
+        CHECK(text.find("#10\n0!\n12\n") != std::string::npos);
+    }
+}
+
+int main()
+{
+    output_modes();
+    input_modes();
+    batched_vs_per_pin();
+    vcd();
+    return test::result();
+}
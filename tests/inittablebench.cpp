@@ -0,0 +1,217 @@
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#if __has_include(<elf.h>)
+#include <elf.h>
+#endif
+
+#include "bench.hpp"
+#include "check.hpp"
+#include "fields.hpp"
+#include "inittable.hpp"
+#include "simulatedbus.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    constexpr size_t runs = 2'000'000;
+
+    /*!
+     * Регистры в массиве ОЗУ: каждое обращение - одна volatile загрузка или сохранение,
+     * как Mmio_bus на микроконтроллере, поэтому размер кода сопоставим с целевым
+     */
+    struct Memory_bus
+    {
+        static constexpr size_t base = 0x40000000;
+        alignas(4) static inline std::array<std::uint8_t, 0x100> memory{};
+
+        template<typename Value_t>
+        [[gnu::always_inline]] inline static Value_t read(size_t address)
+        {
+            return *reinterpret_cast<volatile Value_t*>(memory.data() + (address - base));
+        }
+
+        template<typename Value_t>
+        [[gnu::always_inline]] inline static void write(size_t address, Value_t value)
+        {
+            *reinterpret_cast<volatile Value_t*>(memory.data() + (address - base)) = value;
+        }
+    };
+
+    /// Последовательность загрузки: тактирование, порт, два таймера и USART
+    template<typename Bus>
+    struct Boot
+    {
+        using ENR = core::Register<0x40000000, std::uint32_t, Read_write_t, Bus>;
+        using MODER = core::Register<0x40000010, std::uint32_t, Read_write_t, Bus>;
+        using AFR = core::Register<0x40000014, std::uint32_t, Read_write_t, Bus>;
+        using CR1 = core::Register<0x40000020, std::uint16_t, Read_write_t, Bus>;
+        using PSC = core::Register<0x40000024, std::uint16_t, Read_write_t, Bus>;
+        using ARR = core::Register<0x40000028, std::uint32_t, Read_write_t, Bus>;
+        using CCMR = core::Register<0x4000002C, std::uint16_t, Read_write_t, Bus>;
+        using BRR = core::Register<0x40000040, std::uint32_t, Write_only_t, Bus>;
+        using UCR = core::Register<0x40000044, std::uint32_t, Read_write_t, Bus>;
+
+        template<typename R, size_t Offset, size_t Size, std::uint32_t V>
+        using Value = core::Field_value<core::Field<R, Offset, Size, Read_write_t>, V>;
+
+        using Clocks = Values<Value<ENR, 0, 1, 1>, Value<ENR, 3, 1, 1>, Value<ENR, 17, 1, 1>>;
+        using Pins = Values<Value<MODER, 10, 2, 2>, Value<MODER, 12, 2, 2>, Value<AFR, 20, 4, 7>, Value<AFR, 24, 4, 7>>;
+        using Timer = Values<Value<PSC, 0, 16, 83>, Value<ARR, 0, 32, 999>, Value<CCMR, 4, 3, 6>, Value<CCMR, 3, 1, 1>>;
+        using Start = Values<Value<CR1, 7, 1, 1>, Value<CR1, 0, 1, 1>>;
+        using Usart = Values<core::Field_value<core::Field<BRR, 0, 16, Write_only_t>, 0x2D9>,
+                             Value<UCR, 2, 1, 1>, Value<UCR, 3, 1, 1>, Value<UCR, 13, 1, 1>>;
+        using Led = Values<Value<MODER, 0, 2, 1>>;
+
+        using Table = core::Init_table<Clocks, Pins, Timer, Start, Usart, Led>;
+
+        [[gnu::always_inline]] inline static void set()
+        {
+            Clocks::Set();
+            Pins::Set();
+            Timer::Set();
+            Start::Set();
+            Usart::Set();
+            Led::Set();
+        }
+
+        static constexpr size_t set_reads = Clocks::SetReads() + Pins::SetReads() + Timer::SetReads()
+                                            + Start::SetReads() + Usart::SetReads() + Led::SetReads();
+        static constexpr size_t set_writes = Clocks::SetWrites() + Pins::SetWrites() + Timer::SetWrites()
+                                             + Start::SetWrites() + Usart::SetWrites() + Led::SetWrites();
+    };
+}
+
+// Отдельные функции, чтобы найти их размеры в таблице символов
+extern "C" [[gnu::noinline]] void boot_inlined()
+{
+    Boot<Memory_bus>::set();
+}
+
+extern "C" [[gnu::noinline]] void boot_table()
+{
+    Boot<Memory_bus>::Table::run();
+}
+
+namespace {
+    /*!
+     * Размер функции по таблице символов собственного исполняемого файла,
+     * 0, если таблица недоступна (например, файл без символов). Имя сравнивается
+     * по началу, чтобы находить экземпляры шаблонов.
+     */
+    size_t symbol_size(std::string_view prefix, std::string_view contains = {})
+    {
+#if __has_include(<elf.h>)
+        std::ifstream file("/proc/self/exe", std::ios::binary);
+        const std::vector<char> image{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        if (image.size() < sizeof(Elf64_Ehdr) || std::memcmp(image.data(), ELFMAG, SELFMAG) != 0
+            || image[EI_CLASS] != ELFCLASS64)
+            return 0;
+
+        Elf64_Ehdr header;
+        std::memcpy(&header, image.data(), sizeof(header));
+        auto section = [&image, &header](size_t index)
+        {
+            Elf64_Shdr s;
+            std::memcpy(&s, image.data() + header.e_shoff + index * header.e_shentsize, sizeof(s));
+            return s;
+        };
+        for (size_t i = 0; i < header.e_shnum; ++i)
+        {
+            const auto symbols = section(i);
+            if (symbols.sh_type != SHT_SYMTAB)
+                continue;
+            const auto names = section(symbols.sh_link);
+            for (size_t offset = 0; offset + sizeof(Elf64_Sym) <= symbols.sh_size; offset += sizeof(Elf64_Sym))
+            {
+                Elf64_Sym symbol;
+                std::memcpy(&symbol, image.data() + symbols.sh_offset + offset, sizeof(symbol));
+                const std::string_view name = image.data() + names.sh_offset + symbol.st_name;
+                if (ELF64_ST_TYPE(symbol.st_info) == STT_FUNC && name.starts_with(prefix) && name.find(contains) != name.npos)
+                    return symbol.st_size;
+            }
+        }
+#else
+        static_cast<void>(prefix);
+        static_cast<void>(contains);
+#endif
+        return 0;
+    }
+
+    /// Обе реализации приводят регистры к одному состоянию, таблица - не более чем теми же обращениями
+    void same_effect()
+    {
+        using B = Boot<Simulated_bus>;
+        Simulated_bus::clear();
+        Simulated_bus::poke(B::MODER::address(), 0xA8000000);
+        Simulated_bus::poke(B::UCR::address(), 0xFFFF0000);
+        B::set();
+        CHECK_EQUAL(Simulated_bus::reads(), B::set_reads);
+        CHECK_EQUAL(Simulated_bus::writes(), B::set_writes);
+        std::vector<std::uint32_t> expected;
+        for (size_t address = Memory_bus::base; address < Memory_bus::base + Memory_bus::memory.size(); address += 4)
+            expected.push_back(Simulated_bus::peek(address));
+
+        Simulated_bus::clear();
+        Simulated_bus::poke(B::MODER::address(), 0xA8000000);
+        Simulated_bus::poke(B::UCR::address(), 0xFFFF0000);
+        B::Table::run();
+        CHECK_EQUAL(Simulated_bus::reads(), B::Table::reads());
+        CHECK_EQUAL(Simulated_bus::writes(), B::Table::writes());
+        CHECK(B::Table::reads() <= B::set_reads && B::Table::writes() <= B::set_writes);
+        for (size_t i = 0; i < expected.size(); ++i)
+            CHECK_EQUAL(Simulated_bus::peek(Memory_bus::base + 4 * i), expected[i]);
+    }
+
+    void code_size()
+    {
+        using Table = Boot<Memory_bus>::Table;
+        const size_t inlined = symbol_size("boot_inlined");
+        const size_t call = symbol_size("boot_table");
+        const size_t loop = symbol_size("_ZN7metaMCU4core14run_init_table", "Memory_bus");
+        const size_t table = sizeof(Table::records);
+        if (inlined == 0 || call == 0 || loop == 0)
+        {
+            std::printf("code size: symbol table is not available\n");
+            return;
+        }
+        std::printf("%-40s %10zu bytes\n", "Values::Set inlined", inlined);
+        std::printf("%-40s %10zu bytes\n", "Init_table call", call);
+        std::printf("%-40s %10zu bytes\n", "run_init_table loop (shared)", loop);
+        std::printf("%-40s %10zu bytes (%zu records)\n", "Init_table records", table, Table::records.size());
+        std::printf("%-40s %10zu bytes\n", "Init_table total", call + loop + table);
+    }
+
+    void run_time()
+    {
+        std::printf("ns/op is per whole sequence\n");
+        test::benchmark("Values::Set inlined", runs, []
+        {
+            for (size_t i = 0; i < runs; ++i)
+                boot_inlined();
+        });
+        const auto inlined = Memory_bus::memory;
+        Memory_bus::memory = {};
+        test::benchmark("Init_table::run", runs, []
+        {
+            for (size_t i = 0; i < runs; ++i)
+                boot_table();
+        });
+        CHECK(Memory_bus::memory == inlined);
+    }
+}
+
+int main()
+{
+    same_effect();
+    code_size();
+    run_time();
+    return test::result();
+}
@@ -0,0 +1,111 @@
+#include <array>
+#include <cstdint>
+
+#include "check.hpp"
+#include "cortexM3.hpp"
+#include "fields.hpp"
+#include "inittable.hpp"
+#include "simulatedbus.hpp"
+
+using namespace metaMCU;
+using core::Init_op;
+using core::Simulated_bus;
+
+namespace {
+    using CR = CortexM3::Register<0x40010000, std::uint32_t, Read_write_t, Simulated_bus>;
+    using DR = core::Register<0x40010004, std::uint32_t, Write_only_t, Simulated_bus>;
+    using MR = core::Register<0x40010008, std::uint32_t, Read_write_t, Simulated_bus>;
+    using HR = core::Register<0x4001000C, std::uint16_t, Read_write_t, Simulated_bus>;
+
+    using ON = CortexM3::Field<CR, 3, 1, Read_write_t>;
+    using MODE = core::Field<CR, 4, 3, Read_write_t>;
+    using DATA = core::Field<DR, 0, 16, Write_only_t>;
+    using HIGH = core::Field<MR, 8, 24, Read_write_t>;
+    using LOW = core::Field<MR, 0, 8, Read_write_t>;
+    using SPEED = core::Field<HR, 2, 2, Read_write_t>;
+
+    using On = core::Field_value<ON, 1>;
+    using Off = core::Field_value<ON, 0>;
+    using Mode5 = core::Field_value<MODE, 5>;
+    using Data = core::Field_value<DATA, 0x1234>;
+    using High = core::Field_value<HIGH, 0xABCDEF>;
+    using Low = core::Field_value<LOW, 0x12>;
+    using Speed = core::Field_value<SPEED, 2>;
+
+    static_assert(requires { On::bit_band_alias(); });
+
+    constexpr std::array<size_t, 4> addresses = {CR::address(), DR::address(), MR::address(), HR::address()};
+    constexpr std::array<std::uint32_t, 4> initial = {0xFFFF0000, 0xFFFFFFFF, 0x55555555, 0xFFFF};
+
+    void reset()
+    {
+        Simulated_bus::clear();
+        for (size_t i = 0; i < addresses.size(); ++i)
+            Simulated_bus::poke(addresses[i], initial[i]);
+    }
+
+    std::array<std::uint32_t, 4> state()
+    {
+        std::array<std::uint32_t, 4> result{};
+        for (size_t i = 0; i < addresses.size(); ++i)
+            result[i] = Simulated_bus::peek(addresses[i]);
+        return result;
+    }
+
+    /// Выполнение таблицы дает то же состояние регистров, что Values::Set наборов по порядку
+    template<typename... Vs>
+    void replay_matches_set()
+    {
+        reset();
+        (Vs::Set(), ...);
+        const auto expected = state();
+
+        using Table = core::Init_table<Vs...>;
+        reset();
+        Table::run();
+        CHECK(state() == expected);
+        CHECK_EQUAL(Simulated_bus::reads(), Table::reads());
+        CHECK_EQUAL(Simulated_bus::writes(), Table::writes());
+    }
+
+    /// Единственное поле bit-band: Values::Set пишет в псевдоним, таблица - изменяет слово
+    void bit_band_field()
+    {
+        using Table = core::Init_table<Values<On>>;
+        static_assert(Table::records.size() == 1);
+        static_assert(Table::records[0].op == Init_op::modify);
+        static_assert(Table::records[0].clear == 0x8 && Table::records[0].set == 0x8);
+
+        reset();
+        Values<On>::Set();
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0xFFFF0008);
+        reset();
+        Table::run();
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0xFFFF0008);
+    }
+
+    void operations()
+    {
+        // Полностью заданный регистр и регистр только для записи - без чтения
+        static_assert(core::Init_table<Values<High, Low>>::records[0].op == Init_op::write);
+        static_assert(core::Init_table<Values<Data>>::records[0].op == Init_op::write);
+        static_assert(core::Init_table<Values<Mode5>>::records[0].op == Init_op::modify);
+        // Запись, за которой следует изменение того же регистра, остается записью
+        using Merged = core::Init_table<Values<High, Low>, Values<core::Field_value<LOW, 0x34>>>;
+        static_assert(Merged::records.size() == 1 && Merged::records[0].op == Init_op::write);
+        static_assert(Merged::records[0].set == 0xABCDEF34);
+    }
+}
+
+int main()
+{
+    bit_band_field();
+    operations();
+    replay_matches_set<Values<On>>();
+    replay_matches_set<Values<Off>>();
+    replay_matches_set<Values<On, Mode5>>();
+    replay_matches_set<Values<On>, Values<Mode5>, Values<Off>>();
+    replay_matches_set<Values<Data, Speed>, Values<High, Low>, Values<On>>();
+    replay_matches_set<Values<Low>, Values<High>, Values<Speed>>();
+    return test::result();
+}
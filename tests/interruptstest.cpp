@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "check.hpp"
+#include "interrupts.hpp"
+#include "simulatedbus.hpp"
+
+using namespace metaMCU;
+using namespace metaMCU::CortexM3;
+using core::Simulated_bus;
+
+namespace {
+    void reset_handler() {}
+    void default_handler() {}
+    void systick_handler() {}
+    void irq1_handler() {}
+    void irq33_handler() {}
+
+    constexpr int stack = 0;
+
+    using Vectors = Vector_table<40, 4, reset_handler, default_handler,
+        Irq_binding<SYS_TICK, systick_handler, 15>,
+        Irq_binding<1, irq1_handler, 5>,
+        Irq_binding<33, irq33_handler, 2>>;
+
+    constexpr auto vectors = Vectors::table(&stack);
+    static_assert(vectors.stack_top == &stack);
+    static_assert(vectors.handlers[0] == reset_handler);
+    static_assert(vectors.handlers[15 + SYS_TICK] == systick_handler);
+    static_assert(vectors.handlers[15 + 1] == irq1_handler);
+    static_assert(vectors.handlers[15 + 33] == irq33_handler);
+    static_assert(vectors.handlers[15 + 0] == default_handler && vectors.handlers[15 + HARD_FAULT] == default_handler);
+    static_assert(vectors.handlers[15 - 3] == nullptr, "reserved vectors are zero");
+
+    /// Без привязок и только с исключениями фиксированного приоритета настраивать нечего
+    using Empty = Vector_table<4, 4, reset_handler, default_handler>;
+    using Fixed = Vector_table<4, 4, reset_handler, default_handler, Irq_binding<HARD_FAULT, default_handler>>;
+    static_assert(Empty::Nvic_values<Simulated_bus>::SetWrites() == 0 && Empty::Nvic_values<Simulated_bus>::SetReads() == 0);
+    static_assert(Fixed::Nvic_values<Simulated_bus>::SetWrites() == 0);
+
+    /// Строгий режим: привязаны все исключения и оба прерывания
+    using Complete = Vector_table<2, 4, reset_handler, default_handler,
+        Irq_binding<NMI, default_handler>, Irq_binding<HARD_FAULT, default_handler>,
+        Irq_binding<MEM_MANAGE, default_handler>, Irq_binding<BUS_FAULT, default_handler>,
+        Irq_binding<USAGE_FAULT, default_handler>, Irq_binding<SV_CALL, default_handler>,
+        Irq_binding<DEBUG_MONITOR, default_handler>, Irq_binding<PEND_SV, default_handler>,
+        Irq_binding<SYS_TICK, systick_handler>, Irq_binding<0, irq1_handler>, Irq_binding<1, irq33_handler>>;
+    static_assert(Complete::table<Unbound::forbidden>(&stack).handlers[15 + 1] == irq33_handler);
+
+    /// Прерывания 1 и 9 разрешаются одной записью в ISER0, их приоритеты - в разных IPR
+    using Shared = Vector_table<12, 4, reset_handler, default_handler,
+        Irq_binding<1, irq1_handler, 5>, Irq_binding<9, irq33_handler, 3>>;
+
+    /// Регистры NVIC, записанные при выполнении Set, в порядке записи
+    template<typename Nvic>
+    std::vector<size_t> write_order(std::initializer_list<size_t> addresses)
+    {
+        std::vector<size_t> order;
+        Simulated_bus::clear();
+        for (const size_t address : addresses)
+            Simulated_bus::on_write(address, [address, &order](std::uint32_t) { order.push_back(address); });
+        Nvic::Set();
+        for (const size_t address : addresses)
+            Simulated_bus::on_write(address, {});
+        return order;
+    }
+
+    /// Приоритеты записываются до разрешения: прерывание не разрешается с приоритетом 0
+    void nvic_values()
+    {
+        using Nvic = Vectors::Nvic_values<Simulated_bus>;
+        const auto order = write_order<Nvic>({0xE000E100, 0xE000E104, 0xE000E400, 0xE000E420, 0xE000ED20});
+        CHECK(order == (std::vector<size_t>{0xE000ED20, 0xE000E400, 0xE000E420, 0xE000E100, 0xE000E104}));
+        CHECK_EQUAL(Simulated_bus::peek(0xE000E100), 1U << 1);
+        CHECK_EQUAL(Simulated_bus::peek(0xE000E104), 1U << 1);
+        CHECK_EQUAL(Simulated_bus::peek(0xE000E400), 5U << 12);
+        CHECK_EQUAL(Simulated_bus::peek(0xE000E420), 2U << 12);
+        CHECK_EQUAL(Simulated_bus::peek(0xE000ED20), 15U << 28);
+    }
+
+    /// Общий ISER записывается после всех IPR его прерываний
+    void shared_iser()
+    {
+        using Nvic = Shared::Nvic_values<Simulated_bus>;
+        const auto order = write_order<Nvic>({0xE000E100, 0xE000E400, 0xE000E408});
+        CHECK(order == (std::vector<size_t>{0xE000E400, 0xE000E408, 0xE000E100}));
+        CHECK_EQUAL(Simulated_bus::peek(0xE000E100), 1U << 1 | 1U << 9);
+        CHECK_EQUAL(Simulated_bus::peek(0xE000E400), 5U << 12);
+        CHECK_EQUAL(Simulated_bus::peek(0xE000E408), 3U << 12);
+    }
+
+    void empty_nvic_values()
+    {
+        Simulated_bus::clear();
+        Empty::Nvic_values<Simulated_bus>::Set();
+        CHECK(Empty::Nvic_values<Simulated_bus>::IsSet());
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(), 0);
+    }
+}
+
+int main()
+{
+    nvic_values();
+    shared_iser();
+    empty_nvic_values();
+    return test::result();
+}
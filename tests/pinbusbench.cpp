@@ -0,0 +1,132 @@
+#include <cstdint>
+#include <cstdio>
+
+#include "bench.hpp"
+#include "check.hpp"
+#include "port.hpp"
+#include "simulatedbus.hpp"
+#include "simulatedgpio.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+using core::Simulated_clock;
+
+namespace {
+    constexpr size_t words = 500'000;
+
+    using GPIOA = core::Simulated_port<0x40020000>;
+    using GPIOB = core::Simulated_port<0x40020400>;
+    using Gpio_a = core::Simulated_gpio<GPIOA>;
+    using Gpio_b = core::Simulated_gpio<GPIOB>;
+
+    template<typename P, std::uint8_t... N>
+    using Bus = PinBus<PortPin<P, N>...>;
+
+    // Восемь выводов подряд
+    using Shift_bus = Bus<GPIOA, 4, 5, 6, 7, 8, 9, 10, 11>;
+    // Восемь выводов в произвольном порядке
+    using Table_bus = Bus<GPIOA, 3, 1, 6, 0, 5, 2, 7, 4>;
+    // Шестнадцать выводов в обратном порядке
+    using Masks_bus = Bus<GPIOA, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0>;
+    // Шестнадцать разрядов на двух портах, все способы сразу
+    using Mixed_bus = PinBus<PortPin<GPIOA, 0>, PortPin<GPIOA, 1>, PortPin<GPIOA, 2>, PortPin<GPIOA, 3>,
+                             PortPin<GPIOB, 9>, PortPin<GPIOB, 2>, PortPin<GPIOB, 7>, PortPin<GPIOB, 0>,
+                             PortPin<GPIOB, 5>, PortPin<GPIOB, 1>, PortPin<GPIOB, 3>, PortPin<GPIOB, 4>,
+                             PortPin<GPIOA, 15>, PortPin<GPIOA, 12>, PortPin<GPIOA, 13>, PortPin<GPIOA, 14>>;
+
+    static_assert(Shift_bus::Mapping<GPIOA>() == PinBusMapping::Shift);
+    static_assert(Table_bus::Mapping<GPIOA>() == PinBusMapping::Table);
+    static_assert(Masks_bus::Mapping<GPIOA>() == PinBusMapping::Masks);
+    static_assert(Mixed_bus::Mapping<GPIOA>() == PinBusMapping::Masks);
+    static_assert(Mixed_bus::Mapping<GPIOB>() == PinBusMapping::Table);
+
+    void attach()
+    {
+        Simulated_bus::clear();
+        Simulated_clock::reset();
+        Gpio_a::attach();
+        Gpio_b::attach();
+    }
+
+    /// Каждое значение шины читается обратно, запись - одна запись в BSRR на порт
+    template<typename B, std::uint8_t width>
+    void loopback()
+    {
+        attach();
+        B::SetOutput();
+        Simulated_bus::reset_counters();
+        for (std::uint32_t value = 0; value < (1U << width); value += width > 8 ? 257 : 1)
+        {
+            B::Write(value);
+            CHECK_EQUAL(B::Read(), value);
+        }
+        const size_t values = width > 8 ? (1U << width) / 257 + 1 : 1U << width;
+        CHECK_EQUAL(Simulated_bus::writes(), values * B::PortsCount());
+        CHECK_EQUAL(Simulated_bus::reads(), values * B::PortsCount());
+    }
+
+    /*!
+     * Слов в секунду при записи. С моделью порта в измерение входит вычисление
+     * уровней и запись временной диаграммы, без нее - только перенос разрядов и
+     * запись в BSRR на шине.
+     */
+    template<typename B>
+    void write_rate(const char* name, std::uint32_t mask, bool model)
+    {
+        attach();
+        B::SetOutput();
+        if (!model)
+            Simulated_bus::clear();
+        Simulated_bus::reset_counters();
+        test::benchmark(name, words, [mask]
+        {
+            for (std::uint32_t i = 0; i < words; ++i)
+                B::Write(i * 0x9E3779B9U & mask);
+        });
+        CHECK_EQUAL(Simulated_bus::writes(), words * B::PortsCount());
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+    }
+
+    template<typename B>
+    void read_rate(const char* name)
+    {
+        attach();
+        B::SetInput();
+        Gpio_a::drive(0xFFFF, 0xA5C3);
+        Gpio_b::drive(0xFFFF, 0x3C5A);
+        std::uint32_t sum = 0;
+        test::benchmark(name, words, [&sum]
+        {
+            for (size_t i = 0; i < words; ++i)
+                sum += B::Read();
+        });
+        CHECK_EQUAL(sum, static_cast<std::uint32_t>(words * B::Read()));
+    }
+}
+
+int main()
+{
+    loopback<Shift_bus, 8>();
+    loopback<Table_bus, 8>();
+    loopback<Masks_bus, 16>();
+    loopback<Mixed_bus, 16>();
+
+    std::printf("ns/op is per bus word, Mop/s is million words per second\n");
+    using Per_bit = Pins<PortPin<GPIOA, 3>, PortPin<GPIOA, 1>, PortPin<GPIOA, 6>, PortPin<GPIOA, 0>,
+                         PortPin<GPIOA, 5>, PortPin<GPIOA, 2>, PortPin<GPIOA, 7>, PortPin<GPIOA, 4>>;
+    for (const bool model : {true, false})
+    {
+        std::printf("%s\n", model ? "with Simulated_gpio:" : "bus only:");
+        write_rate<Shift_bus>("PinBus write, shift", 0xFF, model);
+        write_rate<Table_bus>("PinBus write, table", 0xFF, model);
+        write_rate<Masks_bus>("PinBus write, masks", 0xFFFF, model);
+        write_rate<Mixed_bus>("PinBus write, 2 ports", 0xFFFF, model);
+        write_rate<Per_bit>("Pins::Write per bit, table pins", 0xFF, model);
+    }
+    std::printf("with Simulated_gpio:\n");
+    read_rate<Shift_bus>("PinBus read, shift");
+    read_rate<Table_bus>("PinBus read, table");
+    read_rate<Masks_bus>("PinBus read, masks");
+    read_rate<Mixed_bus>("PinBus read, 2 ports");
+    return test::result();
+}
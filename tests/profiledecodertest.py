@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Тест ProfileDecoder на потоке, выведенном profiling::dump на хосте.
+
+Использование:
+    profiledecodertest.py path/to/profilertest
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DECODER = os.path.join(HERE, "..", "tools", "profiledecoder.py")
+sys.path.insert(0, os.path.dirname(DECODER))
+
+import profiledecoder as decoder  # noqa: E402
+
+PROFILER_TEST = None
+
+
+class RoundTripTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "dump.bin")
+            subprocess.run([PROFILER_TEST, path], check=True)
+            with open(path, "rb") as file:
+                cls.data = file.read()
+        cls.sites = {site["name"]: site for site in decoder.decode(cls.data)}
+
+    def test_sites(self):
+        self.assertEqual(set(self.sites), {"fast", "slow", "scoped"})
+
+    def test_statistics(self):
+        fast = self.sites["fast"]
+        self.assertEqual((fast["count"], fast["sum"], fast["min"], fast["max"]), (5, 19, 0, 7))
+        self.assertEqual(fast["histogram"], {0: 1, 1: 1, 3: 3})
+        self.assertEqual(decoder.bucket_range(3), (4, 7))
+
+    def test_wide_values(self):
+        slow = self.sites["slow"]
+        self.assertEqual((slow["sum"], slow["max"]), (0xFFFFFFFF, 0xFFFFFFFF))
+        self.assertEqual(slow["histogram"], {32: 1})
+        self.assertEqual(self.sites["scoped"]["count"], 1)
+
+    def test_leading_output_and_truncation(self):
+        # Поток ищется по сигнатуре, вывод до нее (например, UART) пропускается
+        self.assertEqual(len(decoder.decode(b"boot\r\n" + self.data)), 3)
+        with self.assertRaises(decoder.DumpError):
+            decoder.decode(self.data[:-1])
+        with self.assertRaises(decoder.DumpError):
+            decoder.decode(b"no dump")
+
+    def test_command_line(self):
+        result = subprocess.run([sys.executable, DECODER, "-", "--frequency", "1e6"], input=self.data,
+                                capture_output=True, check=True)
+        output = result.stdout.decode()
+        self.assertIn("fast", output)
+        self.assertIn("n=5", output)
+        self.assertIn("max=7.000 us", output)
+
+
+if __name__ == "__main__":
+    PROFILER_TEST = sys.argv.pop(1)
+    unittest.main()
@@ -0,0 +1,73 @@
+#ifndef METAMCU_PROFILING
+#define METAMCU_PROFILING 1
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "check.hpp"
+#include "profiler.hpp"
+
+using namespace metaMCU;
+
+namespace {
+    std::vector<std::uint8_t> dump()
+    {
+        std::vector<std::uint8_t> stream;
+        profiling::dump([&stream](const std::uint8_t* data, size_t size) { stream.insert(stream.end(), data, data + size); });
+        return stream;
+    }
+
+    void record()
+    {
+        auto& fast = profiling::site<"fast">;
+        for (const std::uint32_t duration : {0U, 1U, 5U, 6U, 7U})
+            fast.record(duration);
+        profiling::site<"slow">.record(0xFFFFFFFF);
+        {
+            profiling::Scoped_timer<"scoped"> timer;
+        }
+        CHECK_EQUAL(fast.count, 5);
+        CHECK_EQUAL(fast.sum, 19);
+        CHECK_EQUAL(fast.minimum, 0);
+        CHECK_EQUAL(fast.maximum, 7);
+        CHECK_EQUAL(fast.histogram[0], 1);
+        CHECK_EQUAL(fast.histogram[1], 1);
+        CHECK_EQUAL(fast.histogram[3], 3);
+        CHECK_EQUAL(profiling::site<"slow">.histogram[32], 1);
+        CHECK_EQUAL(profiling::site<"scoped">.count, 1);
+    }
+
+    /// Заголовок потока: сигнатура и количество мест
+    void header(const std::vector<std::uint8_t>& stream)
+    {
+        CHECK(stream.size() > 6);
+        CHECK(std::equal(profiling::dump_magic.begin(), profiling::dump_magic.end(), stream.begin()));
+        CHECK_EQUAL(stream[4] | stream[5] << 8, 3);
+    }
+}
+
+/// С аргументом - путем файла - записывает поток dump в файл для profiledecodertest.py
+int main(int argc, char** argv)
+{
+    record();
+    const auto stream = dump();
+    header(stream);
+
+    if (argc > 1)
+    {
+        auto file = std::fopen(argv[1], "wb");
+        CHECK(file != nullptr);
+        if (file != nullptr)
+        {
+            CHECK_EQUAL(std::fwrite(stream.data(), 1, stream.size(), file), stream.size());
+            std::fclose(file);
+        }
+    }
+
+    profiling::reset();
+    CHECK_EQUAL(profiling::site<"fast">.count, 0);
+    return test::result();
+}
@@ -0,0 +1,102 @@
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "check.hpp"
+#include "queue.hpp"
+
+using namespace metaMCU;
+
+namespace {
+    constexpr size_t operations = 4'000'000;
+
+    /// Добавление и извлечение в одном потоке: стоимость операций без конкуренции
+    template<typename Queue>
+    void single_thread(const char* name)
+    {
+        static Queue queue;
+        std::uint64_t sum = 0;
+        test::benchmark(name, operations, [&]
+        {
+            for (std::uint32_t i = 0; i < operations; ++i)
+            {
+                queue.push(i);
+                std::uint32_t value = 0;
+                queue.pop(value);
+                sum += value;
+            }
+        });
+        CHECK_EQUAL(sum, std::uint64_t{operations} * (operations - 1) / 2);
+    }
+
+    /// Пакеты по 16 элементов: стоимость одного элемента
+    template<typename Queue>
+    void bulk(const char* name)
+    {
+        static Queue queue;
+        std::array<std::uint32_t, 16> in{}, out{};
+        std::uint64_t sum = 0;
+        test::benchmark(name, operations, [&]
+        {
+            for (size_t i = 0; i < operations; i += in.size())
+            {
+                in[0] = static_cast<std::uint32_t>(i);
+                queue.push(std::span<const std::uint32_t>(in));
+                queue.pop(std::span<std::uint32_t>(out));
+                sum += out[0];
+            }
+        });
+        test::keep(sum);
+        CHECK(queue.empty());
+    }
+
+    /// Производители и потребитель в разных потоках
+    template<typename Queue>
+    void threads(const char* name, unsigned producers)
+    {
+        static Queue queue;
+        const size_t per_producer = operations / producers;
+        size_t received = 0;
+        test::benchmark(name, per_producer * producers, [&]
+        {
+            std::vector<std::thread> workers;
+            for (unsigned p = 0; p < producers; ++p)
+                workers.emplace_back([&]
+                {
+                    for (std::uint32_t i = 0; i < per_producer;)
+                        if (queue.push(i))
+                            ++i;
+                        else
+                            std::this_thread::yield();
+                });
+            std::array<std::uint32_t, 32> batch{};
+            while (received < per_producer * producers)
+            {
+                const auto count = queue.pop(std::span<std::uint32_t>(batch));
+                if (count == 0)
+                    std::this_thread::yield();
+                received += count;
+            }
+            for (auto& worker : workers)
+                worker.join();
+        });
+        CHECK_EQUAL(received, per_producer * producers);
+    }
+}
+
+int main()
+{
+    using Spsc = Spsc_queue<std::uint32_t, 256>;
+    using Mpsc = Mpsc_queue<std::uint32_t, 256>;
+
+    single_thread<Spsc>("spsc push+pop");
+    single_thread<Mpsc>("mpsc push+pop");
+    bulk<Spsc>("spsc bulk 16, per element");
+    bulk<Mpsc>("mpsc bulk 16, per element");
+    threads<Spsc>("spsc 1 producer thread", 1);
+    threads<Mpsc>("mpsc 1 producer thread", 1);
+    threads<Mpsc>("mpsc 4 producer threads", 4);
+    return test::result();
+}
@@ -0,0 +1,177 @@
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "check.hpp"
+#include "queue.hpp"
+
+using namespace metaMCU;
+
+namespace {
+#if defined(__SANITIZE_THREAD__)
+    constexpr std::uint32_t messages = 20000;
+#else
+    constexpr std::uint32_t messages = 50000;
+#endif
+
+    void spsc_single_thread()
+    {
+        Spsc_queue<int, 4> queue;
+        int value = 0;
+        CHECK(queue.empty());
+        CHECK(!queue.pop(value));
+        for (int i = 0; i < 4; ++i)
+            CHECK(queue.push(i));
+        CHECK(!queue.push(4));
+        CHECK_EQUAL(queue.size(), 4);
+        CHECK(queue.pop(value) && value == 0);
+        CHECK(queue.pop(value) && value == 1);
+
+        // Участок для записи останавливается на конце буфера
+        CHECK_EQUAL(queue.write_reserve().size(), 2);
+        const std::array<int, 3> more = {10, 11, 12};
+        CHECK_EQUAL(queue.push(std::span<const int>(more)), 2);
+        CHECK_EQUAL(queue.read_reserve().size(), 2);
+
+        std::array<int, 4> out{};
+        CHECK_EQUAL(queue.pop(std::span<int>(out)), 4);
+        CHECK(out == (std::array<int, 4>{2, 3, 10, 11}));
+        CHECK(queue.empty());
+    }
+
+    void mpsc_single_thread()
+    {
+        Mpsc_queue<int, 4> queue;
+        int value = 0;
+        CHECK(!queue.pop(value));
+        auto reservation = queue.write_reserve(3);
+        CHECK_EQUAL(reservation.span.size(), 3);
+        // Не опубликованные элементы недоступны потребителю
+        CHECK(!queue.pop(value));
+        reservation.span[0] = 1;
+        reservation.span[1] = 2;
+        reservation.span[2] = 3;
+        queue.write_commit(reservation);
+        CHECK(queue.push(4));
+        CHECK(!queue.push(5));
+
+        std::array<int, 2> out{};
+        CHECK_EQUAL(queue.pop(std::span<int>(out)), 2);
+        CHECK(out == (std::array<int, 2>{1, 2}));
+        const std::array<int, 3> more = {5, 6, 7};
+        CHECK_EQUAL(queue.push(std::span<const int>(more)), 2);
+        std::array<int, 4> rest{};
+        CHECK_EQUAL(queue.pop(std::span<int>(rest)), 4);
+        CHECK(rest == (std::array<int, 4>{3, 4, 5, 6}));
+        CHECK(queue.empty());
+    }
+
+    /// Потребитель получает все сообщения производителя по порядку
+    void spsc_stress()
+    {
+        static Spsc_queue<std::uint32_t, 64> queue;
+        std::thread producer([]
+        {
+            std::uint32_t next = 0;
+            while (next < messages)
+            {
+                if (next % 3 == 0)
+                {
+                    auto span = queue.write_reserve(5);
+                    size_t count = 0;
+                    for (; count < span.size() && next < messages; ++count)
+                        span[count] = next++;
+                    queue.write_commit(count);
+                }
+                else if (queue.push(next))
+                    ++next;
+                else
+                    std::this_thread::yield();
+            }
+        });
+
+        std::uint32_t expected = 0;
+        size_t errors = 0;
+        std::array<std::uint32_t, 7> batch{};
+        while (expected < messages)
+        {
+            const auto count = queue.pop(std::span<std::uint32_t>(batch));
+            if (count == 0)
+                std::this_thread::yield();
+            for (size_t i = 0; i < count; ++i)
+                errors += batch[i] != expected++;
+        }
+        producer.join();
+        CHECK_EQUAL(errors, 0);
+        CHECK(queue.empty());
+    }
+
+    /// Сообщения каждого производителя приходят по порядку, ни одно не теряется
+    void mpsc_stress()
+    {
+        constexpr std::uint32_t producers = 4;
+        constexpr std::uint32_t per_producer = messages / producers;
+        static Mpsc_queue<std::uint32_t, 64> queue;
+
+        std::vector<std::thread> threads;
+        for (std::uint32_t p = 0; p < producers; ++p)
+            threads.emplace_back([p]
+            {
+                std::uint32_t next = 0;
+                while (next < per_producer)
+                {
+                    if (p % 2 == 0)
+                    {
+                        if (queue.push((p << 24) | next))
+                            ++next;
+                        else
+                            std::this_thread::yield();
+                    }
+                    else
+                    {
+                        auto reservation = queue.write_reserve(3);
+                        for (auto& slot : reservation.span)
+                            slot = (p << 24) | (next < per_producer ? next++ : per_producer);
+                        queue.write_commit(reservation);
+                        if (reservation.span.empty())
+                            std::this_thread::yield();
+                    }
+                }
+            });
+
+        std::array<std::uint32_t, producers> expected{};
+        size_t received = 0;
+        size_t errors = 0;
+        while (received < producers * per_producer)
+        {
+            std::uint32_t value = 0;
+            if (!queue.pop(value))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            const auto p = value >> 24;
+            const auto sequence = value & 0xFFFFFF;
+            // Заполнитель после последнего сообщения производителя с участком
+            if (sequence == per_producer)
+                continue;
+            errors += p >= producers || sequence != expected[p]++;
+            ++received;
+        }
+        for (auto& thread : threads)
+            thread.join();
+        CHECK_EQUAL(errors, 0);
+        for (auto count : expected)
+            CHECK_EQUAL(count, per_producer);
+    }
+}
+
+int main()
+{
+    spsc_single_thread();
+    mpsc_single_thread();
+    spsc_stress();
+    mpsc_stress();
+    return test::result();
+}
@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""Тесты разбора SVD и генерации заголовков RegistersGenerator на tests/data/sample.svd."""
+
+import contextlib
+import io
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+sys.path.insert(0, os.path.join(HERE, "..", "tools"))
+
+import registersgenerator as generator  # noqa: E402
+
+SAMPLE = os.path.join(HERE, "data", "sample.svd")
+INCLUDES = [os.path.join(HERE, "..", "core"), os.path.join(HERE, "..", "utils")]
+COMPILER = os.environ.get("CXX") or shutil.which("c++")
+
+
+def run(*args):
+    """Запускает генератор, возвращает код завершения и вывод."""
+    out, err = io.StringIO(), io.StringIO()
+    with contextlib.redirect_stdout(out), contextlib.redirect_stderr(err):
+        code = generator.main([SAMPLE] + list(args))
+    return code, out.getvalue() + err.getvalue()
+
+
+class ParseTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.device, peripherals = generator.parse_svd(SAMPLE)
+        cls.peripherals = {p.name: p for p in peripherals}
+
+    def registers(self, peripheral):
+        return {r.name: r for r in self.peripherals[peripheral].registers}
+
+    def test_parse_int(self):
+        self.assertEqual(generator.parse_int("0x1F"), 31)
+        self.assertEqual(generator.parse_int("#101"), 5)
+        self.assertEqual(generator.parse_int("0b11"), 3)
+        self.assertEqual(generator.parse_int(" 42 "), 42)
+
+    def test_identifier(self):
+        self.assertEqual(generator.identifier("CH[0]"), "CH_0_")
+        self.assertEqual(generator.identifier("1WIRE"), "_1WIRE")
+        self.assertEqual(generator.identifier("delete"), "delete_")
+
+    def test_device(self):
+        self.assertEqual(self.device, "SAMPLE")
+        self.assertEqual(list(self.peripherals), ["GPIOA", "GPIOB", "TIM2"])
+
+    def test_register_attributes(self):
+        gpioa = self.registers("GPIOA")
+        self.assertEqual(gpioa["MODER"].address, 0x40020000)
+        self.assertEqual(gpioa["MODER"].reset_value, 0xA8000000)
+        self.assertEqual(gpioa["IDR"].access, "Read_only_t")
+        self.assertEqual(gpioa["BSRR"].access, "Write_only_t")
+        self.assertEqual(gpioa["BSRR"].address, 0x40020018)
+        self.assertEqual(self.registers("TIM2")["CR1"].size, 16)
+
+    def test_dim_fields(self):
+        fields = self.registers("GPIOA")["MODER"].fields
+        self.assertEqual(len(fields), 16)
+        self.assertEqual((fields[15].name, fields[15].offset, fields[15].width), ("MODER15", 30, 2))
+        idr = self.registers("GPIOA")["IDR"].fields
+        self.assertEqual((idr[7].name, idr[7].offset, idr[7].width), ("IDR7", 7, 1))
+
+    def test_bit_positions(self):
+        bsrr = self.registers("GPIOA")["BSRR"].fields
+        self.assertEqual([(f.name, f.offset, f.width) for f in bsrr], [("BS0", 0, 1), ("BR0", 16, 1)])
+        ccr = self.registers("TIM2")["CH1_CCR"].fields[0]
+        self.assertEqual((ccr.offset, ccr.width), (0, 32))
+
+    def test_enumerated_values(self):
+        enums = self.registers("GPIOA")["MODER"].fields[5].enums
+        self.assertEqual([(name, value) for name, value, _ in enums],
+                         [("Input", 0), ("Output", 1), ("Alternate", 2), ("Analog", 3)])
+
+    def test_derived_peripheral(self):
+        gpiob = self.registers("GPIOB")
+        self.assertEqual(self.peripherals["GPIOB"].base_address, 0x40020400)
+        self.assertEqual(gpiob["MODER"].address, 0x40020400)
+        self.assertEqual(gpiob["MODER"].reset_value, 0xA8000000)
+        self.assertEqual(len(gpiob["MODER"].fields), 16)
+
+    def test_cluster(self):
+        tim2 = self.registers("TIM2")
+        self.assertEqual(tim2["CH0_CCR"].address, 0x40000034)
+        self.assertEqual(tim2["CH1_CCR"].address, 0x40000038)
+
+    def test_hardware_modified_bits(self):
+        tim2 = self.registers("TIM2")
+        self.assertEqual(tim2["SR"].hardware_mask, 0x1)
+        self.assertEqual(tim2["CR1"].hardware_mask, 0)
+        self.assertEqual(self.registers("GPIOA")["MODER"].hardware_mask, 0)
+
+
+class GenerateTest(unittest.TestCase):
+    def setUp(self):
+        self.directory = tempfile.TemporaryDirectory()
+        self.output = self.directory.name
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def read(self, name):
+        with open(os.path.join(self.output, name), encoding="utf-8") as header:
+            return header.read()
+
+    def test_headers(self):
+        code, _ = run("-o", self.output)
+        self.assertEqual(code, 0)
+        self.assertEqual(sorted(os.listdir(self.output)), ["gpioa.hpp", "gpiob.hpp", "sample.hpp", "tim2.hpp"])
+        gpioa = self.read("gpioa.hpp")
+        self.assertIn("using Register = core::Register<0x40020000, std::uint32_t, Read_write_t>;", gpioa)
+        self.assertIn("inline constexpr std::uint32_t reset_value = 0xA8000000;", gpioa)
+        self.assertIn("using Output = core::Field_value<MODER5, 1>;", gpioa)
+        self.assertIn("std::array<core::Field_layout, 34> fields", gpioa)
+        self.assertIn("Hardware_modified_bits<0x40000010> : std::integral_constant<size_t, 0x1>", self.read("tim2.hpp"))
+
+    def test_shadow_and_bus(self):
+        code, _ = run("-o", self.output, "--shadow", "GPIOA.MODER",
+                      "--bus", "metaMCU::core::Simulated_bus", "--bus-header", "simulatedbus.hpp")
+        self.assertEqual(code, 0)
+        gpioa = self.read("gpioa.hpp")
+        self.assertIn("core::Shadow_register<0x40020000, std::uint32_t, Read_write_t, 0xA8000000, metaMCU::core::Simulated_bus>", gpioa)
+        self.assertIn('#include "shadowregister.hpp"', gpioa)
+        self.assertIn('#include "simulatedbus.hpp"', gpioa)
+        self.assertNotIn("Shadow_register", self.read("gpiob.hpp"))
+
+    def compile(self, source):
+        """Компилирует source с заголовками из каталога вывода, возвращает код и сообщения компилятора."""
+        path = os.path.join(self.output, "check.cpp")
+        with open(path, "w", encoding="utf-8") as file:
+            file.write(source)
+        command = [COMPILER, "-std=c++23", "-fsyntax-only", "-I", self.output, path] + ["-I" + i for i in INCLUDES]
+        result = subprocess.run(command, capture_output=True, text=True)
+        return result.returncode, result.stderr
+
+    @unittest.skipUnless(COMPILER, "no C++ compiler")
+    def test_hardware_modified_before_registers(self):
+        code, _ = run("-o", self.output)
+        self.assertEqual(code, 0)
+        tim2 = self.read("tim2.hpp")
+        self.assertLess(tim2.index("Hardware_modified_bits<0x40000010>"), tim2.index("namespace SR {"))
+        code, errors = self.compile('#include "tim2.hpp"\n#include "shadowregister.hpp"\n'
+                                    'static_assert(!metaMCU::Can_shadow<0x40000010, metaMCU::Read_write_t>);\n')
+        self.assertEqual(code, 0, errors)
+
+    @unittest.skipUnless(COMPILER, "no C++ compiler")
+    def test_shadow_rejects_hardware_modified(self):
+        code, _ = run("-o", self.output, "--shadow", "TIM2.SR")
+        self.assertEqual(code, 0)
+        code, errors = self.compile('#include "tim2.hpp"\n')
+        self.assertNotEqual(code, 0)
+        self.assertIn("Can_shadow", errors)
+        self.assertNotIn("after instantiation", errors)
+
+    def test_only_keeps_umbrella_complete(self):
+        run("-o", self.output)
+        os.remove(os.path.join(self.output, "tim2.hpp"))
+        code, output = run("-o", self.output, "--only", "TIM2")
+        self.assertEqual(code, 0)
+        self.assertIn("1 of 1", output)
+        umbrella = self.read("sample.hpp")
+        for name in ("gpioa.hpp", "gpiob.hpp", "tim2.hpp"):
+            self.assertIn('#include "%s"' % name, umbrella)
+
+    def test_only_rejects_unknown(self):
+        code, output = run("-o", self.output, "--only", "USART9")
+        self.assertEqual(code, 1)
+        self.assertIn("USART9", output)
+
+    def test_fast_skips_unchanged(self):
+        run("-o", self.output)
+        path = os.path.join(self.output, "gpioa.hpp")
+        with open(path, "a", encoding="utf-8") as header:
+            header.write("// local edit\n")
+        code, output = run("-o", self.output, "--fast")
+        self.assertEqual(code, 0)
+        self.assertIn("0 of 3", output)
+        self.assertTrue(self.read("gpioa.hpp").endswith("// local edit\n"))
+
+        code, output = run("-o", self.output, "--fast", "--shadow", "GPIOA.MODER")
+        self.assertIn("3 of 3", output)
+        self.assertFalse(self.read("gpioa.hpp").endswith("// local edit\n"))
+
+    def test_invalid_svd(self):
+        path = os.path.join(self.output, "broken.svd")
+        with open(path, "w", encoding="utf-8") as svd:
+            svd.write("<device><name>X</name><peripherals><peripheral derivedFrom='NONE'><name>A</name>"
+                      "</peripheral></peripherals></device>")
+        out = io.StringIO()
+        with contextlib.redirect_stderr(out):
+            code = generator.main([path, "-o", self.output])
+        self.assertEqual(code, 1)
+        self.assertIn("derived from unknown NONE", out.getvalue())
+
+
+if __name__ == "__main__":
+    unittest.main()
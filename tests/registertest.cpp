@@ -0,0 +1,248 @@
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "bitband.hpp"
+#include "check.hpp"
+#include "cortexM3.hpp"
+#include "field.hpp"
+#include "fields.hpp"
+#include "register.hpp"
+#include "simulatedbus.hpp"
+
+// Регистр состояния с флагами, сбрасываемыми записью единицы
+template<>
+struct metaMCU::Hardware_modified_bits<0x40000010> : std::integral_constant<size_t, 0x0F> {};
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    using CR = core::Register<0x40000000, std::uint32_t, Read_write_t, Simulated_bus>;
+    using DR = core::Register<0x40000004, std::uint32_t, Write_only_t, Simulated_bus>;
+    using SR = core::Register<0x40000008, std::uint32_t, Read_only_t, Simulated_bus>;
+
+    using EN = core::Field<CR, 0, 1, Read_write_t>;
+    using MODE = core::Field<CR, 4, 3, Read_write_t>;
+    using DATA = core::Field<DR, 0, 16, Write_only_t>;
+    using READY = core::Field<SR, 7, 1, Read_only_t>;
+
+    using Enable = core::Field_value<EN, 1>;
+    using Mode5 = core::Field_value<MODE, 5>;
+    using Data = core::Field_value<DATA, 0x1234>;
+    using Ready = core::Field_value<READY, 1>;
+
+    static_assert(std::is_same_v<core::Register<0x40000000, std::uint32_t, Read_write_t>::Bus_t, core::Mmio_bus>,
+                  "volatile MMIO must stay the default bus policy");
+
+    using HR = core::Register<0x4000000C, std::uint16_t, Read_write_t, Simulated_bus>;
+    using LOW = core::Field<HR, 0, 8, Read_write_t>;
+    using HIGH = core::Field<HR, 8, 8, Read_write_t>;
+
+    using STATUS = CortexM3::Register<0x40000010, std::uint32_t, Read_write_t, Simulated_bus>;
+    using FLAG_IE = CortexM3::Field<STATUS, 8, 1, Read_write_t>;
+    using Flag_interrupt = core::Field_value<FLAG_IE, 1>;
+    using BIT_EN = CortexM3::Field<CR, 0, 1, Read_write_t>;
+
+    // Запись в псевдоним слова с аппаратно изменяемыми битами сбросила бы флаги
+    template<typename F>
+    concept Bit_band_field = requires { F::bit_band_alias(); };
+
+    static_assert(Bit_band_field<BIT_EN>);
+    static_assert(!Bit_band_field<FLAG_IE>);
+    static_assert(Values<core::Field_value<BIT_EN, 1>>::SetReads() == 0);
+    static_assert(Values<Flag_interrupt>::SetReads() == 1);
+
+    void values_set()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(CR::address(), 0xFFFF0000);
+        CR::values_set<Enable, Mode5>();
+        CHECK_EQUAL(Simulated_bus::reads(CR::address()), 1);
+        CHECK_EQUAL(Simulated_bus::writes(CR::address()), 1);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0xFFFF0051);
+    }
+
+    void values_write()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(CR::address(), 0xFFFF0000);
+        CR::values_write<Enable, Mode5>();
+        DR::values_write<Data>();
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(), 2);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0x51);
+        CHECK_EQUAL(Simulated_bus::peek(DR::address()), 0x1234);
+    }
+
+    void values_is_set()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(SR::address(), 0x80);
+        CHECK(SR::values_is_set<Ready>());
+        Simulated_bus::poke(SR::address(), 0x00);
+        CHECK(!SR::values_is_set<Ready>());
+        CHECK_EQUAL(Simulated_bus::reads(SR::address()), 2);
+        CHECK_EQUAL(Simulated_bus::writes(), 0);
+    }
+
+    void bits_toggle()
+    {
+        Simulated_bus::clear();
+        CR::bits_toggle(0x0F);
+        CHECK_EQUAL(Simulated_bus::reads(), 1);
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0x0F);
+    }
+
+    void values_plan()
+    {
+        Simulated_bus::clear();
+        using Init = Values<Enable, Data, Mode5>;
+        Init::Set();
+        CHECK_EQUAL(Simulated_bus::reads(), Init::SetReads());
+        CHECK_EQUAL(Simulated_bus::writes(), Init::SetWrites());
+        CHECK_EQUAL(Simulated_bus::reads(DR::address()), 0);
+
+        Simulated_bus::reset_counters();
+        CHECK(Values<Enable, Mode5>::IsSet());
+        CHECK_EQUAL(Simulated_bus::reads(CR::address()), 1);
+    }
+
+    void counters()
+    {
+        Simulated_bus::clear();
+        CR::write(1);
+        CR::read();
+        CHECK_EQUAL(Simulated_bus::reads(), 1);
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        Simulated_bus::reset_counters();
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(CR::address()), 0);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 1);
+    }
+
+    /// Обработчик записи вызывается и при записи в псевдоним bit-band, и при атомарном изменении
+    void write_hooks()
+    {
+        Simulated_bus::clear();
+        std::vector<std::uint32_t> written;
+        Simulated_bus::on_write(CR::address(), [&written](std::uint32_t value) { written.push_back(value); });
+        Simulated_bus::poke(CR::address(), 0xF0);
+
+        Simulated_bus::write<std::uint32_t>(CortexM3::bit_band_alias(CR::address(), 2), 1);
+        Simulated_bus::write<std::uint32_t>(CortexM3::bit_band_alias(CR::address(), 4), 0);
+        size_t retries = 0;
+        Simulated_bus::modify_exclusive<std::uint32_t>(CR::address(), [](std::uint32_t v) { return v | 0x100; }, retries);
+        CHECK_EQUAL(written.size(), 3);
+        CHECK_EQUAL(written.at(0), 0xF4);
+        CHECK_EQUAL(written.at(1), 0xE4);
+        CHECK_EQUAL(written.at(2), 0x1E4);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0x1E4);
+        Simulated_bus::on_write(CR::address(), {});
+    }
+
+    /// Однобитовое поле регистра с аппаратно изменяемыми битами - чтение-модификация-запись слова
+    void hardware_modified_bit()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(STATUS::address(), 0x05);
+        Values<Flag_interrupt>::Set();
+        CHECK_EQUAL(Simulated_bus::reads(STATUS::address()), 1);
+        CHECK_EQUAL(Simulated_bus::writes(STATUS::address()), 1);
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        CHECK_EQUAL(Simulated_bus::peek(STATUS::address()), 0x105);
+    }
+
+    /// Поля, известные во время выполнения: одно чтение-модификация-запись на все поля
+    void fields_set()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(CR::address(), 0xFFFF0000);
+        volatile std::uint32_t enable = 1, mode = 5;
+        CR::fields_set<EN, MODE>(enable, mode);
+        CHECK_EQUAL(Simulated_bus::reads(), 1);
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0xFFFF0051);
+
+        // Лишние старшие разряды значения отбрасываются и не задевают соседние поля
+        volatile std::uint32_t wide = 0x1F;
+        MODE::set(wide);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0xFFFF0071);
+        CHECK_EQUAL(MODE::get(), 7);
+        CHECK_EQUAL(EN::get(), 1);
+    }
+
+    /// Поля покрывают весь регистр: запись без чтения
+    void fields_set_full_mask()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(HR::address(), 0xFFFF);
+        volatile std::uint16_t low = 0x34, high = 0x12;
+        HR::fields_set<HIGH, LOW>(high, low);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        CHECK_EQUAL(Simulated_bus::peek(HR::address()), 0x1234);
+    }
+
+    /// Запись без чтения сбрасывает поля, не перечисленные в списке
+    void fields_write()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(CR::address(), 0xFFFF0000);
+        volatile std::uint32_t mode = 3, data = 0xABCD;
+        CR::fields_write<MODE, EN>(mode, 1);
+        DATA::write(data);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(), 2);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0x31);
+        CHECK_EQUAL(Simulated_bus::peek(DR::address()), 0xABCD);
+    }
+
+    void fields_set_atomic()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(CR::address(), 0xFFFF00F0);
+        volatile std::uint32_t mode = 2;
+        CR::fields_set_atomic<MODE, EN>(mode, 1);
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0xFFFF00A1);
+    }
+
+    /// Однобитовое поле bit-band: set(v) и get() - одно обращение к псевдониму, без чтения слова
+    void bit_band_set()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(CR::address(), 0xF0);
+        volatile std::uint32_t on = 1, off = 2;
+        BIT_EN::set(on);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        CHECK_EQUAL(Simulated_bus::writes(BIT_EN::bit_band_alias()), 1);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0xF1);
+        CHECK_EQUAL(BIT_EN::get(), 1);
+        CHECK_EQUAL(Simulated_bus::reads(BIT_EN::bit_band_alias()), 1);
+        // Записывается только младший разряд значения
+        BIT_EN::set(off);
+        CHECK_EQUAL(Simulated_bus::peek(CR::address()), 0xF0);
+        CHECK_EQUAL(Simulated_bus::reads(CR::address()), 0);
+    }
+}
+
+int main()
+{
+    values_set();
+    values_write();
+    values_is_set();
+    bits_toggle();
+    values_plan();
+    counters();
+    write_hooks();
+    hardware_modified_bit();
+    fields_set();
+    fields_set_full_mask();
+    fields_write();
+    fields_set_atomic();
+    bit_band_set();
+    return test::result();
+}
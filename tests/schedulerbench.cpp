@@ -0,0 +1,56 @@
+#include <cstdint>
+
+#include "bench.hpp"
+#include "check.hpp"
+#include "scheduler.hpp"
+
+using namespace metaMCU;
+
+namespace {
+    constexpr size_t operations = 4'000'000;
+
+    std::uint32_t runs = 0;
+
+    void work() { ++runs; }
+    void other() {}
+
+    using Work = Task<work, 3>;
+    using Tasks = Scheduler<Task<other, 0, 7>, Task<other, 1, 11>, Task<other, 2>, Work>;
+
+    /// post и выбор задачи CLZ с вызовом через таблицу функций
+    void post_and_dispatch()
+    {
+        runs = 0;
+        test::benchmark("post + run_once", operations, []
+        {
+            for (size_t i = 0; i < operations; ++i)
+            {
+                Tasks::post<Work>();
+                Tasks::run_once();
+            }
+        });
+        CHECK_EQUAL(runs, operations);
+    }
+
+    /// Тик без наступивших сроков и с проверкой периодических задач
+    void tick()
+    {
+        test::benchmark("tick with 2 periodic tasks", operations, []
+        {
+            for (size_t i = 0; i < operations; ++i)
+            {
+                Tasks::tick();
+                if (!Tasks::idle())
+                    Tasks::run_pending();
+            }
+        });
+        CHECK_EQUAL(Tasks::time(), operations);
+    }
+}
+
+int main()
+{
+    post_and_dispatch();
+    tick();
+    return test::result();
+}
@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <vector>
+
+#include "check.hpp"
+#include "scheduler.hpp"
+
+using namespace metaMCU;
+
+namespace {
+    std::vector<char> trace;
+
+    void fast() { trace.push_back('f'); }
+    void slow() { trace.push_back('s'); }
+    void event() { trace.push_back('e'); }
+
+    using Fast = Task<fast, 1, 2>;
+    using Slow = Task<slow, 2, 5>;
+    using Event = Task<event, 0>;
+    using Tasks = Scheduler<Slow, Event, Fast>;
+
+    using Idle_task = Task<event, 0>;
+    using Events_only = Scheduler<Idle_task>;
+
+    /// Периодические задачи запускаются в свои сроки, готовые - по приоритету
+    void deadlines()
+    {
+        trace.clear();
+        CHECK_EQUAL(Tasks::ticks_to_wakeup(), 2);
+        Tasks::tick();
+        CHECK_EQUAL(Tasks::run_pending(), 0);
+        CHECK_EQUAL(Tasks::ticks_to_wakeup(), 1);
+
+        Tasks::tick();
+        CHECK_EQUAL(Tasks::run_pending(), 1);
+        CHECK_EQUAL(Tasks::ticks_to_wakeup(), 2);
+
+        Tasks::advance(3);
+        CHECK_EQUAL(Tasks::time(), 5);
+        Tasks::post<Event>();
+        CHECK_EQUAL(Tasks::run_pending(), 3);
+        CHECK(trace == (std::vector<char>{'f', 'e', 'f', 's'}));
+        CHECK_EQUAL(Tasks::ticks_to_wakeup(), 1);
+        CHECK_EQUAL(Tasks::overruns<Fast>(), 0);
+        CHECK_EQUAL(Tasks::overruns<Slow>(), 0);
+    }
+
+    /// Срок, наступивший до выполнения задачи, считается пропущенным
+    void overruns()
+    {
+        // Время 5, Fast готова в 6, Slow - в 10
+        Tasks::tick();
+        Tasks::advance(2);
+        CHECK_EQUAL(Tasks::overruns<Fast>(), 1);
+        // Сроки Fast 10, 12, 14 и Slow 10 за один шаг: Fast еще готова, все три пропущены
+        Tasks::advance(6);
+        CHECK_EQUAL(Tasks::time(), 14);
+        CHECK_EQUAL(Tasks::overruns<Fast>(), 4);
+        CHECK_EQUAL(Tasks::overruns<Slow>(), 0);
+        trace.clear();
+        CHECK_EQUAL(Tasks::run_pending(), 2);
+        CHECK(trace == (std::vector<char>{'f', 's'}));
+        CHECK_EQUAL(Tasks::ticks_to_wakeup(), 1);
+    }
+
+    struct Stop {};
+
+    /// Задача, отмеченная прерыванием между run_once и сном, не теряется
+    void no_lost_wakeup()
+    {
+        trace.clear();
+        int sleeps = 0, waits = 0;
+        try
+        {
+            Events_only::run([&](Events_only::Tick ticks)
+            {
+                CHECK_EQUAL(ticks, Events_only::no_wakeup);
+                if (++sleeps == 3)
+                    throw Stop{};
+                // Прерывание между проверкой в run и входом в сон
+                if (sleeps == 1)
+                    Events_only::post<Idle_task>();
+                // Повторная проверка под запретом прерываний
+                if (Events_only::idle())
+                    ++waits;
+            });
+        }
+        catch (Stop)
+        {
+        }
+        CHECK_EQUAL(waits, 1);
+        CHECK(trace == (std::vector<char>{'e'}));
+    }
+}
+
+int main()
+{
+    deadlines();
+    overruns();
+    no_lost_wakeup();
+    return test::result();
+}
@@ -0,0 +1,77 @@
+#include <cstdint>
+
+#include "check.hpp"
+#include "field.hpp"
+#include "shadowregister.hpp"
+#include "simulatedbus.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+template<>
+struct metaMCU::Hardware_modified_bits<0x40020010> : std::integral_constant<size_t, 0xFFFF> {};
+
+namespace {
+    /// GPIOA MODER: PA13, PA14 (SWD) и PA15 в режиме AF после сброса
+    using MODER = core::Shadow_register<0x40020000, std::uint32_t, Read_write_t, 0xA8000000, Simulated_bus>;
+    using BSRR = core::Shadow_register<0x40020018, std::uint32_t, Write_only_t, 0, Simulated_bus>;
+
+    using MODER5 = core::Field<MODER, 10, 2, Read_write_t>;
+    using MODER13 = core::Field<MODER, 26, 2, Read_write_t>;
+    using BS5 = core::Field<BSRR, 5, 1, Write_only_t>;
+
+    static_assert(MODER::read_accesses == 0);
+    static_assert(!Can_shadow<0x40020010, Read_write_t>, "registers with hardware-modified bits must not be shadowed");
+
+    void reset_value_is_kept()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(MODER::address(), 0xA8000000);
+        MODER::values_set<core::Field_value<MODER5, 0b01>>();
+        CHECK_EQUAL(Simulated_bus::peek(MODER::address()), 0xA8000400);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        CHECK(MODER::values_is_set<core::Field_value<MODER13, 0b10>>());
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+    }
+
+    void sync_and_flush()
+    {
+        Simulated_bus::clear();
+        Simulated_bus::poke(MODER::address(), 0x12345678);
+        MODER::sync();
+        CHECK_EQUAL(MODER::read(), 0x12345678);
+        CHECK_EQUAL(Simulated_bus::reads(), 1);
+        Simulated_bus::poke(MODER::address(), 0);
+        MODER::flush();
+        CHECK_EQUAL(Simulated_bus::peek(MODER::address()), 0x12345678);
+    }
+
+    void toggle_and_fields()
+    {
+        Simulated_bus::clear();
+        MODER::write(0xA8000000);
+        MODER::bits_toggle(0x3);
+        MODER::fields_set<MODER5>(0b11);
+        CHECK_EQUAL(Simulated_bus::peek(MODER::address()), 0xA8000C03);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Simulated_bus::writes(), 3);
+    }
+
+    void write_only_set()
+    {
+        Simulated_bus::clear();
+        BSRR::values_set<core::Field_value<BS5, 1>>();
+        CHECK_EQUAL(Simulated_bus::peek(BSRR::address()), 1U << 5);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+    }
+}
+
+int main()
+{
+    reset_value_is_kept();
+    sync_and_flush();
+    toggle_and_fields();
+    write_only_set();
+    return test::result();
+}
@@ -0,0 +1,105 @@
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "check.hpp"
+#include "field.hpp"
+#include "simulatedbus.hpp"
+#include "snapshot.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+
+namespace {
+    /// Simulated_bus, запоминающая адреса чтений по порядку
+    struct Traced_bus : Simulated_bus
+    {
+        template<typename Value_t>
+        static Value_t read(size_t address)
+        {
+            order.push_back(address);
+            return Simulated_bus::read<Value_t>(address);
+        }
+
+        static inline std::vector<size_t> order;
+    };
+
+    using SR = core::Register<0x40011000, std::uint16_t, Read_only_t, Traced_bus>;
+    using DR = core::Register<0x40011004, std::uint16_t, Read_write_t, Traced_bus>;
+    using LISR = core::Register<0x40026400, std::uint32_t, Read_only_t, Traced_bus>;
+    using NDTR = core::Register<0x40026444, std::uint32_t, Read_write_t, Traced_bus>;
+
+    using RXNE = core::Field<SR, 5, 1, Read_only_t>;
+    using ORE = core::Field<SR, 3, 1, Read_only_t>;
+    using DATA = core::Field<DR, 0, 9, Read_write_t>;
+    using TCIF2 = core::Field<LISR, 21, 1, Read_only_t>;
+    using HTIF2 = core::Field<LISR, 20, 1, Read_only_t>;
+    using NDT = core::Field<NDTR, 0, 16, Read_write_t>;
+
+    using Overrun = core::Field_value<ORE, 1>;
+    using Half = core::Field_value<HTIF2, 1>;
+
+    /// Регистры полей: NDTR, SR, LISR, SR, DR, LISR - первое упоминание определяет порядок чтения
+    using Status = core::Snapshot<NDT, RXNE, TCIF2, Overrun, DATA, Half>;
+    static_assert(Status::reads() == 4);
+    static_assert(core::Snapshot<RXNE, ORE>::reads() == 1);
+
+    void reset()
+    {
+        Simulated_bus::clear();
+        Traced_bus::order.clear();
+        Simulated_bus::poke(SR::address(), 1U << 5 | 1U << 3);
+        Simulated_bus::poke(DR::address(), 0x1A5);
+        Simulated_bus::poke(LISR::address(), 1U << 21);
+        Simulated_bus::poke(NDTR::address(), 0x12345);
+    }
+
+    /// Одно чтение каждого регистра в порядке первого упоминания
+    void read_order()
+    {
+        reset();
+        const auto status = Status::read();
+        CHECK(Traced_bus::order == (std::vector<size_t>{NDTR::address(), SR::address(), LISR::address(), DR::address()}));
+        CHECK_EQUAL(Simulated_bus::reads(), Status::reads());
+        for (const size_t address : {SR::address(), DR::address(), LISR::address(), NDTR::address()})
+            CHECK_EQUAL(Simulated_bus::reads(address), 1);
+
+        // Значения берутся из снимка, без обращений к шине
+        Simulated_bus::reset_counters();
+        CHECK_EQUAL(status.get<NDT>(), 0x2345);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+    }
+
+    void values()
+    {
+        reset();
+        const auto status = Status::read();
+        // Изменение регистра после чтения не влияет на снимок
+        Simulated_bus::poke(SR::address(), 0);
+
+        CHECK_EQUAL(status.get<RXNE>(), 1);
+        CHECK_EQUAL(status.get<ORE>(), 1);
+        CHECK_EQUAL(status.get<DATA>(), 0x1A5);
+        CHECK_EQUAL(status.get<TCIF2>(), 1);
+        CHECK_EQUAL(status.get<HTIF2>(), 0);
+        CHECK_EQUAL(status.get<NDT>(), 0x2345);
+        CHECK(status.is_set<Overrun>());
+        CHECK(!status.is_set<Half>());
+        CHECK(status.is_set<core::Field_value<DATA, 0x1A5>>());
+        CHECK(!status.is_set<core::Field_value<DATA, 0x0A5>>());
+
+        CHECK_EQUAL(status.word<SR>(), 1U << 5 | 1U << 3);
+        CHECK_EQUAL(status.word<DR>(), 0x1A5);
+        CHECK_EQUAL(status.word<LISR>(), 1U << 21);
+        CHECK_EQUAL(status.word<NDTR>(), 0x12345);
+        static_assert(std::is_same_v<decltype(status.word<SR>()), std::uint16_t>);
+        static_assert(std::is_same_v<decltype(status.get<NDT>()), std::uint32_t>);
+    }
+}
+
+int main()
+{
+    read_order();
+    values();
+    return test::result();
+}
@@ -0,0 +1,147 @@
+#include <cstdint>
+
+#include "check.hpp"
+#include "simulatedbus.hpp"
+#include "simulatedtimer.hpp"
+#include "timer.hpp"
+
+using namespace metaMCU;
+using core::Simulated_bus;
+using timer::Output_mode;
+using timer::solve;
+
+namespace {
+    // Точная частота: наименьший предделитель, при котором период помещается в ARR
+    static_assert(solve(84'000'000, 1000).psc == 1 && solve(84'000'000, 1000).arr == 41999);
+    static_assert(solve(84'000'000, 1000, 0, 0xFFFFFFFF).psc == 0 && solve(84'000'000, 1000, 0, 0xFFFFFFFF).arr == 83999);
+    // Неточная частота: ошибка округления периода
+    static_assert(solve(84'000'000, 44100).psc == 0 && solve(84'000'000, 44100).arr == 1904);
+    static_assert(solve(84'000'000, 44100).error_ppm == 125);
+    // Без допуска - точное решение, с допуском - большее разрешение
+    static_assert(solve(84'000'000, 7).psc == 191 && solve(84'000'000, 7).arr == 62499);
+    static_assert(solve(84'000'000, 7).error_ppm == 0);
+    static_assert(solve(84'000'000, 7, 100).psc == 183 && solve(84'000'000, 7, 100).arr == 65216);
+    static_assert(solve(84'000'000, 7, 100).error_ppm == 6);
+    // Недостижимые частоты
+    static_assert(!solve(84'000'000, 0).valid);
+    static_assert(!solve(84'000'000, 42'000'001).valid);
+    static_assert(solve(84'000'000, 42'000'000).valid && solve(84'000'000, 42'000'000).arr == 1);
+    static_assert(!solve(84'000'000, 1, 0, 0xFFFF, 0xFF).valid);
+
+    using Pwm_base = timer::Time_base<1'000'000, 1000>;
+    static_assert(Pwm_base::psc == 0 && Pwm_base::period == 1000);
+    static_assert(Pwm_base::compare(1, 4) == 250 && Pwm_base::compare(2, 3) == 667);
+
+    using TIM3 = timer::Timer<0x40000400, 16, false, Simulated_bus>;
+    using TIM1 = timer::Timer<0x40010000, 16, true, Simulated_bus>;
+    using Tim3 = timer::Simulated_timer<TIM3>;
+
+    void attach()
+    {
+        Simulated_bus::clear();
+        Tim3::attach();
+    }
+
+    /// Количество тактов с активным выходом канала за period тактов
+    template<size_t channel>
+    std::uint32_t active_clocks(std::uint32_t period)
+    {
+        std::uint32_t active = 0;
+        for (std::uint32_t i = 0; i < period; ++i)
+        {
+            active += Tim3::output<channel>();
+            Tim3::advance(1);
+        }
+        return active;
+    }
+
+    /// configure загружает PSC и ARR в рабочие регистры и сбрасывает UIF
+    void configure()
+    {
+        attach();
+        TIM3::configure<Pwm_base>();
+        CHECK_EQUAL(Tim3::active_psc(), 0);
+        CHECK_EQUAL(Tim3::active_arr(), 999);
+        CHECK_EQUAL(Tim3::updates(), 1);
+        CHECK_EQUAL(Simulated_bus::peek(TIM3::SR::address()), 0);
+        CHECK_EQUAL(Simulated_bus::peek(TIM3::CR1::address()), 1U << 7);
+        CHECK_EQUAL(TIM3::counter(), 0);
+    }
+
+    void pwm()
+    {
+        configure();
+        TIM3::enable_output<1>(Pwm_base::compare(1, 4));
+        CHECK_EQUAL(Simulated_bus::peek(TIM3::CCMR1::address()), 0b110U << 4 | 1U << 3);
+        CHECK_EQUAL(Simulated_bus::peek(TIM3::CCER::address()), 1);
+        CHECK_EQUAL(Tim3::active_compare<1>(), 250);
+        TIM3::start();
+        CHECK_EQUAL(active_clocks<1>(Pwm_base::period), 250);
+        CHECK_EQUAL(Tim3::updates(), 2);
+        CHECK_EQUAL(Simulated_bus::peek(TIM3::SR::address()), 1);
+        TIM3::SR::write(static_cast<std::uint32_t>(~TIM3::UIF::mask()));
+        CHECK_EQUAL(Simulated_bus::peek(TIM3::SR::address()), 0);
+
+        // Скважность: одна запись в CCR без чтения, действует со следующего периода
+        Tim3::advance(100);
+        Simulated_bus::reset_counters();
+        TIM3::set_compare<1>(Pwm_base::compare(3, 4));
+        CHECK_EQUAL(Simulated_bus::writes(), 1);
+        CHECK_EQUAL(Simulated_bus::reads(), 0);
+        CHECK_EQUAL(Tim3::active_compare<1>(), 250);
+        Tim3::advance(Pwm_base::period - 100);
+        CHECK_EQUAL(Tim3::active_compare<1>(), 750);
+        CHECK_EQUAL(active_clocks<1>(Pwm_base::period), 750);
+
+        TIM3::disable_output<1>();
+        CHECK_EQUAL(Simulated_bus::peek(TIM3::CCER::address()), 0);
+        TIM3::stop();
+        Tim3::advance(10);
+        CHECK_EQUAL(TIM3::counter(), 0);
+    }
+
+    /// Буферизованные PSC и ARR изменяются по событию обновления, ARR без ARPE - сразу
+    void preload()
+    {
+        configure();
+        TIM3::start();
+        Tim3::advance(10);
+        TIM3::ARR::write(499);
+        TIM3::PSC::write(1);
+        CHECK_EQUAL(Tim3::active_arr(), 999);
+        CHECK_EQUAL(Tim3::active_psc(), 0);
+        Tim3::advance(Pwm_base::period - 10);
+        CHECK_EQUAL(Tim3::active_arr(), 499);
+        CHECK_EQUAL(Tim3::active_psc(), 1);
+        // Период 500 отсчетов по 2 такта
+        Tim3::advance(999);
+        CHECK_EQUAL(Tim3::updates(), 2);
+        Tim3::advance(1);
+        CHECK_EQUAL(Tim3::updates(), 3);
+
+        Values<core::Field_value<TIM3::ARPE, 0>>::Set();
+        TIM3::ARR::write(99);
+        CHECK_EQUAL(Tim3::active_arr(), 99);
+        CHECK_EQUAL(Tim3::active_psc(), 1);
+    }
+
+    /// Расширенный таймер: второй канал, инверсный ШИМ и бит MOE
+    void advanced()
+    {
+        Simulated_bus::clear();
+        TIM1::enable_output<2, Output_mode::pwm2, true>(100);
+        CHECK_EQUAL(Simulated_bus::peek(TIM1::CCMR1::address()), 0b111U << 12 | 1U << 11);
+        CHECK_EQUAL(Simulated_bus::peek(TIM1::CCER::address()), 1U << 4 | 1U << 5);
+        CHECK_EQUAL(Simulated_bus::peek(TIM1::BDTR::address()), 1U << 15);
+        CHECK_EQUAL(Simulated_bus::peek(TIM1::CCR<2>::address()), 100);
+    }
+}
+
+int main()
+{
+    configure();
+    pwm();
+    preload();
+    advanced();
+    return test::result();
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""ProfileDecoder: разбирает двоичный поток статистики metaMCU::profiling::dump.
+
+Выводит для каждого места измерения количество, минимум, среднее и максимум
+длительности в тактах и гистограмму по степеням двойки.
+
+Использование:
+    profiledecoder.py dump.bin [--frequency 168e6]
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"MPR1"
+
+
+class DumpError(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def take(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.offset + size > len(self.data):
+            raise DumpError("unexpected end of dump at offset %d" % self.offset)
+        values = struct.unpack_from(fmt, self.data, self.offset)
+        self.offset += size
+        return values if len(values) > 1 else values[0]
+
+    def bytes(self, size):
+        if self.offset + size > len(self.data):
+            raise DumpError("unexpected end of dump at offset %d" % self.offset)
+        value = self.data[self.offset:self.offset + size]
+        self.offset += size
+        return value
+
+
+def decode(data):
+    """Возвращает список мест измерения в виде словарей."""
+    start = data.find(MAGIC)
+    if start < 0:
+        raise DumpError("dump signature not found")
+    reader = Reader(data[start + len(MAGIC):])
+    sites = []
+    for _ in range(reader.take("<H")):
+        name = reader.bytes(reader.take("<B")).decode("utf-8", "replace")
+        count, total, minimum, maximum, buckets = reader.take("<IQIIB")
+        histogram = {}
+        for _ in range(buckets):
+            bucket, hits = reader.take("<BI")
+            histogram[bucket] = hits
+        sites.append({"name": name, "count": count, "sum": total, "min": minimum, "max": maximum,
+                      "histogram": histogram})
+    return sites
+
+
+def bucket_range(bucket):
+    return (0, 0) if bucket == 0 else (1 << (bucket - 1), (1 << bucket) - 1)
+
+
+def print_sites(sites, frequency):
+    for site in sites:
+        count = site["count"]
+        mean = site["sum"] / count if count else 0
+        line = "%-32s n=%-10d min=%-10d mean=%-12.1f max=%-10d" % (
+            site["name"], count, site["min"] if count else 0, mean, site["max"])
+        if frequency:
+            line += " max=%.3f us" % (site["max"] * 1e6 / frequency)
+        print(line)
+        for bucket in sorted(site["histogram"]):
+            low, high = bucket_range(bucket)
+            print("    %10d..%-10d %d" % (low, high, site["histogram"][bucket]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode metaMCU profiling dump")
+    parser.add_argument("dump", help="binary dump file, '-' for stdin")
+    parser.add_argument("--frequency", type=float, default=0, help="counter frequency in Hz to print times")
+    args = parser.parse_args()
+
+    data = sys.stdin.buffer.read() if args.dump == "-" else open(args.dump, "rb").read()
+    try:
+        print_sites(decode(data), args.frequency)
+    except DumpError as error:
+        print("error: %s" % error, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,444 @@
+#!/usr/bin/env python3
+"""RegistersGenerator: генерирует заголовочные файлы регистров metaMCU из SVD файла.
+
+Для каждой периферии в выходной каталог записывается <periph>.hpp, а также
+общий заголовок <device>.hpp, включающий их все. Каждый заголовок содержит:
+
+* пространство имен на каждый регистр с псевдонимом Register типа core::Register
+  (или core::Shadow_register для регистров из --shadow) и constexpr reset_value;
+* структуру на каждое поле, наследующую core::Field, с псевдонимами
+  core::Field_value для перечисленных в SVD значений,
+  например GPIOA::MODER::MODER5::Output::set();
+* специализации Hardware_modified_bits для регистров с аппаратно изменяемыми
+  битами, чтобы такие регистры нельзя было кэшировать;
+* constexpr таблицу core::Field_layout со всеми полями периферии.
+
+С ключом --fast перезаписываются только периферии, описание которых в SVD
+(или параметры генератора) изменилось с прошлого запуска. Для проверки
+используется хэш, записанный в первой строке каждого заголовка.
+
+С ключом --only генерируются заголовки только перечисленных периферий,
+общий заголовок <device>.hpp при этом по-прежнему включает все периферии.
+
+Использование:
+    registersgenerator.py device.svd -o include/device [--fast]
+        [--bus metaMCU::core::Simulated_bus --bus-header simulatedbus.hpp]
+        [--shadow GPIOA.MODER ...] [--only GPIOA RCC ...]
+"""
+
+import argparse
+import copy
+import hashlib
+import keyword
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+GENERATOR_VERSION = "2"
+HASH_PREFIX = "// RegistersGenerator hash: "
+
+ACCESS_TYPES = {
+    "read-only": "Read_only_t",
+    "write-only": "Write_only_t",
+    "read-write": "Read_write_t",
+    "writeOnce": "Write_only_t",
+    "read-writeOnce": "Read_write_t",
+}
+
+LAYOUT_ACCESS = {
+    "Read_only_t": "core::Field_access::read_only",
+    "Write_only_t": "core::Field_access::write_only",
+    "Read_write_t": "core::Field_access::read_write",
+}
+
+VALUE_TYPES = {8: "std::uint8_t", 16: "std::uint16_t", 32: "std::uint32_t"}
+
+# Значения modifiedWriteValues, при которых записанное значение не сохраняется в регистре
+HARDWARE_WRITE_VALUES = {"oneToClear", "oneToSet", "oneToToggle", "zeroToClear", "zeroToSet", "zeroToToggle", "clear", "set"}
+
+CPP_RESERVED = set(keyword.kwlist) | {
+    "alignas", "alignof", "and", "asm", "auto", "bool", "case", "char", "class", "const", "default",
+    "delete", "do", "double", "enum", "explicit", "export", "extern", "float", "for", "friend", "goto",
+    "inline", "int", "long", "mutable", "namespace", "new", "not", "operator", "or", "private",
+    "protected", "public", "register", "short", "signed", "sizeof", "static", "struct", "switch",
+    "template", "this", "throw", "typedef", "typeid", "typename", "union", "unsigned", "using",
+    "virtual", "void", "volatile", "xor",
+}
+
+
+class SvdError(Exception):
+    pass
+
+
+def parse_int(text):
+    """Разбирает число в формате SVD: десятичное, 0x..., #... (двоичное)."""
+    text = text.strip().lower()
+    if text.startswith("#"):
+        return int(text[1:].replace("x", "0"), 2)
+    if text.startswith("0b"):
+        return int(text[2:].replace("x", "0"), 2)
+    return int(text, 0)
+
+
+def identifier(name):
+    """Приводит имя из SVD к корректному идентификатору C++."""
+    name = re.sub(r"[^0-9A-Za-z_]", "_", name.strip())
+    if not name or name[0].isdigit():
+        name = "_" + name
+    if name in CPP_RESERVED:
+        name += "_"
+    return name
+
+
+def text(element, tag, default=None):
+    child = element.find(tag)
+    if child is None or child.text is None:
+        return default
+    return child.text.strip()
+
+
+def description(element):
+    value = text(element, "description", "")
+    return " ".join(value.split())
+
+
+class Field:
+    def __init__(self, name, offset, width, access, enums, hardware, desc):
+        self.name = name
+        self.offset = offset
+        self.width = width
+        self.access = access
+        self.enums = enums
+        self.hardware = hardware
+        self.description = desc
+
+    @property
+    def mask(self):
+        return ((1 << self.width) - 1) << self.offset
+
+
+class Register:
+    def __init__(self, name, address, size, access, reset_value, fields, desc):
+        self.name = name
+        self.address = address
+        self.size = size
+        self.access = access
+        self.reset_value = reset_value
+        self.fields = fields
+        self.description = desc
+
+    @property
+    def hardware_mask(self):
+        mask = 0
+        for field in self.fields:
+            if field.hardware:
+                mask |= field.mask
+        return mask
+
+
+class Peripheral:
+    def __init__(self, name, base_address, registers, desc, source):
+        self.name = name
+        self.base_address = base_address
+        self.registers = registers
+        self.description = desc
+        self.source = source
+
+
+def expand_dim(element, name):
+    """Возвращает список (имя, смещение) для элементов с dim/dimIncrement/dimIndex."""
+    dim = text(element, "dim")
+    if dim is None:
+        return [(name, 0)]
+    count = parse_int(dim)
+    increment = parse_int(text(element, "dimIncrement", "0"))
+    index = text(element, "dimIndex")
+    if index is None:
+        indices = [str(i) for i in range(count)]
+    elif "-" in index and "," not in index:
+        first, last = index.split("-")
+        if first.isdigit():
+            indices = [str(i) for i in range(int(first), int(last) + 1)]
+        else:
+            indices = [chr(c) for c in range(ord(first), ord(last) + 1)]
+    else:
+        indices = index.split(",")
+    if len(indices) != count:
+        raise SvdError("dimIndex of %s does not match dim" % name)
+    return [(name.replace("[%s]", i).replace("%s", i), n * increment) for n, i in enumerate(indices)]
+
+
+def parse_fields(register, register_access):
+    fields = []
+    fields_element = register.find("fields")
+    if fields_element is None:
+        return fields
+    for field in fields_element.findall("field"):
+        for name, step in expand_dim(field, text(field, "name")):
+            if text(field, "bitOffset") is not None:
+                offset = parse_int(text(field, "bitOffset"))
+                width = parse_int(text(field, "bitWidth", "1"))
+            elif text(field, "lsb") is not None:
+                offset = parse_int(text(field, "lsb"))
+                width = parse_int(text(field, "msb")) - offset + 1
+            elif text(field, "bitRange") is not None:
+                msb, lsb = text(field, "bitRange").strip("[]").split(":")
+                offset = parse_int(lsb)
+                width = parse_int(msb) - offset + 1
+            else:
+                raise SvdError("field %s has no bit position" % name)
+            offset += step
+
+            access = ACCESS_TYPES[text(field, "access", register_access)]
+            hardware = (
+                (access == "Read_only_t" and register_access != "read-only")
+                or text(field, "readAction") is not None
+                or text(field, "modifiedWriteValues", "modify") in HARDWARE_WRITE_VALUES
+            )
+
+            enums = []
+            for values in field.findall("enumeratedValues"):
+                if text(values, "usage", "read-write") == "read":
+                    continue
+                for value in values.findall("enumeratedValue"):
+                    value_text = text(value, "value")
+                    # isDefault и значения с безразличными битами (#1x0) не задают конкретного значения
+                    if value_text is None or (value_text.startswith("#") and "x" in value_text.lower()):
+                        continue
+                    enums.append((identifier(text(value, "name")), parse_int(value_text), description(value)))
+
+            fields.append(Field(identifier(name), offset, width, access, enums, hardware, description(field)))
+    return fields
+
+
+def parse_registers(container, base_address, defaults):
+    registers = []
+    registers_element = container if container.tag == "cluster" else container.find("registers")
+    if registers_element is None:
+        return registers
+
+    for element in registers_element:
+        if element.tag == "cluster":
+            offset = parse_int(text(element, "addressOffset"))
+            for prefix, step in expand_dim(element, text(element, "name")):
+                prefix = identifier(prefix)
+                for register in parse_registers(element, base_address + offset + step, defaults):
+                    register.name = prefix + "_" + register.name
+                    registers.append(register)
+            continue
+        if element.tag != "register":
+            continue
+
+        size = parse_int(text(element, "size", str(defaults["size"])))
+        access = text(element, "access", defaults["access"])
+        reset_value = parse_int(text(element, "resetValue", str(defaults["resetValue"])))
+        offset = parse_int(text(element, "addressOffset"))
+        if size not in VALUE_TYPES:
+            raise SvdError("register %s has unsupported size %d" % (text(element, "name"), size))
+
+        for name, step in expand_dim(element, text(element, "name")):
+            registers.append(Register(identifier(name), base_address + offset + step, size,
+                                      ACCESS_TYPES[access], reset_value & ((1 << size) - 1),
+                                      parse_fields(element, access), description(element)))
+    return registers
+
+
+def parse_svd(path):
+    """Разбирает SVD файл, возвращает (имя устройства, список Peripheral)."""
+    root = ET.parse(path).getroot()
+    device = identifier(text(root, "name", "device"))
+    device_defaults = {
+        "size": parse_int(text(root, "size", "32")),
+        "access": text(root, "access", "read-write"),
+        "resetValue": parse_int(text(root, "resetValue", "0")),
+    }
+
+    elements = {text(p, "name"): p for p in root.find("peripherals").findall("peripheral")}
+    peripherals = []
+    for name, element in elements.items():
+        source = element
+        derived = element.get("derivedFrom")
+        if derived is not None:
+            if derived not in elements:
+                raise SvdError("peripheral %s derived from unknown %s" % (name, derived))
+            source = copy.deepcopy(elements[derived])
+            for child in element:
+                old = source.find(child.tag)
+                if old is not None:
+                    source.remove(old)
+                source.append(child)
+
+        defaults = {
+            "size": parse_int(text(source, "size", str(device_defaults["size"]))),
+            "access": text(source, "access", device_defaults["access"]),
+            "resetValue": parse_int(text(source, "resetValue", str(device_defaults["resetValue"]))),
+        }
+        base_address = parse_int(text(source, "baseAddress"))
+        peripherals.append(Peripheral(identifier(name), base_address,
+                                      parse_registers(source, base_address, defaults),
+                                      description(source), ET.tostring(source)))
+    return device, peripherals
+
+
+def peripheral_hash(peripheral, options):
+    digest = hashlib.sha256()
+    digest.update(GENERATOR_VERSION.encode())
+    digest.update(repr(options).encode())
+    digest.update(peripheral.source)
+    return digest.hexdigest()
+
+
+def comment(desc, indent):
+    return "%s/// \\brief %s\n" % (indent, desc) if desc else ""
+
+
+def generate_peripheral(device, peripheral, options, digest):
+    guard = "%s_%s_HPP" % (device.upper(), peripheral.name.upper())
+    bus = ", " + options["bus"] if options["bus"] else ""
+    out = []
+    out.append(HASH_PREFIX + digest + "\n")
+    out.append("// Generated by RegistersGenerator, do not edit.\n")
+    out.append("#ifndef %s\n#define %s\n\n" % (guard, guard))
+    out.append("#include <array>\n#include <cstdint>\n#include <type_traits>\n\n")
+    out.append('#include "field.hpp"\n#include "register.hpp"\n')
+    if any("%s.%s" % (peripheral.name, r.name) in options["shadow"] for r in peripheral.registers):
+        out.append('#include "shadowregister.hpp"\n')
+    if options["bus_header"]:
+        out.append('#include "%s"\n' % options["bus_header"])
+
+    # Специализации - до псевдонимов регистров: ограничения Shadow_register (Can_shadow)
+    # проверяются при первом упоминании регистра и инстанцируют Hardware_modified_bits
+    hardware = [r for r in peripheral.registers if r.hardware_mask]
+    if hardware:
+        out.append("\nnamespace metaMCU {\n")
+        for register in hardware:
+            out.append("    template<> struct Hardware_modified_bits<0x%08X> : std::integral_constant<size_t, 0x%X> {};\n"
+                       % (register.address, register.hardware_mask))
+        out.append("}\n")
+
+    out.append("\nnamespace metaMCU::%s::%s {\n\n" % (device, peripheral.name))
+    out.append("    inline constexpr size_t base_address = 0x%08X;\n\n" % peripheral.base_address)
+
+    for register in peripheral.registers:
+        value_t = VALUE_TYPES[register.size]
+        shadow = "%s.%s" % (peripheral.name, register.name) in options["shadow"]
+        if shadow:
+            base = "core::Shadow_register<0x%08X, %s, %s, 0x%X, %s>" % (
+                register.address, value_t, register.access, register.reset_value, options["bus"] or "core::Mmio_bus")
+        else:
+            base = "core::Register<0x%08X, %s, %s%s>" % (register.address, value_t, register.access, bus)
+
+        out.append(comment(register.description, "    "))
+        out.append("    namespace %s {\n" % register.name)
+        out.append("        using Register = %s;\n" % base)
+        out.append("        inline constexpr %s reset_value = 0x%X;\n" % (value_t, register.reset_value))
+        for field in register.fields:
+            name = field.name if field.name not in ("Register", "reset_value") else field.name + "_"
+            out.append("\n")
+            out.append(comment(field.description, "        "))
+            field_base = "core::Field<Register, %d, %d, %s>" % (field.offset, field.width, field.access)
+            if field.enums:
+                out.append("        struct %s : %s\n        {\n" % (name, field_base))
+                seen = set()
+                for enum_name, value, enum_desc in field.enums:
+                    if enum_name in seen or enum_name == name:
+                        continue
+                    seen.add(enum_name)
+                    out.append(comment(enum_desc, "            "))
+                    out.append("            using %s = core::Field_value<%s, %d>;\n" % (enum_name, name, value))
+                out.append("        };\n")
+            else:
+                out.append("        struct %s : %s {};\n" % (name, field_base))
+        out.append("    }\n\n")
+
+    layout = []
+    for register in peripheral.registers:
+        for field in register.fields:
+            layout.append('        {"%s", "%s", 0x%08X, %d, %d, %s}' % (
+                register.name, field.name, register.address, field.offset, field.width, LAYOUT_ACCESS[field.access]))
+    out.append("    /// \\brief Раскладка битовых полей периферии %s\n" % peripheral.name)
+    out.append("    inline constexpr std::array<core::Field_layout, %d> fields =\n    {{\n" % len(layout))
+    out.append(",\n".join(layout))
+    out.append("\n    }};\n}\n")
+
+    out.append("\n#endif // %s\n" % guard)
+    return "".join(out)
+
+
+def generate_umbrella(device, peripherals):
+    guard = "%s_HPP" % device.upper()
+    out = ["// Generated by RegistersGenerator, do not edit.\n", "#ifndef %s\n#define %s\n\n" % (guard, guard)]
+    for peripheral in peripherals:
+        out.append('#include "%s.hpp"\n' % peripheral.name.lower())
+    out.append("\n#endif // %s\n" % guard)
+    return "".join(out)
+
+
+def stored_hash(path):
+    try:
+        with open(path, encoding="utf-8") as header:
+            line = header.readline()
+    except OSError:
+        return None
+    return line[len(HASH_PREFIX):].strip() if line.startswith(HASH_PREFIX) else None
+
+
+def write_if_changed(path, content):
+    try:
+        with open(path, encoding="utf-8") as header:
+            if header.read() == content:
+                return False
+    except OSError:
+        pass
+    with open(path, "w", encoding="utf-8") as header:
+        header.write(content)
+    return True
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Generate metaMCU register headers from an SVD file")
+    parser.add_argument("svd", help="SVD file")
+    parser.add_argument("-o", "--output", required=True, help="output directory")
+    parser.add_argument("--fast", action="store_true", help="regenerate only peripherals changed since the last run")
+    parser.add_argument("--bus", default="", help="bus policy type for generated registers, e.g. metaMCU::core::Simulated_bus")
+    parser.add_argument("--bus-header", default="", help="header declaring the bus policy, e.g. simulatedbus.hpp")
+    parser.add_argument("--shadow", nargs="*", default=[], metavar="PERIPHERAL.REGISTER",
+                        help="registers generated as core::Shadow_register")
+    parser.add_argument("--only", nargs="*", default=[], metavar="PERIPHERAL", help="generate only these peripherals")
+    args = parser.parse_args(argv)
+
+    try:
+        device, peripherals = parse_svd(args.svd)
+    except (SvdError, ET.ParseError, KeyError, ValueError) as error:
+        print("%s: %s" % (args.svd, error), file=sys.stderr)
+        return 1
+
+    selected = peripherals
+    if args.only:
+        unknown = set(args.only) - {p.name for p in peripherals}
+        if unknown:
+            print("%s: unknown peripherals in --only: %s" % (args.svd, ", ".join(sorted(unknown))), file=sys.stderr)
+            return 1
+        selected = [p for p in peripherals if p.name in args.only]
+
+    options = {"bus": args.bus, "bus_header": args.bus_header, "shadow": sorted(args.shadow)}
+    os.makedirs(args.output, exist_ok=True)
+
+    written = 0
+    for peripheral in selected:
+        path = os.path.join(args.output, peripheral.name.lower() + ".hpp")
+        digest = peripheral_hash(peripheral, options)
+        if args.fast and stored_hash(path) == digest:
+            continue
+        if write_if_changed(path, generate_peripheral(device, peripheral, options, digest)):
+            written += 1
+
+    # Общий заголовок всегда включает все периферии устройства, в том числе не выбранные --only
+    write_if_changed(os.path.join(args.output, device.lower() + ".hpp"), generate_umbrella(device, peripherals))
+    print("%s: %d of %d peripheral headers updated" % (device, written, len(selected)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
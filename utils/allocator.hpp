@@ -0,0 +1,305 @@
+#ifndef ALLOCATOR_HPP
+#define ALLOCATOR_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+/*!
+ * \file
+ * \brief Файл со статическими распределителями памяти без кучи
+ *
+ * Block_pool - пул блоков одного размера, Arena - линейное выделение с общим
+ * освобождением. Выделение и освобождение выполняются за O(1) без блокировок
+ * (сравнение с обменом, LDREX/STREX на ARMv7-M) и допускаются из прерываний.
+ *
+ * Начальное состояние распределителей - нулевые байты, поэтому их можно
+ * размещать в обнуляемых при запуске областях памяти (CCM, SRAM1, SRAM2)
+ * атрибутом секции:
+ * \code
+ * [[gnu::section(".ccmram.bss")]] memory::Block_pool<64, 32> frames;
+ * \endcode
+ * Если секция не обнуляется при запуске, перед использованием вызывается reset.
+ */
+
+namespace metaMCU::memory {
+
+    constexpr size_t align_up(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    /// \brief Размер арены, вмещающей по одному объекту каждого типа с учетом выравнивания
+    template<typename... Ts>
+    consteval size_t arena_size()
+    {
+        size_t size = 0;
+        ((size = align_up(size, alignof(Ts)) + sizeof(Ts)), ...);
+        return align_up(size, alignof(std::max_align_t));
+    }
+
+    /// \brief Статистика использования распределителя
+    struct Usage
+    {
+        std::atomic<size_t> current = 0;
+        std::atomic<size_t> high_water = 0;
+        std::atomic<size_t> failures = 0;
+
+        void add(size_t amount)
+        {
+            const auto value = current.fetch_add(amount, std::memory_order_relaxed) + amount;
+            auto peak = high_water.load(std::memory_order_relaxed);
+            while (value > peak && !high_water.compare_exchange_weak(peak, value, std::memory_order_relaxed)) {}
+        }
+
+        void reset()
+        {
+            current.store(0, std::memory_order_relaxed);
+            high_water.store(0, std::memory_order_relaxed);
+            failures.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    /*!
+     * \brief Пул блоков фиксированного размера
+     *
+     * Свободные блоки образуют список, ссылки хранятся в самих блоках. Голова
+     * списка содержит счетчик изменений, исключающий проблему ABA. Блоки,
+     * ни разу не выделенные, выдаются по порядку без предварительной
+     * инициализации списка.
+     * \tparam Block_size Размер блока в байтах
+     * \tparam Blocks Количество блоков
+     * \tparam Alignment Выравнивание блоков
+     */
+    template<size_t Block_size, size_t Blocks, size_t Alignment = alignof(std::max_align_t)>
+        requires (Blocks > 0) && (Blocks < 0xFFFF) && ((Alignment & (Alignment - 1)) == 0)
+    class Block_pool
+    {
+    public:
+        /// Блок вмещает ссылку списка свободных блоков и выровнен для атомарного доступа к ней
+        static constexpr size_t alignment = Alignment < alignof(std::uint16_t) ? alignof(std::uint16_t) : Alignment;
+        static constexpr size_t block_size = align_up(Block_size < sizeof(std::uint16_t) ? sizeof(std::uint16_t) : Block_size, alignment);
+
+        /// \brief Выделяет блок, nullptr, если size больше блока или свободных блоков нет
+        void* allocate(size_t size = Block_size) noexcept
+        {
+            if (size > block_size)
+                return fail();
+
+            auto head = free.load(std::memory_order_acquire);
+            while (index(head) != 0)
+            {
+                // Блок мог быть уже выделен другим контекстом, тогда прочитанная ссылка
+                // устарела, но счетчик изменений в голове не даст ей попасть в список
+                const auto next = std::atomic_ref(link(index(head) - 1)).load(std::memory_order_relaxed);
+                if (free.compare_exchange_weak(head, pack(next, tag(head) + 1), std::memory_order_acquire))
+                    return taken(index(head) - 1);
+            }
+
+            auto fresh_index = fresh.load(std::memory_order_relaxed);
+            while (fresh_index < Blocks)
+                if (fresh.compare_exchange_weak(fresh_index, fresh_index + 1, std::memory_order_relaxed))
+                    return taken(fresh_index);
+            return fail();
+        }
+
+        /// \brief Возвращает блок в пул
+        void deallocate(void* pointer) noexcept
+        {
+            const auto block = static_cast<size_t>(static_cast<std::byte*>(pointer) - storage.data()) / block_size;
+            auto head = free.load(std::memory_order_relaxed);
+            do
+                std::atomic_ref(link(block)).store(index(head), std::memory_order_relaxed);
+            while (!free.compare_exchange_weak(head, pack(static_cast<std::uint16_t>(block + 1), tag(head) + 1), std::memory_order_release));
+            usage.current.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        /// \brief Истина, если указатель принадлежит пулу
+        bool owns(const void* pointer) const
+        {
+            const auto byte = static_cast<const std::byte*>(pointer);
+            return byte >= storage.data() && byte < storage.data() + storage.size();
+        }
+
+        /// \brief Освобождает все блоки и сбрасывает статистику
+        void reset()
+        {
+            free.store(0, std::memory_order_relaxed);
+            fresh.store(0, std::memory_order_relaxed);
+            usage.reset();
+        }
+
+        static constexpr size_t capacity()
+        {
+            return Blocks;
+        }
+
+        /// \brief Количество выделенных блоков
+        size_t in_use() const
+        {
+            return usage.current.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Наибольшее количество одновременно выделенных блоков
+        size_t high_water() const
+        {
+            return usage.high_water.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Количество неудачных выделений
+        size_t failures() const
+        {
+            return usage.failures.load(std::memory_order_relaxed);
+        }
+
+    private:
+        static constexpr std::uint16_t index(std::uint32_t head)
+        {
+            return static_cast<std::uint16_t>(head);
+        }
+
+        static constexpr std::uint32_t tag(std::uint32_t head)
+        {
+            return head >> 16;
+        }
+
+        static constexpr std::uint32_t pack(std::uint16_t index, std::uint32_t tag)
+        {
+            return (tag << 16) | index;
+        }
+
+        /// Ссылка на следующий свободный блок (номер + 1, 0 - конец списка)
+        std::uint16_t& link(size_t block)
+        {
+            return *std::launder(reinterpret_cast<std::uint16_t*>(storage.data() + block * block_size));
+        }
+
+        void* taken(size_t block)
+        {
+            usage.add(1);
+            return storage.data() + block * block_size;
+        }
+
+        void* fail()
+        {
+            usage.failures.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        alignas(alignment) std::array<std::byte, block_size * Blocks> storage;
+        /// Голова списка свободных блоков: счетчик изменений (16 бит) и номер блока + 1 (16 бит)
+        std::atomic<std::uint32_t> free = 0;
+        std::atomic<std::uint16_t> fresh = 0;
+        Usage usage;
+    };
+
+    /// \brief Пул объектов типа T
+    template<typename T, size_t Count>
+    using Object_pool = Block_pool<sizeof(T), Count, alignof(T)>;
+
+    /*!
+     * \brief Линейный распределитель
+     *
+     * Память выделяется последовательно и освобождается только целиком (reset).
+     * \tparam Size Размер в байтах, например arena_size<Buffers...>()
+     */
+    template<size_t Size>
+    class Arena
+    {
+    public:
+        /// \brief Выделяет size байт с выравниванием alignment, nullptr, если места нет
+        void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept
+        {
+            const auto base = reinterpret_cast<std::uintptr_t>(storage.data());
+            auto offset = used.load(std::memory_order_relaxed);
+            size_t start = 0;
+            do
+            {
+                start = align_up(base + offset, alignment) - base;
+                if (start + size > Size)
+                {
+                    usage.failures.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+            }
+            while (!used.compare_exchange_weak(offset, start + size, std::memory_order_relaxed));
+            usage.add(start + size - offset);
+            return storage.data() + start;
+        }
+
+        /// \brief Выделяет память под count объектов T без их создания
+        template<typename T>
+        T* allocate(size_t count = 1) noexcept
+        {
+            return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        /// \brief Создает объект T в арене, nullptr, если места нет
+        template<typename T, typename... Args>
+        T* create(Args&&... args)
+        {
+            const auto memory = allocate(sizeof(T), alignof(T));
+            return memory != nullptr ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+        }
+
+        /// \brief Освобождает всю выделенную память, деструкторы объектов не вызываются
+        void reset()
+        {
+            used.store(0, std::memory_order_relaxed);
+            usage.current.store(0, std::memory_order_relaxed);
+        }
+
+        static constexpr size_t capacity()
+        {
+            return Size;
+        }
+
+        /// \brief Количество занятых байт, включая выравнивание
+        size_t in_use() const
+        {
+            return used.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Наибольшее количество занятых байт
+        size_t high_water() const
+        {
+            return usage.high_water.load(std::memory_order_relaxed);
+        }
+
+        size_t failures() const
+        {
+            return usage.failures.load(std::memory_order_relaxed);
+        }
+
+    private:
+        alignas(std::max_align_t) std::array<std::byte, Size> storage;
+        std::atomic<size_t> used = 0;
+        Usage usage;
+    };
+
+    /*!
+     * \brief Статический интерфейс к пулу-объекту для сопрограмм (async::Task)
+     * \code
+     * memory::Block_pool<256, 8> frames;
+     * async::Task<memory::Pool_ref<frames>> worker();
+     * \endcode
+     */
+    template<auto& pool>
+    struct Pool_ref
+    {
+        static void* allocate(size_t size) noexcept
+        {
+            return pool.allocate(size);
+        }
+
+        static void deallocate(void* pointer) noexcept
+        {
+            pool.deallocate(pointer);
+        }
+    };
+}
+
+#endif // ALLOCATOR_HPP
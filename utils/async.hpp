@@ -0,0 +1,380 @@
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+/*!
+ * \file
+ * \brief Файл с сопрограммами для ожидания событий периферии без активного ожидания
+ *
+ * Сопрограмма (Task) ожидает через co_await:
+ * - until<V>() - установки значения поля V (проверяется исполнителем в каждом цикле);
+ * - Event - сигнала из прерывания, например окончания передачи DMA;
+ * - sleep_for(ticks) - заданного количества тиков Executor::tick.
+ *
+ * Кадры сопрограмм размещаются в статическом пуле Frame_pool, куча не используется.
+ * Списки ожидания хранятся в самих кадрах, поэтому исполнитель не ограничивает
+ * количество ожидающих сопрограмм.
+ */
+
+namespace metaMCU::async {
+
+    /// \brief Элемент списков исполнителя, хранится в кадре сопрограммы
+    struct Node
+    {
+        Node* next = nullptr;
+        std::coroutine_handle<> handle;
+    };
+
+    /*!
+     * \brief Статический пул кадров сопрограмм
+     *
+     * Выделение и освобождение выполняются только в контексте исполнителя
+     * (создание и завершение сопрограмм), не из прерываний.
+     * \tparam Block_size Максимальный размер кадра в байтах
+     * \tparam Blocks Количество кадров, не более 32
+     */
+    template<size_t Block_size = 256, size_t Blocks = 8>
+        requires (Blocks > 0) && (Blocks <= 32)
+    class Frame_pool
+    {
+    public:
+        /// \brief Выделяет кадр, nullptr, если кадр слишком велик или пул исчерпан
+        static void* allocate(size_t size) noexcept
+        {
+            const auto index = static_cast<size_t>(std::countr_one(used));
+            if (size > Block_size || index >= Blocks)
+                return nullptr;
+            used |= 1U << index;
+            return storage[index].data();
+        }
+
+        static void deallocate(void* pointer) noexcept
+        {
+            const auto index = static_cast<size_t>(static_cast<std::byte*>(pointer) - storage[0].data()) / Block_size;
+            used &= ~(1U << index);
+        }
+
+        /// \brief Количество занятых кадров
+        static size_t in_use()
+        {
+            return static_cast<size_t>(std::popcount(used));
+        }
+
+    private:
+        alignas(std::max_align_t) static inline std::array<std::array<std::byte, Block_size>, Blocks> storage{};
+        static inline std::uint32_t used = 0;
+    };
+
+    template<typename Pool>
+    class Task;
+
+    /*!
+     * \brief Исполнитель сопрограмм
+     *
+     * run_once вызывается в основном цикле. Прерывания возобновляют сопрограммы
+     * через Event::signal и продвигают время через tick, сами сопрограммы
+     * выполняются только в run_once.
+     */
+    class Executor
+    {
+    public:
+        /// \brief Ставит созданную сопрограмму в очередь выполнения, ложь - кадр не был выделен
+        template<typename Pool>
+        static bool spawn(Task<Pool>&& task)
+        {
+            if (!task.handle)
+                return false;
+            auto& promise = task.handle.promise();
+            promise.handle = std::exchange(task.handle, nullptr);
+            schedule(&promise);
+            return true;
+        }
+
+        /*!
+         * \brief Возобновляет готовые сопрограммы
+         *
+         * Выполняет сопрограммы, получившие сигнал, затем проверяет условия
+         * until и сроки sleep_for.
+         * \return Истина, если была возобновлена хотя бы одна сопрограмма
+         */
+        static bool run_once()
+        {
+            bool resumed = false;
+
+            Node* reversed = ready.exchange(nullptr, std::memory_order_acquire);
+            Node* node = nullptr;
+            while (reversed != nullptr)
+                node = std::exchange(reversed, std::exchange(reversed->next, node));
+            for (; node != nullptr; resumed = true)
+                std::exchange(node, node->next)->handle.resume();
+
+            resumed |= resume_if(polled, [](Node* n) { return static_cast<Poll_node*>(n)->condition(); });
+            const auto time = now.load(std::memory_order_relaxed);
+            resumed |= resume_if(timers, [time](Node* n) { return static_cast<std::int32_t>(time - static_cast<Timer_node*>(n)->deadline) >= 0; });
+            return resumed;
+        }
+
+        /// \brief Истина, если нет сопрограмм, ожидающих условий или сроков
+        static bool idle()
+        {
+            return polled == nullptr && timers == nullptr && ready.load(std::memory_order_relaxed) == nullptr;
+        }
+
+        /// \brief Продвигает время на один тик, вызывается из прерывания таймера
+        static void tick()
+        {
+            now.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static std::uint32_t time()
+        {
+            return now.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Ставит сопрограмму в очередь выполнения, допускается вызов из прерываний
+        static void schedule(Node* node)
+        {
+            node->next = ready.load(std::memory_order_relaxed);
+            while (!ready.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+        }
+
+        struct Poll_node : Node
+        {
+            bool (*condition)();
+        };
+
+        struct Timer_node : Node
+        {
+            std::uint32_t deadline;
+        };
+
+        static void wait(Poll_node* node)
+        {
+            node->next = std::exchange(polled, node);
+        }
+
+        static void wait(Timer_node* node)
+        {
+            node->next = std::exchange(timers, node);
+        }
+
+    private:
+        /// Удаляет из списка и возобновляет сопрограммы, для которых выполнено условие
+        template<typename F>
+        static bool resume_if(Node*& list, F condition)
+        {
+            bool resumed = false;
+            Node* ready_list = nullptr;
+            for (Node** link = &list; *link != nullptr;)
+            {
+                if (condition(*link))
+                {
+                    auto node = std::exchange(*link, (*link)->next);
+                    node->next = std::exchange(ready_list, node);
+                }
+                else
+                    link = &(*link)->next;
+            }
+            while (ready_list != nullptr)
+            {
+                std::exchange(ready_list, ready_list->next)->handle.resume();
+                resumed = true;
+            }
+            return resumed;
+        }
+
+        static inline std::atomic<Node*> ready = nullptr;
+        static inline Node* polled = nullptr;
+        static inline Node* timers = nullptr;
+        static inline std::atomic<std::uint32_t> now = 0;
+    };
+
+    /*!
+     * \brief Сопрограмма, выполняемая исполнителем
+     *
+     * Создается приостановленной и запускается Executor::spawn. Кадр
+     * освобождается по завершении. Если пул исчерпан, объект пуст и
+     * spawn возвращает ложь.
+     * \tparam Pool Пул кадров
+     */
+    template<typename Pool = Frame_pool<>>
+    class Task
+    {
+    public:
+        struct promise_type : Node
+        {
+            static void* operator new(size_t size) noexcept
+            {
+                return Pool::allocate(size);
+            }
+
+            static void operator delete(void* pointer, size_t) noexcept
+            {
+                Pool::deallocate(pointer);
+            }
+
+            static Task get_return_object_on_allocation_failure()
+            {
+                return Task(nullptr);
+            }
+
+            Task get_return_object()
+            {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+        Task& operator=(Task&&) = delete;
+
+        ~Task()
+        {
+            if (handle)
+                handle.destroy();
+        }
+
+        explicit operator bool() const
+        {
+            return static_cast<bool>(handle);
+        }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        std::coroutine_handle<promise_type> handle;
+
+        friend class Executor;
+    };
+
+    /*!
+     * \brief Событие с одним ожидающим, устанавливаемое из прерывания
+     *
+     * Сигнал, поданный до co_await, не теряется: следующий co_await
+     * завершается сразу. Несколько сигналов до co_await объединяются в один.
+     * \code
+     * async::Event tx_done;
+     * // в прерывании DMA:
+     * Tx_stream::handle_interrupt([]{}, []{ tx_done.signal(); });
+     * // в сопрограмме:
+     * co_await tx_done;
+     * \endcode
+     */
+    class Event
+    {
+    public:
+        void signal()
+        {
+            if (auto node = waiter.exchange(nullptr, std::memory_order_acq_rel))
+                Executor::schedule(node);
+            else
+                signaled.store(true, std::memory_order_release);
+        }
+
+        auto operator co_await()
+        {
+            struct Awaiter : Node
+            {
+                Event& event;
+
+                bool await_ready()
+                {
+                    return event.signaled.exchange(false, std::memory_order_acquire);
+                }
+
+                bool await_suspend(std::coroutine_handle<> coroutine)
+                {
+                    handle = coroutine;
+                    event.waiter.store(this, std::memory_order_release);
+                    if (event.signaled.exchange(false, std::memory_order_acquire))
+                        return event.waiter.exchange(nullptr, std::memory_order_acq_rel) == nullptr;
+                    return true;
+                }
+
+                void await_resume() {}
+            };
+            return Awaiter{{}, *this};
+        }
+
+    private:
+        std::atomic<Node*> waiter = nullptr;
+        std::atomic<bool> signaled = false;
+    };
+
+    /// \brief Ожидание выполнения условия, проверяемого исполнителем
+    struct Condition_awaiter : Executor::Poll_node
+    {
+        bool await_ready()
+        {
+            return condition();
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine)
+        {
+            handle = coroutine;
+            Executor::wait(this);
+        }
+
+        void await_resume() {}
+    };
+
+    /// \brief Ожидание условия bool()
+    inline Condition_awaiter until(bool (*condition)())
+    {
+        return {{{}, condition}};
+    }
+
+    /*!
+     * \brief Ожидание установки значения битового поля
+     *
+     * Без прерываний: значение проверяется исполнителем в каждом run_once.
+     * \tparam V Значение поля (Field_value)
+     */
+    template<typename V>
+    Condition_awaiter until()
+    {
+        return until(+[] { return V::is_set(); });
+    }
+
+    /// \brief Ожидание окончания передачи потока DMA
+    template<typename Stream>
+    Condition_awaiter completion()
+    {
+        return until(+[] { return !Stream::busy(); });
+    }
+
+    /// \brief Ожидание заданного количества тиков Executor::tick
+    inline auto sleep_for(std::uint32_t ticks)
+    {
+        struct Awaiter : Executor::Timer_node
+        {
+            bool await_ready()
+            {
+                return static_cast<std::int32_t>(Executor::time() - deadline) >= 0;
+            }
+
+            void await_suspend(std::coroutine_handle<> coroutine)
+            {
+                handle = coroutine;
+                Executor::wait(this);
+            }
+
+            void await_resume() {}
+        };
+        return Awaiter{{{}, Executor::time() + ticks}};
+    }
+}
+
+#endif // ASYNC_HPP
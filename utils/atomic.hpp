@@ -3,8 +3,89 @@
 
 #include "register.hpp"
 #include <cstddef>
+#include <type_traits>
+
+/*!
+ * \file
+ * \brief Файл с атомарными операциями над битовыми полями
+ *
+ * Операции выполняются без запрета прерываний: на ARMv7-M через цикл
+ * LDREX/STREX, на хосте через std::atomic_ref над ячейкой Simulated_bus.
+ * При изменении регистра между чтением и записью операция повторяется,
+ * количество повторов доступно через retries().
+ */
 
 namespace metaMCU {
+
+    /// \brief Проверка принадлежности всех полей (или значений полей) одному регистру
+    template<typename X, typename... Xs>
+    concept Same_register = (std::is_same_v<typename X::Register_t, typename Xs::Register_t> && ...);
+
+    namespace atomic {
+
+        /*!
+         * \brief Атомарно записывает значения полей одного регистра, сохраняя значения других полей
+         * \tparam Values Значения полей для записи
+         */
+        template<typename Value, typename... Values>
+            requires Same_register<Value, Values...>
+        [[gnu::always_inline]] inline void set()
+        {
+            Value::Register_t::template values_set_atomic<Value, Values...>();
+        }
+
+        /*!
+         * \brief Атомарно сбрасывает в 0 поля одного регистра
+         * \tparam Fields Битовые поля
+         */
+        template<typename Field, typename... Fields>
+            requires Same_register<Field, Fields...>
+        [[gnu::always_inline]] inline void clear()
+        {
+            Field::Register_t::bits_set_clear_atomic((Field::mask() | ... | Fields::mask()), 0);
+        }
+
+        /*!
+         * \brief Атомарно инвертирует все биты полей одного регистра
+         * \tparam Fields Битовые поля
+         */
+        template<typename Field, typename... Fields>
+            requires Same_register<Field, Fields...>
+        [[gnu::always_inline]] inline void toggle()
+        {
+            Field::Register_t::bits_toggle_atomic((Field::mask() | ... | Fields::mask()));
+        }
+
+        /*!
+         * \brief Атомарно заменяет значение поля на modify(значение поля)
+         *
+         * Значение передается в modify и возвращается без смещения, результат
+         * modify обрезается по размеру поля.
+         * \tparam Field Битовое поле
+         * \return Значение поля до изменения
+         */
+        template<typename Field, typename F>
+        [[gnu::always_inline]] inline auto fetch_modify(F modify)
+        {
+            using Value_t = typename Field::Value_t;
+            constexpr Value_t mask = Field::mask();
+            constexpr auto offset = Field::bit_offset();
+
+            const Value_t old_value = Field::Register_t::modify_atomic([modify](Value_t value)
+            {
+                const Value_t field = static_cast<Value_t>(modify(static_cast<Value_t>((value & mask) >> offset)));
+                return static_cast<Value_t>((value & ~mask) | ((field << offset) & mask));
+            });
+            return static_cast<Value_t>((old_value & mask) >> offset);
+        }
+
+        /// \brief Количество повторов атомарных операций над регистром
+        template<typename Register>
+        [[gnu::always_inline]] inline size_t retries()
+        {
+            return Register::atomic_retries();
+        }
+    }
 }
 
 #endif // ATOMIC_HPP
@@ -2,6 +2,7 @@
 #define CONFIGUTILS_HPP
 
 #include <concepts>
+#include <cstdint>
 
 template <typename Pin, typename SpecializationKey = Pin::SpecializationKey>
 struct PinsConfiguration {};
@@ -65,12 +66,21 @@ concept CanAnalog = CanConfigure<Pin> || PinConfiguredAsAnalog<PinsConfiguration
 template<typename Pin>
 concept CanOutput = CanConfigure<Pin> || PinConfiguredAsOutput<PinsConfiguration<Pin>>;
 
-template<PinMode mode, PinStrenght strenght = NORMAL_STR, PinPolicy policy = PIN_NON_CONFIGURABLE>
+/*!
+ * \brief Начальная конфигурация вывода
+ * \tparam mode Режим вывода
+ * \tparam strenght Нагрузочная способность (скорость) выхода
+ * \tparam policy Разрешено ли изменять режим после запуска
+ * \tparam alternate Номер альтернативной функции для режимов AUX_*
+ */
+template<PinMode mode, PinStrenght strenght = NORMAL_STR, PinPolicy policy = PIN_NON_CONFIGURABLE, std::uint8_t alternate = 0>
+    requires (alternate < 16)
 struct StartupConfiguration
 {
     constexpr static PinMode Mode = mode;
     constexpr static PinStrenght Strenght = strenght;
     constexpr static PinPolicy Policy = policy;
+    constexpr static std::uint8_t Alternate = alternate;
 };
 
 #endif // CONFIGUTILS_HPP
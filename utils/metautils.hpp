@@ -1,8 +1,12 @@
 #ifndef METAUTILS_HPP
 #define METAUTILS_HPP
 
+#include <algorithm>
+#include <array>
 #include <concepts>
+#include <cstddef>
 #include <type_traits>
+#include <utility>
 
 #include "field.hpp"
 
@@ -10,9 +14,9 @@ namespace meta_utils {
     template<typename... Xs> struct TypeContainer {};
 
     template<typename... Xs, typename V>
-    consteval int countSameType(TypeContainer<Xs...> lhs, TypeContainer<V> rhs)
+    consteval int countSameType(TypeContainer<Xs...>, TypeContainer<V>)
     {
-        return (... + (std::is_same_v<Xs, V> ? 1 : 0));
+        return (0 + ... + (std::is_same_v<Xs, V> ? 1 : 0));
     }
 
     template<typename... Xs, typename V>
@@ -24,26 +28,137 @@ namespace meta_utils {
             return TypeContainer<Xs..., V>();
     }
 
-    template<typename R, typename... Xs, typename V>
-    consteval auto operator&(TypeContainer<R, Xs...> lhs, TypeContainer<V> rhs)
+    /// Объединение списков типов
+    template<typename... Xs, typename... Ys>
+    consteval auto operator&(TypeContainer<Xs...>, TypeContainer<Ys...>)
     {
-        if constexpr (std::is_same_v<R, typename V::Register>)
-            return TypeContainer<R, Xs..., V>();
-        else
-            return lhs;
+        return TypeContainer<Xs..., Ys...>();
+    }
+
+    template<typename T> struct TypeTag {};
+
+    template<size_t I, typename T>
+    struct Indexed : TypeTag<T>
+    {
+        using type = T;
+    };
+
+    template<typename Is, typename... Ts> struct Indexer;
+
+    /// Наследует Indexed<I, T> для каждого типа пакета: выбор по индексу и проверка уникальности без рекурсии
+    template<size_t... Is, typename... Ts>
+    struct Indexer<std::index_sequence<Is...>, Ts...> : Indexed<Is, Ts>... {};
+
+    template<size_t I, typename T>
+    Indexed<I, T> select(const Indexed<I, T>&);
+
+    /// Тип пакета по индексу
+#if __has_builtin(__type_pack_element)
+    template<size_t I, typename... Ts>
+    using Nth = __type_pack_element<I, Ts...>;
+#else
+    template<size_t I, typename... Ts>
+    using Nth = typename decltype(select<I>(std::declval<Indexer<std::index_sequence_for<Ts...>, Ts...>>()))::type;
+#endif
+
+    /// Истина, если каждый тип встречается в пакете один раз (иначе приведение к TypeTag неоднозначно)
+    template<typename... Ts>
+    inline constexpr bool allUnique = (std::is_convertible_v<Indexer<std::index_sequence_for<Ts...>, Ts...>*, TypeTag<Ts>*> && ...);
+
+    /// Адрес переменной служит идентификатором типа в constexpr вычислениях
+    template<typename T>
+    inline constexpr char typeTag = 0;
+
+    template<typename T>
+    consteval const void* typeId()
+    {
+        return &typeTag<T>;
     }
 
-    template<typename F, typename F::Register::Type value>
-    consteval void isFieldValue(FieldValue<F, value>) {}
+    /*!
+     * \brief Разбиение элементов на группы с одинаковым ключом
+     *
+     * Группы нумеруются в порядке первого появления ключа, of[i] - группа элемента i,
+     * элементы группы G перечислены в members[begin[G]] ... members[begin[G + 1] - 1] в исходном порядке.
+     */
+    template<size_t N>
+    struct Groups
+    {
+        size_t count = 0;
+        std::array<size_t, N> first{};
+        std::array<size_t, N> of{};
+        std::array<size_t, N + 1> begin{};
+        std::array<size_t, N> members{};
+    };
+
+    /*!
+     * \brief Группирует элементы по ключам
+     *
+     * Идентификаторы типов можно только сравнивать на равенство, поэтому элементы
+     * сначала сортируются по подсказке (например, адресу регистра), равной для
+     * равных ключей, и ключи сравниваются только внутри серий с одинаковой подсказкой.
+     * Время растет как N log N, а не как произведение числа элементов на число групп.
+     */
+    template<size_t N>
+    consteval Groups<N> group(const std::array<const void*, N>& keys, const std::array<size_t, N>& hints)
+    {
+        Groups<N> result;
+        std::array<size_t, N> sorted{};
+        for (size_t i = 0; i < N; ++i)
+            sorted[i] = i;
+        std::sort(sorted.begin(), sorted.end(), [&hints](size_t a, size_t b)
+        {
+            return hints[a] != hints[b] ? hints[a] < hints[b] : a < b;
+        });
+
+        // Первый элемент с тем же ключом: внутри серии индексы возрастают, поэтому leader[i] <= i
+        std::array<size_t, N> leader{};
+        std::array<size_t, N> heads{};
+        for (size_t begin = 0, end = 0; begin < N; begin = end)
+        {
+            size_t distinct = 0;
+            for (end = begin; end < N && hints[sorted[end]] == hints[sorted[begin]]; ++end)
+            {
+                const auto i = sorted[end];
+                size_t h = 0;
+                while (h < distinct && keys[heads[h]] != keys[i])
+                    ++h;
+                if (h == distinct)
+                    heads[distinct++] = i;
+                leader[i] = heads[h];
+            }
+        }
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (leader[i] == i)
+            {
+                result.of[i] = result.count;
+                result.first[result.count++] = i;
+            }
+            else
+                result.of[i] = result.of[leader[i]];
+            ++result.begin[result.of[i] + 1];
+        }
+        for (size_t g = 0; g < result.count; ++g)
+            result.begin[g + 1] += result.begin[g];
+        auto fill = result.begin;
+        for (size_t i = 0; i < N; ++i)
+            result.members[fill[result.of[i]]++] = i;
+        return result;
+    }
 }
 
 template<typename Value>
-concept IsFieldValue = requires (Value v)
+concept IsFieldValue = requires
 {
-    meta_utils::isFieldValue(v);
+    typename Value::Register_t;
+    Value::mask();
+    Value::bit_offset();
+    Value::value();
 };
 
 template<typename... Xs>
-concept NoDuplicates = (... && (meta_utils::countSameType(meta_utils::TypeContainer<Xs...>(), meta_utils::TypeContainer<Xs>()) == 1));
+concept NoDuplicates = meta_utils::allUnique<Xs...>;
 
 #endif // METAUTILS_HPP
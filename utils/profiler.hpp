@@ -0,0 +1,226 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#if defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+#include "dwt.hpp"
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+/*!
+ * \file
+ * \brief Файл с измерением длительности участков кода в тактах
+ *
+ * Участок кода отмечается объектом Scoped_timer с именем места измерения.
+ * Для каждого места накапливаются количество, минимум, максимум, сумма
+ * и гистограмма длительностей по степеням двойки. Накопленные данные
+ * выводятся компактным двоичным потоком, который разбирает
+ * tools/profiledecoder.py.
+ *
+ * Измерения включаются макросом METAMCU_PROFILING (опция CMake
+ * METAMCU_PROFILING). Без него Scoped_timer - пустой объект,
+ * а статистика мест измерения не создается.
+ *
+ * Источник тактов: DWT_CYCCNT на Cortex-M (см. Cycle_counter::enable),
+ * rdtsc на x86 и std::chrono::steady_clock (наносекунды) на других хостах,
+ * в том числе на ARM профилей A и R, где нет DWT.
+ */
+
+#ifndef METAMCU_PROFILING
+#define METAMCU_PROFILING 0
+#endif
+
+namespace metaMCU::profiling {
+
+    inline constexpr bool enabled = METAMCU_PROFILING;
+
+    /// \brief Источник отсчетов времени
+    struct Cycle_counter
+    {
+        /// \brief Запускает счетчик тактов, если он требует включения
+        static void enable()
+        {
+#if defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+            CortexM3::Dwt<>::enable();
+#endif
+        }
+
+        [[gnu::always_inline]] inline static std::uint32_t now()
+        {
+#if defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'M'
+            return CortexM3::Dwt<>::cycles();
+#elif defined(__x86_64__) || defined(__i386__)
+            return static_cast<std::uint32_t>(__rdtsc());
+#else
+            return static_cast<std::uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+        }
+    };
+
+    /// \brief Имя места измерения, передаваемое строковым литералом в параметр шаблона
+    template<size_t N>
+    struct Site_name
+    {
+        consteval Site_name(const char (&text)[N])
+        {
+            std::copy_n(text, N, value);
+        }
+
+        char value[N];
+    };
+
+    /*!
+     * \brief Статистика места измерения
+     *
+     * Все места связаны в список, который обходит dump.
+     * \warning Обновление статистики не атомарно: одно место не должно
+     * измеряться одновременно в прерывании и в основном цикле.
+     */
+    class Site
+    {
+    public:
+        /// Гистограмма: корзина I содержит длительности в [2^(I-1), 2^I)
+        static constexpr size_t buckets = 33;
+
+        explicit Site(const char* name) : name(name), next(head)
+        {
+            head = this;
+        }
+
+        Site(const Site&) = delete;
+        Site& operator=(const Site&) = delete;
+
+        [[gnu::always_inline]] inline void record(std::uint32_t duration)
+        {
+            ++count;
+            sum += duration;
+            minimum = std::min(minimum, duration);
+            maximum = std::max(maximum, duration);
+            ++histogram[std::bit_width(duration)];
+        }
+
+        void reset()
+        {
+            count = 0;
+            sum = 0;
+            minimum = std::numeric_limits<std::uint32_t>::max();
+            maximum = 0;
+            histogram = {};
+        }
+
+        const char* name;
+        std::uint32_t count = 0;
+        std::uint64_t sum = 0;
+        std::uint32_t minimum = std::numeric_limits<std::uint32_t>::max();
+        std::uint32_t maximum = 0;
+        std::array<std::uint32_t, buckets> histogram{};
+
+        static inline Site* head = nullptr;
+        Site* next;
+    };
+
+    /// \brief Статистика места измерения с именем name, создается при первом упоминании
+    template<Site_name name>
+    inline Site site{name.value};
+
+    /*!
+     * \brief Измеряет время жизни объекта и добавляет его в статистику места name
+     * \code
+     * {
+     *     profiling::Scoped_timer<"values_set"> timer;
+     *     Values<...>::Set();
+     * }
+     * \endcode
+     */
+    template<Site_name name>
+    class Scoped_timer
+    {
+    public:
+        [[gnu::always_inline]] inline Scoped_timer()
+        {
+            if constexpr (enabled)
+                start = Cycle_counter::now();
+        }
+
+        [[gnu::always_inline]] inline ~Scoped_timer()
+        {
+            if constexpr (enabled)
+                site<name>.record(Cycle_counter::now() - start);
+        }
+
+        Scoped_timer(const Scoped_timer&) = delete;
+        Scoped_timer& operator=(const Scoped_timer&) = delete;
+
+    private:
+        struct Empty {};
+        [[no_unique_address]] std::conditional_t<enabled, std::uint32_t, Empty> start;
+    };
+
+    /// \brief Сигнатура и версия двоичного потока dump
+    inline constexpr std::array<std::uint8_t, 4> dump_magic = {'M', 'P', 'R', '1'};
+
+    /*!
+     * \brief Выводит статистику всех мест измерения двоичным потоком
+     *
+     * Формат (числа little-endian): dump_magic, количество мест (u16), затем для
+     * каждого места: длина имени (u8), имя, count (u32), sum (u64), minimum (u32),
+     * maximum (u32), количество непустых корзин (u8) и пары номер корзины (u8) -
+     * количество (u32).
+     * \param write Функция void(const std::uint8_t* data, size_t size), например запись в UART
+     */
+    template<typename Write>
+    void dump(Write write)
+    {
+        auto put = [&write](std::uint64_t value, size_t size)
+        {
+            std::array<std::uint8_t, 8> bytes{};
+            for (size_t i = 0; i < size; ++i)
+                bytes[i] = static_cast<std::uint8_t>(value >> (8 * i));
+            write(bytes.data(), size);
+        };
+
+        std::uint16_t sites = 0;
+        for (auto s = Site::head; s != nullptr; s = s->next)
+            ++sites;
+
+        write(dump_magic.data(), dump_magic.size());
+        put(sites, 2);
+        for (auto s = Site::head; s != nullptr; s = s->next)
+        {
+            const auto length = std::min<size_t>(std::char_traits<char>::length(s->name), 255);
+            put(length, 1);
+            write(reinterpret_cast<const std::uint8_t*>(s->name), length);
+            put(s->count, 4);
+            put(s->sum, 8);
+            put(s->minimum, 4);
+            put(s->maximum, 4);
+            put(std::count_if(s->histogram.begin(), s->histogram.end(), [](auto n) { return n != 0; }), 1);
+            for (size_t i = 0; i < Site::buckets; ++i)
+                if (s->histogram[i] != 0)
+                {
+                    put(i, 1);
+                    put(s->histogram[i], 4);
+                }
+        }
+    }
+
+    /// \brief Сбрасывает статистику всех мест измерения
+    inline void reset()
+    {
+        for (auto s = Site::head; s != nullptr; s = s->next)
+            s->reset();
+    }
+}
+
+#endif // PROFILER_HPP
@@ -0,0 +1,316 @@
+#ifndef QUEUE_HPP
+#define QUEUE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+/*!
+ * \file
+ * \brief Файл с очередями фиксированного размера для передачи данных из прерываний
+ *
+ * Очереди не используют запрет прерываний и блокировки. Индексы хранятся
+ * в std::atomic: на ARMv7-M операции сравнения с обменом выполняются через
+ * LDREX/STREX, на хосте - атомарными инструкциями процессора, что позволяет
+ * проверять очереди под ThreadSanitizer.
+ */
+
+namespace metaMCU {
+
+    /// \brief Проверка возможности использования емкости очереди: степень двойки
+    template<size_t Capacity>
+    concept Queue_capacity = Capacity > 1 && (Capacity & (Capacity - 1)) == 0;
+
+    /// \brief Выравнивание индексов очереди, разделяющее их по строкам кэша на хосте
+#if defined(__ARM_ARCH)
+    inline constexpr size_t queue_index_alignment = alignof(std::atomic<size_t>);
+#else
+    inline constexpr size_t queue_index_alignment = 64;
+#endif
+
+    /*!
+     * \brief Очередь с одним производителем и одним потребителем
+     *
+     * Все операции выполняются без ожидания (wait-free). Производитель может
+     * получить непрерывный участок буфера для записи без копирования
+     * (write_reserve/write_commit), потребитель - для чтения (read_reserve/read_commit).
+     * \tparam T Тип элемента
+     * \tparam Capacity Емкость, степень двойки
+     */
+    template<typename T, size_t Capacity>
+        requires Queue_capacity<Capacity> && std::is_trivially_copyable_v<T>
+    class Spsc_queue
+    {
+    public:
+        static consteval size_t capacity()
+        {
+            return Capacity;
+        }
+
+        /// \brief Добавляет элемент, возвращает ложь, если очередь заполнена
+        bool push(const T& value)
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            if (head - tail_.load(std::memory_order_acquire) == Capacity)
+                return false;
+            buffer[head & mask] = value;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// \brief Извлекает элемент, возвращает ложь, если очередь пуста
+        bool pop(T& value)
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            if (head_.load(std::memory_order_acquire) == tail)
+                return false;
+            value = buffer[tail & mask];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// \brief Добавляет элементы, сколько помещается, возвращает их количество
+        size_t push(std::span<const T> values)
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            const auto count = std::min(values.size(), Capacity - (head - tail_.load(std::memory_order_acquire)));
+            for (size_t i = 0; i < count; ++i)
+                buffer[(head + i) & mask] = values[i];
+            head_.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        /// \brief Извлекает элементы, сколько есть, возвращает их количество
+        size_t pop(std::span<T> values)
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            const auto count = std::min(values.size(), head_.load(std::memory_order_acquire) - tail);
+            for (size_t i = 0; i < count; ++i)
+                values[i] = buffer[(tail + i) & mask];
+            tail_.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        /*!
+         * \brief Непрерывный свободный участок буфера длиной не более count
+         *
+         * Участок может оказаться короче свободного места, если достигнут конец буфера.
+         * Записанные элементы становятся доступны потребителю после write_commit.
+         */
+        std::span<T> write_reserve(size_t count = Capacity)
+        {
+            const auto head = head_.load(std::memory_order_relaxed);
+            const auto free = Capacity - (head - tail_.load(std::memory_order_acquire));
+            const auto start = head & mask;
+            return {buffer.data() + start, std::min({count, free, Capacity - start})};
+        }
+
+        /// \brief Публикует count элементов, записанных в участок write_reserve
+        void write_commit(size_t count)
+        {
+            head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        /// \brief Непрерывный участок доступных для чтения элементов длиной не более count
+        std::span<const T> read_reserve(size_t count = Capacity) const
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            const auto used = head_.load(std::memory_order_acquire) - tail;
+            const auto start = tail & mask;
+            return {buffer.data() + start, std::min({count, used, Capacity - start})};
+        }
+
+        /// \brief Освобождает count элементов, прочитанных из участка read_reserve
+        void read_commit(size_t count)
+        {
+            tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        size_t size() const
+        {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+    private:
+        static constexpr size_t mask = Capacity - 1;
+
+        alignas(queue_index_alignment) std::atomic<size_t> head_ = 0;
+        alignas(queue_index_alignment) std::atomic<size_t> tail_ = 0;
+        alignas(queue_index_alignment) std::array<T, Capacity> buffer{};
+    };
+
+    /*!
+     * \brief Очередь с несколькими производителями и одним потребителем
+     *
+     * Производители захватывают участки буфера сравнением с обменом индекса записи
+     * и публикуют каждый элемент отдельно, поэтому медленный производитель
+     * задерживает потребителя только на своих элементах. Добавление выполняется
+     * без блокировок (lock-free), извлечение - без ожидания.
+     * \tparam T Тип элемента
+     * \tparam Capacity Емкость, степень двойки
+     */
+    template<typename T, size_t Capacity>
+        requires Queue_capacity<Capacity> && std::is_trivially_copyable_v<T>
+    class Mpsc_queue
+    {
+    public:
+        /// \brief Участок буфера, захваченный производителем
+        struct Reservation
+        {
+            std::span<T> span;
+            size_t position;
+        };
+
+        static consteval size_t capacity()
+        {
+            return Capacity;
+        }
+
+        /// \brief Добавляет элемент, возвращает ложь, если очередь заполнена
+        bool push(const T& value)
+        {
+            auto reservation = write_reserve(1);
+            if (reservation.span.empty())
+                return false;
+            reservation.span[0] = value;
+            write_commit(reservation);
+            return true;
+        }
+
+        /// \brief Добавляет элементы, сколько помещается, возвращает их количество
+        size_t push(std::span<const T> values)
+        {
+            const auto claim = claim_slots(values.size());
+            for (size_t i = 0; i < claim.count; ++i)
+            {
+                buffer[(claim.position + i) & mask] = values[i];
+                publish(claim.position + i);
+            }
+            return claim.count;
+        }
+
+        /*!
+         * \brief Захватывает непрерывный участок буфера длиной не более count
+         *
+         * Участок может оказаться короче свободного места, если достигнут конец буфера.
+         * Каждый захваченный участок должен быть передан в write_commit.
+         */
+        Reservation write_reserve(size_t count = Capacity)
+        {
+            const auto claim = claim_slots(count, true);
+            return {{buffer.data() + (claim.position & mask), claim.count}, claim.position};
+        }
+
+        /// \brief Публикует элементы участка write_reserve
+        void write_commit(const Reservation& reservation)
+        {
+            for (size_t i = 0; i < reservation.span.size(); ++i)
+                publish(reservation.position + i);
+        }
+
+        /// \brief Извлекает элемент, возвращает ложь, если очередь пуста
+        bool pop(T& value)
+        {
+            const auto span = read_reserve(1);
+            if (span.empty())
+                return false;
+            value = span[0];
+            read_commit(1);
+            return true;
+        }
+
+        /// \brief Извлекает опубликованные элементы, сколько есть, возвращает их количество
+        size_t pop(std::span<T> values)
+        {
+            size_t count = 0;
+            while (count < values.size())
+            {
+                const auto span = read_reserve(values.size() - count);
+                if (span.empty())
+                    break;
+                for (const auto& value : span)
+                    values[count++] = value;
+                read_commit(span.size());
+            }
+            return count;
+        }
+
+        /// \brief Непрерывный участок опубликованных элементов длиной не более count
+        std::span<const T> read_reserve(size_t count = Capacity) const
+        {
+            const auto tail = tail_.load(std::memory_order_relaxed);
+            const auto start = tail & mask;
+            const auto limit = std::min(count, Capacity - start);
+            size_t ready = 0;
+            while (ready < limit && sequence[start + ready].load(std::memory_order_acquire) == tail + ready + 1)
+                ++ready;
+            return {buffer.data() + start, ready};
+        }
+
+        /// \brief Освобождает count элементов, прочитанных из участка read_reserve
+        void read_commit(size_t count)
+        {
+            tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+        /// \brief Количество захваченных производителями и не извлеченных элементов
+        size_t size() const
+        {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+    private:
+        struct Claim
+        {
+            size_t position;
+            size_t count;
+        };
+
+        /// Захватывает до count свободных ячеек, при contiguous - не переходя через конец буфера
+        Claim claim_slots(size_t count, bool contiguous = false)
+        {
+            auto head = head_.load(std::memory_order_relaxed);
+            size_t claimed = 0;
+            do
+            {
+                const auto free = Capacity - (head - tail_.load(std::memory_order_acquire));
+                claimed = std::min(count, free);
+                if (contiguous)
+                    claimed = std::min(claimed, Capacity - (head & mask));
+                if (claimed == 0)
+                    break;
+            }
+            while (!head_.compare_exchange_weak(head, head + claimed, std::memory_order_relaxed));
+            return {head, claimed};
+        }
+
+        /// Отмечает ячейку позиции position заполненной для потребителя
+        void publish(size_t position)
+        {
+            sequence[position & mask].store(position + 1, std::memory_order_release);
+        }
+
+        static constexpr size_t mask = Capacity - 1;
+
+        alignas(queue_index_alignment) std::atomic<size_t> head_ = 0;
+        alignas(queue_index_alignment) std::atomic<size_t> tail_ = 0;
+        /// Позиция, увеличенная на 1, последнего опубликованного в ячейку элемента
+        std::array<std::atomic<size_t>, Capacity> sequence{};
+        std::array<T, Capacity> buffer{};
+    };
+}
+
+#endif // QUEUE_HPP
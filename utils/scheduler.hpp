@@ -0,0 +1,254 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "metautils.hpp"
+
+/*!
+ * \file
+ * \brief Файл с кооперативным планировщиком задач со списком задач на этапе компиляции
+ *
+ * Задачи - функции, выполняемые до завершения на общем стеке. Готовые задачи
+ * отмечаются в битовой карте, старший бит соответствует задаче с наивысшим
+ * приоритетом, поэтому выбор задачи выполняется одной инструкцией CLZ.
+ * Планировщик не использует кучу и отдельные стеки задач.
+ */
+
+namespace metaMCU {
+
+    /*!
+     * \brief Описание задачи
+     * \tparam Function Функция задачи void()
+     * \tparam priority Приоритет, меньшее значение - более высокий приоритет (как в NVIC)
+     * \tparam period Период запуска в тиках, 0 - задача запускается только через post
+     */
+    template<auto Function, std::uint8_t priority, std::uint32_t period = 0>
+        requires std::is_invocable_r_v<void, decltype(Function)>
+    struct Task
+    {
+        static constexpr auto function = Function;
+        static constexpr std::uint8_t Priority = priority;
+        static constexpr std::uint32_t Period = period;
+    };
+
+    /*!
+     * \brief Кооперативный планировщик
+     *
+     * tick (или advance) вызывается из прерывания таймера и отмечает готовыми
+     * периодические задачи, срок запуска которых наступил. post отмечает задачу
+     * готовой из любого контекста, в том числе из прерываний: битовая карта
+     * изменяется атомарно (LDREX/STREX на ARMv7-M). run выполняет готовые задачи
+     * в порядке приоритета, а при отсутствии готовых вызывает функцию сна.
+     *
+     * Если периодическая задача не успела выполниться до следующего срока,
+     * увеличивается счетчик пропущенных сроков (overruns).
+     *
+     * tick и advance вызываются только из одного контекста (обычно прерывания
+     * таймера или функции сна при остановленных тиках, но не из обоих): время
+     * продвигается чтением и записью now, а не fetch_add, и сроки запуска
+     * releases изменяются без синхронизации. next_wakeup атомарна, так как
+     * читается в ticks_to_wakeup из основного цикла.
+     * \tparam Tasks Задачи (Task), приоритеты не повторяются, не более 32 задач
+     */
+    template<typename... Tasks>
+        requires (sizeof...(Tasks) > 0) && (sizeof...(Tasks) <= 32)
+    class Scheduler
+    {
+        static_assert(NoDuplicates<std::integral_constant<std::uint8_t, Tasks::Priority>...>, "Task priorities must be unique");
+
+    public:
+        using Tick = std::uint32_t;
+
+        /// \brief Значение для sleep, если периодических задач нет
+        static constexpr Tick no_wakeup = std::numeric_limits<Tick>::max();
+
+        /// \brief Отмечает задачу готовой к выполнению
+        template<typename T>
+        [[gnu::always_inline]] inline static void post()
+        {
+            ready.fetch_or(bit(rank<T>()), std::memory_order_release);
+        }
+
+        /// \brief Продвигает время на один тик, вызывается из прерывания таймера
+        static void tick()
+        {
+            advance(1);
+        }
+
+        /*!
+         * \brief Продвигает время на ticks тиков
+         *
+         * Используется после сна без тиков: функция сна сообщает, сколько
+         * тиков прошло. Периодические задачи проверяются, только если
+         * наступил ближайший срок запуска.
+         * \warning Не атомарна относительно других вызовов tick и advance:
+         * вызовы из двух контекстов (прерывание таймера и функция сна) теряют тики.
+         */
+        static void advance(Tick ticks)
+        {
+            const Tick time = now.load(std::memory_order_relaxed) + ticks;
+            now.store(time, std::memory_order_relaxed);
+            if (!has_periodic || !reached(time, next_wakeup.load(std::memory_order_relaxed)))
+                return;
+
+            std::uint32_t released = 0;
+            Tick nearest = time + no_wakeup / 2;
+            for (size_t i = 0; i < tasks_count; ++i)
+            {
+                if (periods[i] == 0)
+                    continue;
+                while (reached(time, releases[i]))
+                {
+                    if (released & bit(i) || ready.load(std::memory_order_relaxed) & bit(i))
+                        ++missed[i];
+                    released |= bit(i);
+                    releases[i] += periods[i];
+                }
+                if (static_cast<std::int32_t>(releases[i] - nearest) < 0)
+                    nearest = releases[i];
+            }
+            next_wakeup.store(nearest, std::memory_order_relaxed);
+            ready.fetch_or(released, std::memory_order_release);
+        }
+
+        /// \brief Выполняет готовую задачу с наивысшим приоритетом, возвращает ложь, если готовых нет
+        static bool run_once()
+        {
+            const auto pending = ready.load(std::memory_order_acquire);
+            if (pending == 0)
+                return false;
+            const auto index = static_cast<size_t>(std::countl_zero(pending));
+            ready.fetch_and(~bit(index), std::memory_order_acquire);
+            functions[index]();
+            return true;
+        }
+
+        /// \brief Выполняет все готовые задачи, возвращает их количество
+        static size_t run_pending()
+        {
+            size_t count = 0;
+            while (run_once())
+                ++count;
+            return count;
+        }
+
+        /// \brief Истина, если готовых задач нет
+        static bool idle()
+        {
+            return ready.load(std::memory_order_acquire) == 0;
+        }
+
+        /*!
+         * \brief Бесконечный цикл планировщика
+         *
+         * При отсутствии готовых задач вызывает sleep(ticks) с количеством тиков
+         * до ближайшего периодического запуска (no_wakeup, если периодических
+         * задач нет). Функция сна может остановить тики, усыпить ядро до
+         * прерывания или срока и вызвать advance с прошедшим временем.
+         *
+         * sleep вызывается с разрешенными прерываниями, и прерывание может отметить
+         * задачу готовой после проверки в run. Чтобы не проспать ее, функция сна
+         * запрещает прерывания, повторно проверяет idle и только затем выполняет WFI:
+         * ожидающее прерывание пробуждает ядро и при запрещенных прерываниях
+         * и выполняется после их разрешения.
+         * \code
+         * Tasks::run([](Tasks::Tick) {
+         *     asm volatile("cpsid i" ::: "memory");
+         *     if (Tasks::idle())
+         *         asm volatile("wfi");
+         *     asm volatile("cpsie i" ::: "memory");
+         * });
+         * \endcode
+         * Функция сна без тиков получает ticks_to_wakeup повторно под запретом прерываний.
+         */
+        template<typename Sleep>
+        [[noreturn]] static void run(Sleep sleep)
+        {
+            while (true)
+                if (!run_once())
+                    sleep(ticks_to_wakeup());
+        }
+
+        /// \brief Количество тиков до ближайшего периодического запуска
+        static Tick ticks_to_wakeup()
+        {
+            if constexpr (!has_periodic)
+                return no_wakeup;
+            const auto remaining = static_cast<std::int32_t>(next_wakeup.load(std::memory_order_relaxed) - now.load(std::memory_order_relaxed));
+            return remaining > 0 ? static_cast<Tick>(remaining) : 0;
+        }
+
+        /// \brief Текущее время в тиках
+        static Tick time()
+        {
+            return now.load(std::memory_order_relaxed);
+        }
+
+        /// \brief Количество пропущенных сроков периодической задачи
+        template<typename T>
+        static std::uint32_t overruns()
+        {
+            return missed[rank<T>()];
+        }
+
+    private:
+        static constexpr size_t tasks_count = sizeof...(Tasks);
+
+        /// Номер задачи в порядке убывания приоритета, бит готовности - 31 - номер
+        template<typename T>
+        static consteval size_t rank()
+        {
+            static_assert((std::is_same_v<T, Tasks> || ...), "Task is not scheduled by this scheduler");
+            return ((Tasks::Priority < T::Priority ? 1 : 0) + ...);
+        }
+
+        static constexpr std::uint32_t bit(size_t index)
+        {
+            return 0x80000000U >> index;
+        }
+
+        static constexpr bool reached(Tick time, Tick deadline)
+        {
+            return static_cast<std::int32_t>(time - deadline) >= 0;
+        }
+
+        static constexpr std::array<void (*)(), tasks_count> functions = []
+        {
+            std::array<void (*)(), tasks_count> result{};
+            ((result[rank<Tasks>()] = +[] { Tasks::function(); }), ...);
+            return result;
+        }();
+
+        static constexpr std::array<Tick, tasks_count> periods = []
+        {
+            std::array<Tick, tasks_count> result{};
+            ((result[rank<Tasks>()] = Tasks::Period), ...);
+            return result;
+        }();
+
+        static constexpr bool has_periodic = ((Tasks::Period != 0) || ...);
+
+        static inline std::atomic<std::uint32_t> ready = 0;
+        static inline std::atomic<Tick> now = 0;
+        /// Сроки запуска, изменяются только в advance
+        static inline std::array<Tick, tasks_count> releases = periods;
+        static inline std::atomic<Tick> next_wakeup = []
+        {
+            Tick nearest = no_wakeup;
+            for (const auto period : periods)
+                if (period != 0 && period < nearest)
+                    nearest = period;
+            return nearest;
+        }();
+        static inline std::array<std::uint32_t, tasks_count> missed{};
+    };
+}
+
+#endif // SCHEDULER_HPP